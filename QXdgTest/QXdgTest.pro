@@ -38,5 +38,42 @@ INCLUDEPATH += $$PWD/..
 
 SOURCES += \
         $$PWD/../qxdg/qxdgstandardpath.cpp \
-        $$PWD/../qxdg/qxdgdesktopentry.cpp
+        $$PWD/../qxdg/qxdgdesktopentry.cpp \
+        $$PWD/../qxdg/qxdgdesktopentrytokenizer.cpp \
+        $$PWD/../qxdg/qxdgkeyatomtable.cpp \
+        $$PWD/../qxdg/qxdglocalechain.cpp \
+        $$PWD/../qxdg/qxdgdesktopentrycollection.cpp \
+        $$PWD/../qxdg/qxdgdesktopentrycache.cpp \
+        $$PWD/../qxdg/qxdgdesktopentryindex.cpp \
+        $$PWD/../qxdg/qxdgdesktopentrywatcher.cpp \
+        $$PWD/../qxdg/qxdgdesktopentryreader.cpp \
+        $$PWD/../qxdg/qxdgdesktopentryescape.cpp \
+        $$PWD/../qxdg/qxdgdesktopentryexec.cpp \
+        $$PWD/../qxdg/qxdgdesktopentrytransaction.cpp \
+        $$PWD/../qxdg/qxdgdesktopentryvalidator.cpp \
+        $$PWD/../qxdg/qxdgstats.cpp \
+        $$PWD/../qxdg/qxdgicontheme.cpp
 
+# moc needs the Q_OBJECT headers, like qxdgdesktopentrywatcher.h
+HEADERS += \
+        $$PWD/../qxdg/qxdgstandardpath.h \
+        $$PWD/../qxdg/qxdg_global.h \
+        $$PWD/../qxdg/qxdgdesktopentry.h \
+        $$PWD/../qxdg/qxdgdesktopentrytokenizer_p.h \
+        $$PWD/../qxdg/qxdgkeyatomtable_p.h \
+        $$PWD/../qxdg/qxdglocalechain_p.h \
+        $$PWD/../qxdg/qxdgdesktopentrycollection.h \
+        $$PWD/../qxdg/qxdgdesktopentry_p.h \
+        $$PWD/../qxdg/qxdgdesktopentrycache_p.h \
+        $$PWD/../qxdg/qxdgdesktopentryindex.h \
+        $$PWD/../qxdg/qxdgdesktopentrywatcher.h \
+        $$PWD/../qxdg/qxdgdesktopentrycollection_p.h \
+        $$PWD/../qxdg/qxdgdesktopentryreader.h \
+        $$PWD/../qxdg/qxdgdesktopentryescape_p.h \
+        $$PWD/../qxdg/qxdgdesktopentryexec.h \
+        $$PWD/../qxdg/qxdgdesktopentrytransaction.h \
+        $$PWD/../qxdg/qxdgdesktopentryvalidator.h \
+        $$PWD/../qxdg/qxdgstats.h \
+        $$PWD/../qxdg/qxdgstats_p.h \
+        $$PWD/../qxdg/qxdgicontheme.h \
+        $$PWD/../qxdg/qxdgicontheme_p.h
@@ -0,0 +1,229 @@
+/*
+ * Copyright (C) 2019 Deepin Technology Co., Ltd.
+ *               2019 Gary Wang
+ *
+ * Author:     Gary Wang <wzc782970009@gmail.com>
+ *
+ * Maintainer: Gary Wang <wzc782970009@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "qxdgcorpusgenerator.h"
+
+#include <QDir>
+#include <QFile>
+
+static const char * const localeNames[] = {
+    "ar", "ast", "be", "bg", "bn", "bs", "ca", "ca@valencia", "cs", "da", "de", "de_AT", "de_CH", "el", "en_AU",
+    "en_CA", "en_GB", "eo", "es", "es_AR", "es_MX", "et", "eu", "fa", "fi", "fr", "fr_CA", "ga", "gl", "he",
+    "hi", "hr", "hu", "id", "is", "it", "ja", "ka", "kk", "ko", "lt", "lv", "ml", "mr", "ms", "nb", "nl", "nn",
+    "pl", "pt", "pt_BR", "ro", "ru", "sk", "sl", "sr", "sr@latin", "sv", "ta", "th", "tr", "uk", "vi", "zh_CN",
+    "zh_HK", "zh_TW"
+};
+
+static const int localeNameCount = int(sizeof(localeNames) / sizeof(localeNames[0]));
+
+static const char * const syllables[] = {
+    "ka", "lo", "mi", "ne", "po", "ra", "si", "tu", "va", "ze", "bri", "dor", "fen", "gal", "hum", "jet",
+    "über", "ça", "ño", "δι", "жи", "中", "文", "ア", "한"
+};
+
+static const char * const mimeTopLevels[] = {
+    "application", "audio", "image", "text", "video", "x-scheme-handler"
+};
+
+static const char * const categories[] = {
+    "AudioVideo", "Audio", "Video", "Development", "Education", "Game", "Graphics", "Network", "Office",
+    "Science", "Settings", "System", "Utility", "Qt", "GTK", "KDE", "GNOME", "WebBrowser", "TextEditor"
+};
+
+QXdgCorpusGenerator::QXdgCorpusGenerator(quint32 seed)
+    : m_seed(seed)
+{
+
+}
+
+void QXdgCorpusGenerator::setLocaleCount(int localeCount)
+{
+    m_localeCount = qBound(0, localeCount, localeNameCount);
+}
+
+QStringList QXdgCorpusGenerator::locales() const
+{
+    QStringList result;
+    for (int i = 0; i < m_localeCount; i++) {
+        result << QString::fromLatin1(localeNames[i]);
+    }
+    return result;
+}
+
+QByteArray QXdgCorpusGenerator::word()
+{
+    QByteArray result;
+    const int syllableCount = 1 + int(m_random() % 3);
+    for (int i = 0; i < syllableCount; i++) {
+        result += syllables[m_random() % (sizeof(syllables) / sizeof(syllables[0]))];
+    }
+    return result;
+}
+
+// Some sentences carry the escapes real files use, so unescaping has some work to do.
+QByteArray QXdgCorpusGenerator::sentence(int minWords, int maxWords)
+{
+    QByteArray result = word();
+    const int wordCount = minWords + int(m_random() % uint(maxWords - minWords + 1));
+    for (int i = 1; i < wordCount; i++) {
+        switch (m_random() % 16) {
+        case 0:
+            result += "\\n";
+            break;
+        case 1:
+            result += "\\s";
+            break;
+        case 2:
+            result += ", ";
+            break;
+        default:
+            result += ' ';
+            break;
+        }
+        result += word();
+    }
+    return result;
+}
+
+void QXdgCorpusGenerator::appendLocalized(QByteArray &out, const char *key, const QByteArray &value, int translatedPercent)
+{
+    out += key;
+    out += '=';
+    out += value;
+    out += '\n';
+    for (int i = 0; i < m_localeCount; i++) {
+        if (int(m_random() % 100) >= translatedPercent) continue;
+        out += key;
+        out += '[';
+        out += localeNames[i];
+        out += "]=";
+        out += word();
+        out += ' ';
+        out += value;
+        out += '\n';
+    }
+}
+
+/*!
+ * \brief Returns the content of the file \a index of the corpus.
+ *
+ * Each file only depends on the seed and its index, not on the files generated before it.
+ */
+QByteArray QXdgCorpusGenerator::generateEntry(int index)
+{
+    m_random.seed(m_seed * 2654435761u + quint32(index));
+
+    const QByteArray program = "app-" + QByteArray::number(index);
+    QByteArray out;
+    out.reserve(16384);
+
+    out += "# Generated by QXdgCorpusGenerator\n[Desktop Entry]\nVersion=1.0\nType=Application\n";
+    appendLocalized(out, "Name", sentence(1, 3), 100);
+    appendLocalized(out, "GenericName", sentence(2, 4), 80);
+    appendLocalized(out, "Comment", sentence(4, 12), 60);
+    out += "Icon=" + program + "\n";
+    out += "TryExec=" + program + "\n";
+    out += "Exec=" + program + " --option=\"value with \\\\\"quotes\\\\\"\" %U\n";
+    out += "Terminal=false\nStartupNotify=true\n";
+    out += m_random() % 8 ? "NoDisplay=false\n" : "NoDisplay=true\n";
+    out += "StartupWMClass=" + program + "\n";
+
+    out += "MimeType=";
+    for (int i = 0; i < m_listLength; i++) {
+        out += mimeTopLevels[m_random() % (sizeof(mimeTopLevels) / sizeof(mimeTopLevels[0]))];
+        out += '/';
+        out += word();
+        out += ';';
+    }
+    out += "\nCategories=";
+    for (int i = 0; i < 6; i++) {
+        out += categories[m_random() % (sizeof(categories) / sizeof(categories[0]))];
+        out += ';';
+    }
+    out += '\n';
+
+    QByteArray keywords;
+    for (int i = 0; i < m_listLength / 4; i++) {
+        keywords += word();
+        keywords += m_random() % 32 ? ";" : "\\;";
+    }
+    keywords += ';';
+    appendLocalized(out, "Keywords", keywords, 50);
+
+    out += "Actions=new-window;new-private-window;\n";
+    out += "X-Vendor-Version=" + QByteArray::number(int(m_random() % 100)) + "." + QByteArray::number(int(m_random() % 10)) + "\n";
+
+    for (const char *action : { "new-window", "new-private-window" }) {
+        out += "\n[Desktop Action ";
+        out += action;
+        out += "]\n";
+        appendLocalized(out, "Name", sentence(2, 4), 90);
+        out += "Exec=" + program + " --" + action + " %U\n";
+    }
+
+    // a third of the files carry vendor data, which most readers never look at.
+    if (m_random() % 3 == 0) {
+        out += "\n[X-Vendor Extension]\n";
+        for (int i = 0; i < 20; i++) {
+            out += "X-Key" + QByteArray::number(i) + "=" + sentence(1, 6) + "\n";
+        }
+    }
+
+    return out;
+}
+
+/*!
+ * \brief Writes the whole corpus into \a directory, returns the paths of the files.
+ *
+ * Every hundred files go into their own sub directory, like the vendor directories of real installations.
+ */
+QStringList QXdgCorpusGenerator::writeCorpus(const QString &directory)
+{
+    QStringList filePaths;
+    for (int i = 0; i < m_fileCount; i++) {
+        const QString subDirectory = QStringLiteral("%1/vendor%2").arg(directory).arg(i / 100);
+        if (i % 100 == 0 && !QDir().mkpath(subDirectory)) {
+            return QStringList();
+        }
+
+        const QString filePath = QStringLiteral("%1/app-%2.desktop").arg(subDirectory).arg(i);
+        QFile file(filePath);
+        if (!file.open(QIODevice::WriteOnly) || file.write(generateEntry(i)) == -1) {
+            return QStringList();
+        }
+        filePaths << filePath;
+    }
+    return filePaths;
+}
+
+/*!
+ * \brief Returns the parameters of the corpus, so they can be recorded next to the results.
+ */
+QJsonObject QXdgCorpusGenerator::toJson() const
+{
+    QJsonObject object;
+    object.insert("seed", qint64(m_seed));
+    object.insert("files", m_fileCount);
+    object.insert("locales", m_localeCount);
+    object.insert("listLength", m_listLength);
+    return object;
+}
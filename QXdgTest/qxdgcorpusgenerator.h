@@ -0,0 +1,69 @@
+/*
+ * Copyright (C) 2019 Deepin Technology Co., Ltd.
+ *               2019 Gary Wang
+ *
+ * Author:     Gary Wang <wzc782970009@gmail.com>
+ *
+ * Maintainer: Gary Wang <wzc782970009@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QXDGCORPUSGENERATOR_H
+#define QXDGCORPUSGENERATOR_H
+
+#include <QByteArray>
+#include <QJsonObject>
+#include <QStringList>
+
+#include <random>
+
+/*!
+ * \brief Generates realistic desktop entry files for the benchmarks.
+ *
+ * The files look like the ones found in /usr/share/applications: every translatable key is translated into
+ * many locales, MimeType and Keywords are long lists, some values need escaping, and there are action and
+ * vendor groups. The same seed always generates the same corpus, so results can be compared across releases.
+ */
+class QXdgCorpusGenerator
+{
+public:
+    explicit QXdgCorpusGenerator(quint32 seed = 1);
+
+    int fileCount() const { return m_fileCount; }
+    void setFileCount(int fileCount) { m_fileCount = fileCount; }
+    int localeCount() const { return m_localeCount; }
+    void setLocaleCount(int localeCount);
+    int listLength() const { return m_listLength; }
+    void setListLength(int listLength) { m_listLength = listLength; }
+
+    QStringList locales() const;
+    QByteArray generateEntry(int index);
+    QStringList writeCorpus(const QString &directory);
+
+    QJsonObject toJson() const;
+
+private:
+    QByteArray word();
+    QByteArray sentence(int minWords, int maxWords);
+    void appendLocalized(QByteArray &out, const char *key, const QByteArray &value, int translatedPercent);
+
+    quint32 m_seed;
+    int m_fileCount = 2000;
+    int m_localeCount = 40;
+    int m_listLength = 60;
+    std::mt19937 m_random;
+};
+
+#endif // QXDGCORPUSGENERATOR_H
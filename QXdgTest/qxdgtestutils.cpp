@@ -0,0 +1,42 @@
+/*
+ * Copyright (C) 2019 Deepin Technology Co., Ltd.
+ *               2019 Gary Wang
+ *
+ * Author:     Gary Wang <wzc782970009@gmail.com>
+ *
+ * Maintainer: Gary Wang <wzc782970009@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "qxdgtestutils.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+
+// Writes \a content to \a filePath, creating its directory first. Returns false if anything failed.
+bool writeTestFile(const QString &filePath, const QByteArray &content)
+{
+    if (!QDir().mkpath(QFileInfo(filePath).absolutePath())) return false;
+    QFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly)) return false;
+    return file.write(content) == content.size();
+}
+
+// A minimal application entry named \a name.
+QByteArray applicationEntryData(const QString &name)
+{
+    return QStringLiteral("[Desktop Entry]\nType=Application\nName=%1\n").arg(name).toUtf8();
+}
@@ -0,0 +1,457 @@
+/*
+ * Copyright (C) 2019 Deepin Technology Co., Ltd.
+ *               2019 Gary Wang
+ *
+ * Author:     Gary Wang <wzc782970009@gmail.com>
+ *
+ * Maintainer: Gary Wang <wzc782970009@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <QString>
+#include <QtTest>
+
+#include "qxdg/qxdgdesktopentry.h"
+#include "qxdg/qxdgstandardpath.h"
+#include "qxdgcorpusgenerator.h"
+
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QXmlStreamReader>
+
+#include <functional>
+
+/*!
+ * \brief Measures the speed of the library on a generated corpus.
+ *
+ * Run it with "--json results.json" to get the results in a form which can be compared between releases,
+ * the rest of the arguments are the usual QtTest ones. The corpus can be tuned with the environment variables
+ * QXDG_BENCHMARK_FILES, QXDG_BENCHMARK_LOCALES and QXDG_BENCHMARK_LIST_LENGTH.
+ */
+class QXdgBenchmark : public QObject
+{
+    Q_OBJECT
+
+public:
+    QXdgBenchmark();
+
+    QJsonObject corpusInfo() const { return generator.toJson(); }
+
+private Q_SLOTS:
+    void initTestCase();
+    void benchmark_InitSections();
+    void benchmark_LazySectionParse_data();
+    void benchmark_LazySectionParse();
+    void benchmark_ConcurrentReads_data();
+    void benchmark_ConcurrentReads();
+    void benchmark_LoadCorpus_data();
+    void benchmark_LoadCorpus();
+    void benchmark_RawValue();
+    void benchmark_LocalizedValue_data();
+    void benchmark_LocalizedValue();
+    void benchmark_StringListValue();
+    void benchmark_Escape();
+    void benchmark_Unescape();
+    void benchmark_Save_data();
+    void benchmark_Save();
+    void benchmark_UserDirLocation();
+    void benchmark_StandardLocations_data();
+    void benchmark_StandardLocations();
+
+private:
+    QXdgCorpusGenerator generator;
+    QTemporaryDir corpusDir;
+    QStringList filePaths;
+    // the content of the first files, to measure parsing without the file system.
+    QVector<QByteArray> sample;
+};
+
+static int environmentValue(const char *name, int defaultValue)
+{
+    bool ok = false;
+    const int value = qEnvironmentVariableIntValue(name, &ok);
+    return ok ? value : defaultValue;
+}
+
+namespace {
+
+class FunctionThread : public QThread
+{
+public:
+    explicit FunctionThread(const std::function<void()> &function)
+        : function(function) {}
+
+protected:
+    void run() override {
+        function();
+    }
+
+private:
+    std::function<void()> function;
+};
+
+} // namespace
+
+static void runInThreads(int threadCount, const std::function<void(int)> &function)
+{
+    QVector<FunctionThread *> threads;
+    for (int i = 0; i < threadCount; i++) {
+        threads.append(new FunctionThread([function, i]() { function(i); }));
+    }
+    for (FunctionThread *thread : threads) {
+        thread->start();
+    }
+    for (FunctionThread *thread : threads) {
+        thread->wait();
+    }
+    qDeleteAll(threads);
+}
+
+static const int concurrentGroupCount = 64;
+static const int concurrentKeyCount = 16;
+
+// One entry with many groups, read by all the threads at once.
+static QByteArray concurrentReadsContent()
+{
+    QByteArray content;
+    for (int i = 0; i < concurrentGroupCount; i++) {
+        content.append(QStringLiteral("[Group %1]\n").arg(i).toUtf8());
+        for (int k = 0; k < concurrentKeyCount; k++) {
+            content.append(QStringLiteral("Key%1=Value %2 %1\n").arg(k).arg(i).toUtf8());
+        }
+        content.append(QStringLiteral("Name=Name %1\nName[de]=Name de %1\nName[fr_FR]=Name fr %1\n").arg(i).toUtf8());
+    }
+    return content;
+}
+
+// Reads every group of the entry, in an order which depends on the seed, returns the number of missing values.
+static int readConcurrentReadsEntry(const QXdgDesktopEntry &entry, int seed)
+{
+    static const char * const locales[] = { "de_DE", "fr_FR", "fr", "en_US" };
+
+    int errors = 0;
+    for (int g = 0; g < concurrentGroupCount; g++) {
+        const QString group = QStringLiteral("Group %1").arg((g * 7 + seed) % concurrentGroupCount);
+        for (int k = 0; k < concurrentKeyCount; k++) {
+            if (entry.rawValue(QStringLiteral("Key%1").arg(k), group).isEmpty()) errors++;
+        }
+        if (entry.localizedValue("Name", locales[(g + seed) % 4], group).isEmpty()) errors++;
+    }
+    return errors;
+}
+
+QXdgBenchmark::QXdgBenchmark()
+{
+    generator.setFileCount(environmentValue("QXDG_BENCHMARK_FILES", generator.fileCount()));
+    generator.setLocaleCount(environmentValue("QXDG_BENCHMARK_LOCALES", generator.localeCount()));
+    generator.setListLength(environmentValue("QXDG_BENCHMARK_LIST_LENGTH", generator.listLength()));
+}
+
+void QXdgBenchmark::initTestCase()
+{
+    QVERIFY(corpusDir.isValid());
+    filePaths = generator.writeCorpus(corpusDir.path());
+    QCOMPARE(filePaths.count(), generator.fileCount());
+    QVERIFY(!filePaths.isEmpty());
+
+    for (int i = 0; i < qMin(100, filePaths.count()); i++) {
+        sample << generator.generateEntry(i);
+    }
+}
+
+void QXdgBenchmark::benchmark_InitSections()
+{
+    // only splits the data into sections, none of them gets parsed.
+    QBENCHMARK {
+        for (const QByteArray &data : qAsConst(sample)) {
+            const QXdgDesktopEntry entry = QXdgDesktopEntry::fromData(data);
+            Q_UNUSED(entry)
+        }
+    }
+}
+
+void QXdgBenchmark::benchmark_LazySectionParse_data()
+{
+    QTest::addColumn<QString>("section");
+    QTest::newRow("Desktop Entry") << QStringLiteral("Desktop Entry");
+    QTest::newRow("action") << QStringLiteral("Desktop Action new-window");
+}
+
+void QXdgBenchmark::benchmark_LazySectionParse()
+{
+    QFETCH(QString, section);
+
+    QBENCHMARK {
+        for (const QByteArray &data : qAsConst(sample)) {
+            const QXdgDesktopEntry entry = QXdgDesktopEntry::fromData(data);
+            entry.rawValue("Name", section);
+        }
+    }
+}
+
+void QXdgBenchmark::benchmark_ConcurrentReads_data()
+{
+    QTest::addColumn<bool>("freeze");
+    QTest::newRow("lazy") << false;
+    QTest::newRow("frozen") << true;
+}
+
+void QXdgBenchmark::benchmark_ConcurrentReads()
+{
+    QFETCH(bool, freeze);
+
+    const QByteArray content = concurrentReadsContent();
+    const int threadCount = qMax(4, QThread::idealThreadCount());
+    QAtomicInt errors(0);
+    QBENCHMARK {
+        // a new entry every time, so the lazy one has to be parsed again.
+        const QXdgDesktopEntry entry = QXdgDesktopEntry::fromData(content, freeze ? QXdgDesktopEntry::FreezeOnLoad
+                                                                                  : QXdgDesktopEntry::DefaultLoad);
+        runInThreads(threadCount, [&](int thread) {
+            for (int i = 0; i < 10; i++) {
+                errors.fetchAndAddRelaxed(readConcurrentReadsEntry(entry, thread + i));
+            }
+        });
+    }
+    QCOMPARE(errors.load(), 0);
+}
+
+void QXdgBenchmark::benchmark_LoadCorpus_data()
+{
+    QTest::addColumn<int>("options");
+    QTest::newRow("default") << int(QXdgDesktopEntry::DefaultLoad);
+    QTest::newRow("mapped") << int(QXdgDesktopEntry::MapFile);
+    QTest::newRow("peek") << int(QXdgDesktopEntry::PeekOnly);
+}
+
+void QXdgBenchmark::benchmark_LoadCorpus()
+{
+    QFETCH(int, options);
+
+    // what a launcher does on startup, once per file of the corpus.
+    QBENCHMARK {
+        for (const QString &filePath : qAsConst(filePaths)) {
+            const QXdgDesktopEntry entry(filePath, QXdgDesktopEntry::LoadOptions(options));
+            entry.boolValue("NoDisplay");
+        }
+    }
+}
+
+void QXdgBenchmark::benchmark_RawValue()
+{
+    const QXdgDesktopEntry entry = QXdgDesktopEntry::fromData(sample.first());
+    QCOMPARE(entry.rawValue("Type"), QStringLiteral("Application"));
+
+    QBENCHMARK {
+        entry.rawValue("Type");
+        entry.rawValue("Exec");
+        entry.rawValue("X-Vendor-Version");
+        entry.rawValue("NotExisted");
+    }
+}
+
+void QXdgBenchmark::benchmark_LocalizedValue_data()
+{
+    const QStringList locales = generator.locales();
+    QTest::addColumn<QString>("locale");
+    QTest::newRow("exact") << (locales.isEmpty() ? QStringLiteral("C") : locales.last());
+    QTest::newRow("fallback") << QStringLiteral("de_DE.UTF-8@euro");
+    QTest::newRow("untranslated") << QStringLiteral("xx_XX");
+}
+
+void QXdgBenchmark::benchmark_LocalizedValue()
+{
+    QFETCH(QString, locale);
+
+    const QXdgDesktopEntry entry = QXdgDesktopEntry::fromData(sample.first());
+    QVERIFY(!entry.localizedValue("Name", locale).isEmpty());
+
+    QBENCHMARK {
+        entry.localizedValue("Name", locale);
+        entry.localizedValue("Comment", locale);
+    }
+}
+
+void QXdgBenchmark::benchmark_StringListValue()
+{
+    QCOMPARE(QXdgDesktopEntry::fromData(sample.first()).stringListValue("MimeType").count(), generator.listLength());
+
+    // a new entry every time, the lists would be cached otherwise.
+    QBENCHMARK {
+        for (const QByteArray &data : qAsConst(sample)) {
+            const QXdgDesktopEntry entry = QXdgDesktopEntry::fromData(data);
+            entry.stringListValue("MimeType");
+            entry.stringListValue("Keywords");
+        }
+    }
+}
+
+void QXdgBenchmark::benchmark_Escape()
+{
+    QStringList values;
+    for (const QByteArray &data : qAsConst(sample)) {
+        values << QXdgDesktopEntry::fromData(data).stringValue("Comment");
+    }
+
+    QString out;
+    QBENCHMARK {
+        for (const QString &value : qAsConst(values)) {
+            QXdgDesktopEntry::escape(value, out);
+        }
+    }
+}
+
+void QXdgBenchmark::benchmark_Unescape()
+{
+    QStringList values;
+    for (const QByteArray &data : qAsConst(sample)) {
+        values << QXdgDesktopEntry::fromData(data).rawValue("Comment");
+    }
+
+    QString out;
+    QBENCHMARK {
+        for (const QString &value : qAsConst(values)) {
+            QXdgDesktopEntry::unescape(value, out);
+        }
+    }
+}
+
+void QXdgBenchmark::benchmark_Save_data()
+{
+    QTest::addColumn<bool>("modify");
+    QTest::newRow("modified") << true;
+    QTest::newRow("unmodified") << false;
+}
+
+void QXdgBenchmark::benchmark_Save()
+{
+    QFETCH(bool, modify);
+
+    const QString filePath = corpusDir.filePath("save.desktop");
+    QVERIFY(QFile::copy(filePaths.first(), filePath) || QFile::exists(filePath));
+    QXdgDesktopEntry entry(filePath);
+
+    int counter = 0;
+    QBENCHMARK {
+        if (modify) {
+            entry.setRawValue(QString::number(counter++), "X-Counter");
+        }
+        QVERIFY(entry.save());
+    }
+}
+
+void QXdgBenchmark::benchmark_UserDirLocation()
+{
+    QBENCHMARK {
+        QXdgStandardPath::userDirLocation(QXdgStandardPath::DesktopLocation);
+        QXdgStandardPath::userDirLocation(QXdgStandardPath::DownloadLocation);
+    }
+}
+
+void QXdgBenchmark::benchmark_StandardLocations_data()
+{
+    QTest::addColumn<int>("type");
+    QTest::newRow("XDG_DATA_DIRS") << int(QXdgStandardPath::XdgDataDirsLocation);
+    QTest::newRow("XDG_CONFIG_HOME") << int(QXdgStandardPath::XdgConfigHomeLocation);
+    QTest::newRow("DOCUMENTS") << int(QXdgStandardPath::DocumentsLocation);
+}
+
+void QXdgBenchmark::benchmark_StandardLocations()
+{
+    QFETCH(int, type);
+
+    QBENCHMARK {
+        QXdgStandardPath::standardLocations(QXdgStandardPath::StandardLocation(type));
+    }
+}
+
+// Turns the BenchmarkResult elements of the QtTest XML log into a JSON report.
+static bool writeJsonReport(const QString &xmlPath, const QString &jsonPath, const QJsonObject &corpus)
+{
+    QFile xmlFile(xmlPath);
+    if (!xmlFile.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    QJsonArray results;
+    QString function;
+    QXmlStreamReader xml(&xmlFile);
+    while (!xml.atEnd()) {
+        if (xml.readNext() != QXmlStreamReader::StartElement) continue;
+
+        const QXmlStreamAttributes attributes = xml.attributes();
+        if (xml.name() == QLatin1String("TestFunction")) {
+            function = attributes.value("name").toString();
+        } else if (xml.name() == QLatin1String("BenchmarkResult")) {
+            QJsonObject result;
+            result.insert("function", function);
+            result.insert("tag", attributes.value("tag").toString());
+            result.insert("metric", attributes.value("metric").toString());
+            result.insert("value", attributes.value("value").toDouble());
+            result.insert("iterations", attributes.value("iterations").toInt());
+            results.append(result);
+        }
+    }
+    if (xml.hasError()) {
+        return false;
+    }
+
+    QJsonObject report;
+    report.insert("suite", QStringLiteral("QXdgBenchmark"));
+    report.insert("qtVersion", QString::fromLatin1(qVersion()));
+    report.insert("date", QDateTime::currentDateTimeUtc().toString(Qt::ISODate));
+    report.insert("corpus", corpus);
+    report.insert("results", results);
+
+    QFile jsonFile(jsonPath);
+    return jsonFile.open(QIODevice::WriteOnly)
+            && jsonFile.write(QJsonDocument(report).toJson()) != -1;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    QStringList arguments = app.arguments();
+    QString jsonPath;
+    const int jsonIndex = arguments.indexOf("--json");
+    if (jsonIndex > 0 && jsonIndex + 1 < arguments.count()) {
+        jsonPath = arguments.takeAt(jsonIndex + 1);
+        arguments.removeAt(jsonIndex);
+    }
+
+    QXdgBenchmark benchmark;
+    if (jsonPath.isEmpty()) {
+        return QTest::qExec(&benchmark, arguments);
+    }
+
+    // QtTest has no JSON logger, so log to XML next to the console and convert it afterwards.
+    QTemporaryFile xmlFile;
+    if (!xmlFile.open()) {
+        qWarning("Can't create a temporary file for the XML log");
+        return 1;
+    }
+    xmlFile.close();
+    arguments << "-o" << xmlFile.fileName() + ",xml" << "-o" << "-,txt";
+
+    const int failures = QTest::qExec(&benchmark, arguments);
+    if (!writeJsonReport(xmlFile.fileName(), jsonPath, benchmark.corpusInfo())) {
+        qWarning("Can't write the JSON report to %s", qPrintable(jsonPath));
+        return 1;
+    }
+    return failures;
+}
+
+#include "tst_qxdgbenchmark.moc"
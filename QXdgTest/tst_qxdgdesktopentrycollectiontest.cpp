@@ -0,0 +1,157 @@
+/*
+ * Copyright (C) 2019 Deepin Technology Co., Ltd.
+ *               2019 Gary Wang
+ *
+ * Author:     Gary Wang <wzc782970009@gmail.com>
+ *
+ * Maintainer: Gary Wang <wzc782970009@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <QString>
+#include <QtTest>
+
+#include "qxdg/qxdgdesktopentrycollection.h"
+#include "qxdg/qxdgstats.h"
+#include "qxdgtestutils.h"
+
+class QXdgDesktopEntryCollectionTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void testCase_Collection();
+    void testCase_CollectionCache();
+};
+
+void QXdgDesktopEntryCollectionTest::testCase_Collection()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+
+    QVERIFY(writeTestFile(dir.filePath("home/org.foo.desktop"), applicationEntryData("Foo Home")));
+    QVERIFY(writeTestFile(dir.filePath("home/kde/org.bar.desktop"), applicationEntryData("Bar")));
+    QVERIFY(writeTestFile(dir.filePath("system/org.foo.desktop"), applicationEntryData("Foo System")));
+    QVERIFY(writeTestFile(dir.filePath("system/org.baz.desktop"), applicationEntryData("Baz")));
+    QVERIFY(writeTestFile(dir.filePath("system/deep/er/org.qux.desktop"), applicationEntryData("Qux")));
+    QVERIFY(writeTestFile(dir.filePath("system/readme.txt"), applicationEntryData("Not an entry")));
+
+    QXdgDesktopEntryCollection collection;
+    collection.setMaxThreadCount(4);
+    QVERIFY(collection.load({ dir.path() + "/home", dir.path() + "/missing", dir.path() + "/system" }));
+
+    const QStringList expectedIds { "kde-org.bar.desktop", "org.foo.desktop", "deep-er-org.qux.desktop", "org.baz.desktop" };
+    QCOMPARE(collection.desktopFileIds(), expectedIds);
+    QCOMPARE(collection.count(), 4);
+    QCOMPARE(collection.entry("org.foo.desktop").localizedValue("Name"), QStringLiteral("Foo Home"));
+    QCOMPARE(collection.entry("deep-er-org.qux.desktop").localizedValue("Name"), QStringLiteral("Qux"));
+    QCOMPARE(collection.filePath("org.baz.desktop"), dir.path() + "/system/org.baz.desktop");
+    QCOMPARE(collection.entries().count(), 4);
+    QVERIFY(!collection.contains("readme.txt"));
+    QVERIFY(collection.entry("readme.txt").allGroups().isEmpty());
+
+    collection.clear();
+    QVERIFY(collection.isEmpty());
+}
+
+void QXdgDesktopEntryCollectionTest::testCase_CollectionCache()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString appDir = dir.path() + "/applications";
+    const QString cacheFile = dir.path() + "/cache/desktop-entries.cache";
+    QVERIFY(QDir().mkpath(appDir + "/sub"));
+
+    QVERIFY(writeTestFile(appDir + "/foo.desktop", "[Desktop Entry]\nName=Foo\nName[de]=Fu\n[Desktop Action new]\nExec=foo --new\n"));
+    QVERIFY(writeTestFile(appDir + "/sub/bar.desktop", "[Desktop Entry]\nName=Bar\n"));
+
+    QXdgDesktopEntryCollection collection;
+    collection.setCacheEnabled(true);
+    collection.setCacheFilePath(cacheFile);
+    QVERIFY(collection.load({ appDir }));
+    QVERIFY(QFile::exists(cacheFile));
+    QCOMPARE(collection.count(), 2);
+
+    // served from the cache this time.
+    QXdgDesktopEntryCollection cachedCollection;
+    cachedCollection.setCacheEnabled(true);
+    cachedCollection.setCacheFilePath(cacheFile);
+    QVERIFY(cachedCollection.load({ appDir }));
+    QCOMPARE(cachedCollection.desktopFileIds(), collection.desktopFileIds());
+    QXdgDesktopEntry foo = cachedCollection.entry("foo.desktop");
+    QCOMPARE(foo.localizedValue("Name", "de_DE"), QStringLiteral("Fu"));
+    QCOMPARE(foo.rawValue("Exec", "Desktop Action new"), QStringLiteral("foo --new"));
+    QCOMPARE(foo.allGroups(true), QStringList({ "Desktop Entry", "Desktop Action new" }));
+    QCOMPARE(cachedCollection.entry("sub-bar.desktop").keys(), QStringList { "Name" });
+
+    // changes on disk are noticed.
+    QVERIFY(writeTestFile(appDir + "/sub/bar.desktop", "[Desktop Entry]\nName=Bar Changed\n"));
+    QVERIFY(writeTestFile(appDir + "/baz.desktop", "[Desktop Entry]\nName=Baz\n"));
+    QVERIFY(cachedCollection.load({ appDir }));
+    QCOMPARE(cachedCollection.count(), 3);
+    QCOMPARE(cachedCollection.entry("sub-bar.desktop").localizedValue("Name"), QStringLiteral("Bar Changed"));
+
+    // a damaged cache is ignored.
+    QVERIFY(writeTestFile(cacheFile, "not a cache"));
+    QVERIFY(cachedCollection.load({ appDir }));
+    QCOMPARE(cachedCollection.count(), 3);
+
+    // Files modified too recently can't be trusted by their modification time, move them back in time.
+    auto setModificationTime = [](const QString &filePath, int secondsAgo) {
+        QFile file(filePath);
+        return file.open(QIODevice::ReadWrite)
+                && file.setFileTime(QDateTime::currentDateTime().addSecs(-secondsAgo), QFileDevice::FileModificationTime);
+    };
+    for (const char *fileName : { "/foo.desktop", "/sub/bar.desktop", "/baz.desktop" }) {
+        QVERIFY(setModificationTime(appDir + fileName, 3600));
+    }
+    QVERIFY(cachedCollection.load({ appDir }));
+
+    QXdgStats::setEnabled(true);
+    QXdgStats::reset();
+    QVERIFY(cachedCollection.load({ appDir }));
+    QCOMPARE(QXdgStats::snapshot().cacheHits, quint64(3));
+
+    // a file rewritten in place doesn't change the modification time of its directory.
+    QVERIFY(writeTestFile(appDir + "/foo.desktop", "[Desktop Entry]\nName=Foo Rewritten\n"));
+    QVERIFY(setModificationTime(appDir + "/foo.desktop", 1800));
+    QXdgStats::reset();
+    QVERIFY(cachedCollection.load({ appDir }));
+    QCOMPARE(QXdgStats::snapshot().cacheHits, quint64(0));
+    QCOMPARE(cachedCollection.entry("foo.desktop").localizedValue("Name"), QStringLiteral("Foo Rewritten"));
+
+    // a modification time in the future doesn't make the cache rebuilt on every load.
+    const QDateTime future = QDateTime::currentDateTime().addSecs(86400);
+    auto setFutureTime = [&future](const QString &filePath) {
+        QFile file(filePath);
+        return file.open(QIODevice::ReadWrite) && file.setFileTime(future, QFileDevice::FileModificationTime);
+    };
+    QVERIFY(setFutureTime(appDir + "/baz.desktop"));
+    QVERIFY(cachedCollection.load({ appDir }));
+    QXdgStats::reset();
+    QVERIFY(cachedCollection.load({ appDir }));
+    QCOMPARE(QXdgStats::snapshot().cacheHits, quint64(3));
+
+    // but its content is checked, it may be updated without changing the size or the time.
+    QVERIFY(writeTestFile(appDir + "/baz.desktop", "[Desktop Entry]\nName=Zab\n"));
+    QVERIFY(setFutureTime(appDir + "/baz.desktop"));
+    QVERIFY(cachedCollection.load({ appDir }));
+    QXdgStats::setEnabled(false);
+    QCOMPARE(cachedCollection.entry("baz.desktop").localizedValue("Name"), QStringLiteral("Zab"));
+}
+
+QTEST_GUILESS_MAIN(QXdgDesktopEntryCollectionTest)
+
+#include "tst_qxdgdesktopentrycollectiontest.moc"
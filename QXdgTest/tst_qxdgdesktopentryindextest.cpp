@@ -0,0 +1,70 @@
+/*
+ * Copyright (C) 2019 Deepin Technology Co., Ltd.
+ *               2019 Gary Wang
+ *
+ * Author:     Gary Wang <wzc782970009@gmail.com>
+ *
+ * Maintainer: Gary Wang <wzc782970009@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <QString>
+#include <QtTest>
+
+#include "qxdg/qxdgdesktopentrycollection.h"
+#include "qxdg/qxdgdesktopentryindex.h"
+#include "qxdgtestutils.h"
+
+class QXdgDesktopEntryIndexTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void testCase_Index();
+};
+
+void QXdgDesktopEntryIndexTest::testCase_Index()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+
+    QVERIFY(writeTestFile(dir.filePath("a.desktop"),
+                          "[Desktop Entry]\nMimeType=image/png;image/jpeg;\nCategories=Graphics;Viewer;\n"));
+    QVERIFY(writeTestFile(dir.filePath("b.desktop"),
+                          "[Desktop Entry]\nMimeType=image/png;text/plain;image/png;\nCategories=Graphics;\n"));
+    QVERIFY(writeTestFile(dir.filePath("c.desktop"), "[Desktop Entry]\nCategories=Utility;\nKeywords=edit;text;\n"));
+
+    QXdgDesktopEntryCollection collection;
+    QVERIFY(collection.load({ dir.path() }));
+
+    QXdgDesktopEntryIndex index;
+    QCOMPARE(index.indexedKeys(), QStringList({ "MimeType", "Categories" }));
+    index.build(collection);
+    QCOMPARE(index.lookup("MimeType", "image/png"), QStringList({ "a.desktop", "b.desktop" }));
+    QCOMPARE(index.lookup("MimeType", "text/plain"), QStringList { "b.desktop" });
+    QCOMPARE(index.count("Categories", "Graphics"), 2);
+    QCOMPARE(index.lookup("Categories", "Office"), QStringList());
+    QCOMPARE(index.values("Categories"), QStringList({ "Graphics", "Utility", "Viewer" }));
+    QVERIFY(!index.isIndexed("Keywords"));
+    QCOMPARE(index.lookup("Keywords", "text"), QStringList());
+
+    QXdgDesktopEntryIndex keywordIndex({ "Keywords" });
+    keywordIndex.build(collection);
+    QCOMPARE(keywordIndex.lookup("Keywords", "text"), QStringList { "c.desktop" });
+}
+
+QTEST_GUILESS_MAIN(QXdgDesktopEntryIndexTest)
+
+#include "tst_qxdgdesktopentryindextest.moc"
@@ -24,6 +24,16 @@
 #include <QtTest>
 
 #include "qxdg/qxdgdesktopentry.h"
+#include "qxdg/qxdgdesktopentryexec.h"
+#include "qxdg/qxdgdesktopentryreader.h"
+#include "qxdg/qxdgdesktopentrytransaction.h"
+#include "qxdg/qxdgstats.h"
+#include "qxdg/qxdgdesktopentrytokenizer_p.h"
+#include "qxdg/qxdgkeyatomtable_p.h"
+
+#include <functional>
+#include <random>
+#include <string.h>
 
 class QXdgDesktopEntryTest : public QObject
 {
@@ -34,6 +44,25 @@ public:
 
 private Q_SLOTS:
     void testCase_ParseFile();
+    void testCase_MappedFile();
+    void testCase_ImplicitSharing();
+    void testCase_ConcurrentReads();
+    void testCase_PartialLoad();
+    void testCase_FromData();
+    void testCase_Reader();
+    void testCase_Escape();
+    void testCase_Exec();
+    void testCase_Visitors();
+    void testCase_TypedValues();
+    void testCase_IncrementalSave();
+    void testCase_Transaction();
+    void testCase_Stats();
+    void testCase_GroupHeaders();
+    void testCase_SectionOrder();
+    void testCase_TokenizerSimd();
+    void testCase_ManyKeys();
+    void testCase_KeyAtoms();
+    void testCase_LocaleFallback();
 };
 
 QXdgDesktopEntryTest::QXdgDesktopEntryTest()
@@ -116,6 +145,1115 @@ void QXdgDesktopEntryTest::testCase_ParseFile()
     qDebug() << fileName;
 }
 
-QTEST_APPLESS_MAIN(QXdgDesktopEntryTest)
+void QXdgDesktopEntryTest::testCase_MappedFile()
+{
+    QTemporaryFile file("testMapXXXXXX.desktop");
+    QVERIFY(file.open());
+    const QString fileName = file.fileName();
+    QTextStream ts(&file);
+    ts << testFileContent;
+    ts.flush();
+    file.close();
+
+    {
+        QXdgDesktopEntry desktopFile(fileName, QXdgDesktopEntry::MapFile);
+        QCOMPARE(desktopFile.status(), QXdgDesktopEntry::NoError);
+        QCOMPARE(desktopFile.allGroups(true), QStringList({"Desktop Entry", "Desktop Action Gallery", "Desktop Action Create"}));
+        QCOMPARE(desktopFile.localizedValue("Name", "zh_CN"), QStringLiteral("福查看器"));
+        QCOMPARE(desktopFile.rawValue("Icon", "Desktop Action Create"), QStringLiteral("fooview-new"));
+        QCOMPARE(desktopFile.stringListValue("Actions"), QStringList({"Gallery", "Create"}));
+
+        QCOMPARE(desktopFile.setRawValue("barview", "Icon"), true);
+        QCOMPARE(desktopFile.rawValue("Icon"), QStringLiteral("barview"));
+        QCOMPARE(desktopFile.save(), true);
+    }
+
+    QXdgDesktopEntry reloaded(fileName, QXdgDesktopEntry::MapFile);
+    QCOMPARE(reloaded.rawValue("Icon"), QStringLiteral("barview"));
+    QCOMPARE(reloaded.rawValue("Exec", "Desktop Action Gallery"), QStringLiteral("fooview --gallery"));
+}
+
+void QXdgDesktopEntryTest::testCase_ImplicitSharing()
+{
+    QTemporaryFile file("testSharingXXXXXX.desktop");
+    QVERIFY(file.open());
+    file.write(testFileContent.toUtf8());
+    file.close();
+
+    for (QXdgDesktopEntry::LoadOptions options : { QXdgDesktopEntry::DefaultLoad, QXdgDesktopEntry::MapFile }) {
+        QXdgDesktopEntry entry(file.fileName(), options);
+        QVERIFY(entry.isDetached());
+
+        QXdgDesktopEntry copy = entry;
+        QVERIFY(!entry.isDetached());
+        QCOMPARE(copy.localizedValue("Name", "zh_CN"), QStringLiteral("福查看器"));
+
+        // writing to the copy detaches it, the original is left untouched.
+        QVERIFY(copy.setRawValue("Bar Viewer", "Name"));
+        QVERIFY(entry.isDetached());
+        QVERIFY(copy.isDetached());
+        QCOMPARE(copy.rawValue("Name"), QStringLiteral("Bar Viewer"));
+        QCOMPARE(entry.rawValue("Name"), QStringLiteral("Foo Viewer"));
+        QVERIFY(copy.removeEntry("Icon", "Desktop Action Create"));
+        QVERIFY(entry.contains("Icon", "Desktop Action Create"));
+
+        QVector<QXdgDesktopEntry> entries;
+        entries.append(entry);
+        entries.append(std::move(copy));
+        copy = entries.first();
+        QCOMPARE(copy.rawValue("Name"), QStringLiteral("Foo Viewer"));
+        QCOMPARE(entries.last().rawValue("Name"), QStringLiteral("Bar Viewer"));
+    }
+
+    QXdgDesktopEntry empty;
+    QCOMPARE(empty.status(), QXdgDesktopEntry::NoError);
+    QVERIFY(empty.allGroups().isEmpty());
+}
+
+namespace {
+
+class FunctionThread : public QThread
+{
+public:
+    explicit FunctionThread(const std::function<void()> &function)
+        : function(function) {}
+
+protected:
+    void run() override {
+        function();
+    }
+
+private:
+    std::function<void()> function;
+};
+
+} // namespace
+
+static void runInThreads(int threadCount, const std::function<void(int)> &function)
+{
+    QVector<FunctionThread *> threads;
+    for (int i = 0; i < threadCount; i++) {
+        threads.append(new FunctionThread([function, i]() { function(i); }));
+    }
+    for (FunctionThread *thread : threads) {
+        thread->start();
+    }
+    for (FunctionThread *thread : threads) {
+        thread->wait();
+    }
+    qDeleteAll(threads);
+}
+
+static const int concurrentGroupCount = 64;
+static const int concurrentKeyCount = 16;
+
+static QByteArray concurrentTestContent()
+{
+    QByteArray content;
+    for (int i = 0; i < concurrentGroupCount; i++) {
+        content.append(QStringLiteral("[Group %1]\n").arg(i).toUtf8());
+        for (int k = 0; k < concurrentKeyCount; k++) {
+            content.append(QStringLiteral("Key%1=Value %2 %1\n").arg(k).arg(i).toUtf8());
+        }
+        content.append(QStringLiteral("Name=Name %1\nName[de]=Name de %1\nName[fr_FR]=Name fr %1\n").arg(i).toUtf8());
+    }
+    return content;
+}
+
+// Reads every group of the entry, in an order which depends on the seed, returns the number of wrong values.
+static int readConcurrentTestEntry(const QXdgDesktopEntry &entry, int seed)
+{
+    static const char * const locales[] = { "de_DE", "fr_FR", "fr", "en_US" };
+    static const char * const expectedPrefixes[] = { "Name de", "Name fr", "Name", "Name" };
+
+    int errors = 0;
+    for (int g = 0; g < concurrentGroupCount; g++) {
+        const int i = (g * 7 + seed) % concurrentGroupCount;
+        const QString group = QStringLiteral("Group %1").arg(i);
+        if (!entry.contains(QStringLiteral("Key%1").arg(seed % concurrentKeyCount), group)) errors++;
+        for (int k = 0; k < concurrentKeyCount; k++) {
+            if (entry.rawValue(QStringLiteral("Key%1").arg(k), group) != QStringLiteral("Value %2 %1").arg(k).arg(i)) {
+                errors++;
+            }
+        }
+        const int l = (g + seed) % 4;
+        if (entry.localizedValue("Name", locales[l], group) != QStringLiteral("%1 %2").arg(expectedPrefixes[l]).arg(i)) {
+            errors++;
+        }
+    }
+    return errors;
+}
+
+void QXdgDesktopEntryTest::testCase_ConcurrentReads()
+{
+    QTemporaryFile file("testConcurrentXXXXXX.desktop");
+    QVERIFY(file.open());
+    file.write(concurrentTestContent());
+    file.close();
+
+    const int threadCount = qMax(4, QThread::idealThreadCount());
+    for (int round = 0; round < 20; round++) {
+        const QXdgDesktopEntry entry(file.fileName(), round % 2 ? QXdgDesktopEntry::MapFile : QXdgDesktopEntry::DefaultLoad);
+        QAtomicInt errors(0);
+
+        // Readers race on the lazy parsing of the same groups, while writers detach their own copies from it.
+        runInThreads(threadCount, [&](int thread) {
+            if (thread % 4 == 3) {
+                QXdgDesktopEntry copy = entry;
+                if (!copy.setRawValue("Changed", "Key0", QStringLiteral("Group %1").arg(thread))) errors.ref();
+                if (copy.rawValue("Key0", QStringLiteral("Group %1").arg(thread)) != QStringLiteral("Changed")) errors.ref();
+                return;
+            }
+            errors.fetchAndAddRelaxed(readConcurrentTestEntry(entry, thread));
+        });
+
+        QCOMPARE(errors.load(), 0);
+        QCOMPARE(entry.rawValue("Key0", "Group 3"), QStringLiteral("Value 3 0"));
+    }
+
+    QXdgDesktopEntry frozen(file.fileName(), QXdgDesktopEntry::FreezeOnLoad);
+    QVERIFY(frozen.isFrozen());
+    QAtomicInt errors(0);
+    runInThreads(threadCount, [&](int thread) {
+        errors.fetchAndAddRelaxed(readConcurrentTestEntry(frozen, thread));
+    });
+    QCOMPARE(errors.load(), 0);
+
+    // frozen entries, and their copies, can't be modified.
+    QXdgDesktopEntry copy = frozen;
+    QVERIFY(!copy.setRawValue("Changed", "Key0", "Group 0"));
+    QVERIFY(!copy.removeEntry("Key0", "Group 0"));
+    QCOMPARE(copy.rawValue("Key0", "Group 0"), QStringLiteral("Value 0 0"));
+    QVERIFY(!copy.isDetached());
+}
+
+void QXdgDesktopEntryTest::testCase_PartialLoad()
+{
+    QTemporaryFile file("testPartialXXXXXX.desktop");
+    QVERIFY(file.open());
+    file.write(testFileContent.toUtf8());
+    file.close();
+
+    QTemporaryFile largeFile("testPartialLargeXXXXXX.desktop");
+    QVERIFY(largeFile.open());
+    largeFile.write("# comment\n[Desktop Entry]\nType=Application\nNoDisplay=true\nName=Large\n");
+    for (int i = 0; i < 20; i++) {
+        largeFile.write(QStringLiteral("[Vendor Group %1]\n").arg(i).toUtf8());
+        for (int k = 0; k < 500; k++) {
+            largeFile.write(QStringLiteral("Key%1=Value%1\n").arg(k).toUtf8());
+        }
+    }
+    largeFile.close();
+
+    QTemporaryFile singleGroupFile("testPartialSingleXXXXXX.desktop");
+    QVERIFY(singleGroupFile.open());
+    singleGroupFile.write("[Desktop Entry]\nType=Link\nURL=https://example.org\n");
+    singleGroupFile.close();
+
+    for (QXdgDesktopEntry::LoadOptions mapFile : { QXdgDesktopEntry::DefaultLoad, QXdgDesktopEntry::MapFile }) {
+        QXdgDesktopEntry firstGroup(file.fileName(), mapFile | QXdgDesktopEntry::FirstGroupOnly);
+        QCOMPARE(firstGroup.allGroups(), QStringList { "Desktop Entry" });
+        QCOMPARE(firstGroup.localizedValue("Name", "zh_CN"), QStringLiteral("福查看器"));
+        QCOMPARE(firstGroup.rawValue("Actions"), QStringLiteral("Gallery;Create;"));
+        QVERIFY(firstGroup.isPartiallyLoaded());
+        QVERIFY(!firstGroup.save());
+
+        QXdgDesktopEntry peek(file.fileName(), mapFile | QXdgDesktopEntry::PeekOnly);
+        QCOMPARE(peek.allGroups(), QStringList { "Desktop Entry" });
+        QCOMPARE(peek.keys(), QStringList { "Type" });
+        QCOMPARE(peek.rawValue("Type"), QStringLiteral("Application"));
+        QVERIFY(!peek.contains("Name"));
+
+        QXdgDesktopEntry largePeek(largeFile.fileName(), mapFile | QXdgDesktopEntry::PeekOnly);
+        QCOMPARE(largePeek.allGroups(), QStringList { "Desktop Entry" });
+        QCOMPARE(largePeek.keys(), QStringList({ "NoDisplay", "Type" }));
+        QCOMPARE(largePeek.rawValue("NoDisplay"), QStringLiteral("true"));
+
+        QXdgDesktopEntry largeFirstGroup(largeFile.fileName(), mapFile | QXdgDesktopEntry::FirstGroupOnly);
+        QCOMPARE(largeFirstGroup.keys().count(), 3);
+        QCOMPARE(largeFirstGroup.rawValue("Name"), QStringLiteral("Large"));
+
+        QXdgDesktopEntry singleGroup(singleGroupFile.fileName(), mapFile | QXdgDesktopEntry::FirstGroupOnly);
+        QCOMPARE(singleGroup.rawValue("URL"), QStringLiteral("https://example.org"));
+        QVERIFY(!singleGroup.isPartiallyLoaded());
+
+        QXdgDesktopEntry groups(file.fileName(), { "Desktop Action Create", "Missing Group" }, mapFile);
+        QCOMPARE(groups.allGroups(), QStringList { "Desktop Action Create" });
+        QCOMPARE(groups.rawValue("Exec", "Desktop Action Create"), QStringLiteral("fooview --create-new"));
+        QCOMPARE(groups.rawValue("Icon", "Desktop Action Create"), QStringLiteral("fooview-new"));
+        QVERIFY(!groups.contains("Name"));
+        QVERIFY(groups.isPartiallyLoaded());
+
+        QXdgDesktopEntry vendorGroups(largeFile.fileName(), { "Vendor Group 7", "Vendor Group 19" }, mapFile);
+        QCOMPARE(vendorGroups.allGroups(true), QStringList({ "Vendor Group 7", "Vendor Group 19" }));
+        QCOMPARE(vendorGroups.rawValue("Key499", "Vendor Group 19"), QStringLiteral("Value499"));
+        QCOMPARE(vendorGroups.keys("Vendor Group 7").count(), 500);
+    }
+
+    QXdgDesktopEntry full(file.fileName());
+    QVERIFY(!full.isPartiallyLoaded());
+}
+
+namespace {
+
+// A sequential device which hands out its data a few bytes at a time, like a pipe would.
+class TricklingDevice : public QIODevice
+{
+public:
+    explicit TricklingDevice(const QByteArray &data)
+        : data(data) {}
+
+    bool isSequential() const override {
+        return true;
+    }
+
+    qint64 bytesAvailable() const override {
+        return data.size() - pos + QIODevice::bytesAvailable();
+    }
+
+    int readCount = 0;
+
+protected:
+    qint64 readData(char *buffer, qint64 maxSize) override {
+        readCount++;
+        const int length = int(qMin<qint64>(qMin(maxSize, qint64(7)), data.size() - pos));
+        memcpy(buffer, data.constData() + pos, size_t(length));
+        pos += length;
+        return length;
+    }
+
+    qint64 writeData(const char *, qint64) override {
+        return -1;
+    }
+
+private:
+    QByteArray data;
+    int pos = 0;
+};
+
+} // namespace
+
+void QXdgDesktopEntryTest::testCase_FromData()
+{
+    const QByteArray content = testFileContent.toUtf8();
+
+    // parsed in place.
+    const QByteArray rawContent = QByteArray::fromRawData(content.constData(), content.size());
+    QXdgDesktopEntry entry = QXdgDesktopEntry::fromData(rawContent);
+    QCOMPARE(entry.status(), QXdgDesktopEntry::NoError);
+    QCOMPARE(entry.allGroups(true), QStringList({ "Desktop Entry", "Desktop Action Gallery", "Desktop Action Create" }));
+    QCOMPARE(entry.localizedValue("Name", "zh_CN"), QStringLiteral("福查看器"));
+    QCOMPARE(entry.rawValue("Exec", "Desktop Action Gallery"), QStringLiteral("fooview --gallery"));
+    // not associated with any file.
+    QVERIFY(!entry.save());
+
+    QBuffer output;
+    QVERIFY(output.open(QIODevice::WriteOnly));
+    QVERIFY(entry.save(&output));
+    output.close();
+    QXdgDesktopEntry reparsed = QXdgDesktopEntry::fromData(output.data());
+    QCOMPARE(reparsed.allGroups(true), entry.allGroups(true));
+    QCOMPARE(reparsed.keys(), entry.keys());
+    QCOMPARE(reparsed.rawValue("Icon", "Desktop Action Create"), QStringLiteral("fooview-new"));
+
+    QBuffer readOnly;
+    QVERIFY(readOnly.open(QIODevice::ReadOnly));
+    QVERIFY(!entry.save(&readOnly));
+
+    QBuffer buffer;
+    buffer.setData(content);
+    QVERIFY(buffer.open(QIODevice::ReadOnly));
+    QXdgDesktopEntry fromBuffer = QXdgDesktopEntry::fromDevice(&buffer);
+    QCOMPARE(fromBuffer.keys("Desktop Action Create"), QStringList({ "Exec", "Icon", "Name" }));
+
+    TricklingDevice device(content);
+    QVERIFY(device.open(QIODevice::ReadOnly));
+    QXdgDesktopEntry fromDevice = QXdgDesktopEntry::fromDevice(&device);
+    QCOMPARE(fromDevice.status(), QXdgDesktopEntry::NoError);
+    QCOMPARE(fromDevice.allGroups(true), entry.allGroups(true));
+    QCOMPARE(fromDevice.rawValue("MimeType"), QStringLiteral("image/x-foo;"));
+    QVERIFY(device.readCount > 1);
+
+    // stops reading after the first group.
+    TricklingDevice peekDevice(content);
+    QVERIFY(peekDevice.open(QIODevice::ReadOnly));
+    QXdgDesktopEntry peek = QXdgDesktopEntry::fromDevice(&peekDevice, QXdgDesktopEntry::PeekOnly);
+    QCOMPARE(peek.keys(), QStringList { "Type" });
+    QVERIFY(peekDevice.bytesAvailable() > 0);
+
+    QBuffer closed;
+    QCOMPARE(QXdgDesktopEntry::fromDevice(&closed).status(), QXdgDesktopEntry::AccessError);
+    QCOMPARE(QXdgDesktopEntry::fromData(QByteArray()).allGroups(), QStringList());
+}
+
+void QXdgDesktopEntryTest::testCase_Reader()
+{
+    const QByteArray data("# top comment\n[Desktop Entry]\nName=App\nName[de]=Anwendung\n  # indented comment\n"
+                          "bogus line\nExec=app %f\\\n --flag\n#c\n  [NotAGroup]\n[Broken\n"
+                          "[Desktop Action New]\nExec = app --new \n");
+
+    QXdgDesktopEntryReader reader(data);
+    QCOMPARE(reader.tokenType(), QXdgDesktopEntryReader::NoToken);
+
+    QCOMPARE(reader.readNext(), QXdgDesktopEntryReader::Comment);
+    QCOMPARE(reader.tokenOffset(), 0);
+    QVERIFY(reader.comment() == " top comment");
+    QVERIFY(reader.groupName().isEmpty());
+
+    QCOMPARE(reader.readNext(), QXdgDesktopEntryReader::GroupStart);
+    QVERIFY(reader.groupName() == "Desktop Entry");
+    QVERIFY(reader.rawToken() == "[Desktop Entry]");
+
+    QCOMPARE(reader.readNext(), QXdgDesktopEntryReader::KeyValue);
+    QVERIFY(reader.key() == "Name");
+    QVERIFY(reader.baseKey() == "Name");
+    QVERIFY(reader.locale().isEmpty());
+    QVERIFY(reader.value() == "App");
+
+    QCOMPARE(reader.readNext(), QXdgDesktopEntryReader::KeyValue);
+    QVERIFY(reader.key() == "Name[de]");
+    QVERIFY(reader.baseKey() == "Name");
+    QVERIFY(reader.locale() == "de");
+    QCOMPARE(reader.value().toString(), QStringLiteral("Anwendung"));
+
+    QCOMPARE(reader.readNext(), QXdgDesktopEntryReader::Comment);
+    QCOMPARE(reader.tokenOffset(), data.indexOf("# indented"));
+    QCOMPARE(reader.readNext(), QXdgDesktopEntryReader::InvalidLine);
+    QVERIFY(reader.rawToken() == "bogus line");
+    QVERIFY(reader.key().isEmpty());
+
+    // values are raw, an escaped line break doesn't end them.
+    QCOMPARE(reader.readNext(), QXdgDesktopEntryReader::KeyValue);
+    QVERIFY(reader.value() == "app %f\\\n --flag");
+
+    // right after a comment, leading white spaces are part of the line like in QXdgDesktopEntry.
+    QCOMPARE(reader.readNext(), QXdgDesktopEntryReader::Comment);
+    QCOMPARE(reader.readNext(), QXdgDesktopEntryReader::InvalidLine);
+    QVERIFY(reader.groupName() == "Desktop Entry");
+
+    QCOMPARE(reader.readNext(), QXdgDesktopEntryReader::GroupStart);
+    QVERIFY(reader.groupName() == "Broken");
+    QCOMPARE(reader.readNext(), QXdgDesktopEntryReader::GroupStart);
+    QVERIFY(reader.groupName() == "Desktop Action New");
+    QCOMPARE(reader.readNext(), QXdgDesktopEntryReader::KeyValue);
+    QVERIFY(reader.groupName() == "Desktop Action New");
+    QVERIFY(reader.key() == "Exec");
+    QVERIFY(reader.value() == "app --new");
+    QCOMPARE(reader.readNext(), QXdgDesktopEntryReader::EndDocument);
+    QVERIFY(reader.atEnd());
+    QCOMPARE(reader.readNext(), QXdgDesktopEntryReader::EndDocument);
+
+    // the group and key-value loops see the same groups and keys as QXdgDesktopEntry.
+    const QXdgDesktopEntry entry = QXdgDesktopEntry::fromData(data);
+    QStringList groups;
+    reader.setData(data);
+    while (reader.readNextGroup()) {
+        const QString group = reader.groupName().toString();
+        groups << group;
+        QStringList keys;
+        while (reader.readNextKeyValue()) {
+            keys << reader.key().toString();
+            QCOMPARE(reader.value().toString(), entry.rawValue(keys.last(), group));
+        }
+        // keys() is sorted.
+        keys.sort();
+        QCOMPARE(keys, entry.keys(group));
+    }
+    QCOMPARE(groups, entry.allGroups(true));
+
+    // skipping a group in the middle of it.
+    reader.setData(data);
+    QVERIFY(reader.readNextGroup());
+    QVERIFY(reader.readNextKeyValue());
+    QVERIFY(reader.readNextGroup());
+    QVERIFY(reader.groupName() == "Broken");
+    QVERIFY(!reader.readNextKeyValue());
+    QVERIFY(reader.readNextGroup());
+    QVERIFY(reader.groupName() == "Desktop Action New");
+    QVERIFY(!reader.readNextGroup());
+
+    QXdgDesktopEntryReader emptyReader;
+    QCOMPARE(emptyReader.readNext(), QXdgDesktopEntryReader::EndDocument);
+    QVERIFY(!emptyReader.readNextGroup());
+}
+
+void QXdgDesktopEntryTest::testCase_Escape()
+{
+    QString str = QStringLiteral("a\\sb\\nc\\\\d\\;e\\x\\");
+    QCOMPARE(QXdgDesktopEntry::unescape(str), QStringLiteral("a b\nc\\d\\;e\\x\\"));
+    str = QStringLiteral("a\\;b");
+    QCOMPARE(QXdgDesktopEntry::unescape(str, true), QStringLiteral("a;b"));
+
+    // the string rule applies first, then the Exec quoting.
+    str = QStringLiteral("\"a\\\\\"b\\\\\\\\c\\\\$\"");
+    QCOMPARE(QXdgDesktopEntry::unescapeExec(str), QStringLiteral("\"a\"b\\c$\""));
+
+    const QString plain = QStringLiteral("Nothing to do here");
+    QString copy = plain;
+    QCOMPARE(QXdgDesktopEntry::escape(copy), plain);
+    QCOMPARE(QXdgDesktopEntry::unescape(copy), plain);
+    QCOMPARE(QXdgDesktopEntry::unescapeExec(copy), plain);
+    QVERIFY(copy.constData() == plain.constData());
+
+    const QString special = QStringLiteral("tab\there\nback\\slash \"$x`'");
+    str = special;
+    QCOMPARE(QXdgDesktopEntry::escape(str), QStringLiteral("tab\\there\\nback\\\\slash \"$x`'"));
+    QCOMPARE(QXdgDesktopEntry::unescape(str), special);
+    str = special;
+    QCOMPARE(QXdgDesktopEntry::escapeExec(str), QStringLiteral("tab\\there\\nback\\\\\\\\slash \\\\\"\\\\$x\\\\`\\\\'"));
+    QCOMPARE(QXdgDesktopEntry::unescapeExec(str), special);
+
+    // the output buffer overloads, including one which reads from its own output.
+    QString out;
+    QCOMPARE(QXdgDesktopEntry::escape(QStringView(special), out), QStringLiteral("tab\\there\\nback\\\\slash \"$x`'"));
+    QCOMPARE(QXdgDesktopEntry::unescape(QStringView(out), out), special);
+    QCOMPARE(QXdgDesktopEntry::escapeExec(QStringView(out), out), QXdgDesktopEntry::escapeExec(str = special));
+    QCOMPARE(QXdgDesktopEntry::unescapeExec(QStringView(out), out), special);
+
+    QXdgDesktopEntry entry;
+    QVERIFY(entry.setStringValue(special, "Comment"));
+    QCOMPARE(entry.stringValue("Comment"), special);
+
+    QVERIFY(entry.setRawValue("a\\\\;b\\;c;;d", "List"));
+    QCOMPARE(entry.stringListValue("List"), QStringList({"a\\", "b;c", "", "d"}));
+    QVERIFY(entry.setRawValue("", "List"));
+    QCOMPARE(entry.stringListValue("List"), QStringList());
+    QCOMPARE(entry.stringListValue("Missing"), QStringList());
+}
+
+void QXdgDesktopEntryTest::testCase_Exec()
+{
+    QXdgDesktopEntryExec multiple("foo --bar \"quoted arg\" %F");
+    QVERIFY(multiple.isValid());
+    QCOMPARE(multiple.program(), QStringLiteral("foo"));
+    QVERIFY(multiple.acceptsMultipleFiles());
+    QVERIFY(!multiple.acceptsUrls());
+    // %F only takes local files.
+    QCOMPARE(multiple.commandLines({"/a", "file:///b", "http://example.org/c"}),
+             QList<QStringList>({{"foo", "--bar", "quoted arg", "/a", "/b"}}));
+
+    QXdgDesktopEntryExec single("\"/opt/My App/run\" --file=%f %i %c %k 100%% %d");
+    QVERIFY(single.isValid());
+    single.setIconName("icon");
+    single.setName("Name");
+    single.setLocation("/tmp/app.desktop");
+    QCOMPARE(single.commandLines({"/a", "/b"}),
+             QList<QStringList>({{"/opt/My App/run", "--file=/a", "--icon", "icon", "Name", "/tmp/app.desktop", "100%"},
+                                 {"/opt/My App/run", "--file=/b", "--icon", "icon", "Name", "/tmp/app.desktop", "100%"}}));
+
+    QXdgDesktopEntryExec url("app %u");
+    QVERIFY(url.acceptsUrls());
+    QCOMPARE(url.commandLines({"/a b"}), QList<QStringList>({{"app", "file:///a%20b"}}));
+    QCOMPARE(url.commandLines(), QList<QStringList>({{"app"}}));
+    QCOMPARE(QXdgDesktopEntryExec("app").commandLines({"/a", "/b"}), QList<QStringList>({{"app"}}));
+
+    // the string escapes are resolved first, then the quoting.
+    QXdgDesktopEntryExec quoted("sh -c \"echo \\\\\"hi\\\\\" \\\\$HOME\"");
+    QCOMPARE(quoted.commandLines(), QList<QStringList>({{"sh", "-c", "echo \"hi\" $HOME"}}));
+
+    for (const char *invalid : {"app \"unterminated", "app %z", "app %", "%f", "\"\" arg", ""}) {
+        QXdgDesktopEntryExec exec(QString::fromLatin1(invalid));
+        QVERIFY2(!exec.isValid(), invalid);
+        QVERIFY(exec.commandLines({"/a"}).isEmpty());
+        QVERIFY(!exec.startDetached());
+    }
+
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    QXdgDesktopEntry entry = QXdgDesktopEntry::fromData("[Desktop Entry]\nName=Toucher\nIcon=toucher\nExec=touch %F\n"
+                                                        "[Desktop Action Here]\nExec=touch here\nPath=" + dir.path().toUtf8() + "\n");
+    QXdgDesktopEntryExec exec = entry.exec();
+    QVERIFY(exec.isValid());
+    QCOMPARE(exec.iconName(), QStringLiteral("toucher"));
+    QCOMPARE(exec.name(), QStringLiteral("Toucher"));
+    QVERIFY(exec.workingDirectory().isEmpty());
+
+    const QString first = dir.filePath("first");
+    const QString second = dir.filePath("second");
+    QList<qint64> pids;
+    QVERIFY(exec.startDetached({first, QUrl::fromLocalFile(second).toString()}, &pids));
+    QCOMPARE(pids.count(), 1);
+    QTRY_VERIFY(QFile::exists(first) && QFile::exists(second));
+
+    QXdgDesktopEntryExec action = entry.exec("Desktop Action Here");
+    QCOMPARE(action.workingDirectory(), dir.path());
+    QVERIFY(action.startDetached());
+    QTRY_VERIFY(QFile::exists(dir.filePath("here")));
+
+    // the cached command line is dropped when the section changes.
+    QVERIFY(entry.setRawValue("touch %f", "Exec"));
+    QVERIFY(!entry.exec().acceptsMultipleFiles());
+    QCOMPARE(entry.exec().commandLines({"/a", "/b"}).count(), 2);
+
+    // freeze() parses the Exec keys of every section up front.
+    entry.freeze();
+    QXdgStats::setEnabled(true);
+    QXdgStats::reset();
+    QCOMPARE(entry.exec("Desktop Action Here").workingDirectory(), dir.path());
+    QCOMPARE(QXdgStats::snapshot().cacheHits, quint64(1));
+    QVERIFY(!entry.exec("Missing").isValid());
+    QXdgStats::setEnabled(false);
+}
+
+void QXdgDesktopEntryTest::testCase_Visitors()
+{
+    QXdgDesktopEntry entry = QXdgDesktopEntry::fromData("[Desktop Entry]\nName=App\nMimeType=text/plain;image/png;\n"
+                                                        "Keywords=a\\;b;\\sc;;caf\xc3\xa9;\xf0\x9f\x98\x80\n"
+                                                        "[Desktop Action Zeta]\nExec=zeta\n[Desktop Action Alpha]\n");
+
+    QStringList groups;
+    QVERIFY(entry.forEachGroup([&groups](QStringView group) {
+        groups << group.toString();
+        return true;
+    }));
+    QCOMPARE(groups, entry.allGroups(true));
+
+    QStringList keys;
+    QVERIFY(entry.forEachKey([&keys](QStringView key) {
+        keys << key.toString();
+        return true;
+    }));
+    QCOMPARE(keys, QStringList({"Name", "MimeType", "Keywords"}));
+    QVERIFY(entry.forEachKey([](QStringView) { return false; }, "Missing"));
+
+    QStringList items;
+    QVERIFY(entry.forEachListItem("Keywords", [&items](QStringView item) {
+        items << item.toString();
+        return true;
+    }));
+    QCOMPARE(items, QStringList({"a;b", " c", "", QString::fromUtf8("caf\xc3\xa9"), QString::fromUtf8("\xf0\x9f\x98\x80")}));
+    QCOMPARE(entry.stringListValue("Keywords"), items);
+
+    // returning false stops the walk.
+    int visited = 0;
+    QVERIFY(!entry.forEachListItem("MimeType", [&visited](QStringView mimeType) {
+        visited++;
+        return !mimeType.startsWith(QLatin1String("text/"));
+    }));
+    QCOMPARE(visited, 1);
+
+    // modified values are walked too.
+    QVERIFY(entry.setRawValue("x\\;y;z", "MimeType"));
+    items.clear();
+    entry.forEachListItem("MimeType", [&items](QStringView item) {
+        items << item.toString();
+        return true;
+    });
+    QCOMPARE(items, QStringList({"x;y", "z"}));
+}
+
+void QXdgDesktopEntryTest::testCase_TypedValues()
+{
+    QXdgDesktopEntry entry = QXdgDesktopEntry::fromData("[Desktop Entry]\nName=App\nName[de]=Anwendung\nHidden=true\n"
+                                                        "NoDisplay=0\nTerminal=maybe\nCategories=Qt;Utility;\n"
+                                                        "X-Scale=1.5\nX-Flag=false\nX-List=a;b\\\\;\nX-Text=a\\;\n");
+
+    QVERIFY(entry.boolValue("Hidden"));
+    QVERIFY(entry.boolValue("Hidden"));
+    QVERIFY(!entry.boolValue("NoDisplay", "Desktop Entry", true));
+    QVERIFY(entry.boolValue("Terminal", "Desktop Entry", true));
+    QVERIFY(!entry.boolValue("Terminal"));
+    QVERIFY(entry.boolValue("StartupNotify", "Desktop Entry", true));
+    QCOMPARE(entry.numericValue("X-Scale"), 1.5);
+    QCOMPARE(entry.numericValue("Name", "Desktop Entry", -1), -1.0);
+    QCOMPARE(entry.numericValue("Missing", "Desktop Entry", 2), 2.0);
+
+    QCOMPARE(entry.valueType("Name"), QXdgDesktopEntry::String);
+    QCOMPARE(entry.valueType("Name[de]"), QXdgDesktopEntry::String);
+    QCOMPARE(entry.valueType("Terminal"), QXdgDesktopEntry::Boolean);
+    QCOMPARE(entry.valueType("Categories"), QXdgDesktopEntry::Strings);
+    QCOMPARE(entry.valueType("X-Scale"), QXdgDesktopEntry::Numeric);
+    QCOMPARE(entry.valueType("X-Flag"), QXdgDesktopEntry::Boolean);
+    QCOMPARE(entry.valueType("X-List"), QXdgDesktopEntry::Strings);
+    QCOMPARE(entry.valueType("X-Text"), QXdgDesktopEntry::String);
+    QCOMPARE(entry.valueType("Missing"), QXdgDesktopEntry::NotExisted);
+
+    // cached lists are shared, not split again.
+    const QStringList categories = entry.stringListValue("Categories");
+    QCOMPARE(categories, QStringList({"Qt", "Utility"}));
+    QVERIFY(entry.stringListValue("Categories").isSharedWith(categories));
+    QCOMPARE(entry.stringListValue("X-List"), QStringList({"a", "b\\"}));
+
+    // modifying a value drops what was cached for it, copies keep their own.
+    QXdgDesktopEntry copy = entry;
+    QVERIFY(entry.setRawValue("false", "Hidden"));
+    QVERIFY(entry.setRawValue("Qt;", "Categories"));
+    QVERIFY(entry.setRawValue("2", "X-Scale"));
+    QVERIFY(!entry.boolValue("Hidden", "Desktop Entry", true));
+    QCOMPARE(entry.stringListValue("Categories"), QStringList({"Qt"}));
+    QCOMPARE(entry.numericValue("X-Scale"), 2.0);
+    QVERIFY(copy.boolValue("Hidden"));
+    QCOMPARE(copy.stringListValue("Categories"), categories);
+    QCOMPARE(copy.numericValue("X-Scale"), 1.5);
+}
+
+void QXdgDesktopEntryTest::testCase_IncrementalSave()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString fileName = dir.filePath("app.desktop");
+    const QByteArray content("# header comment\n[Desktop Entry]\nName=App\n# keep me\nExec = app %f\n  Icon=app\n"
+                             "Hidden=false\n\n[Desktop Action New]\nName=New\n");
+    QFile file(fileName);
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    file.write(content);
+    file.close();
+
+    QXdgDesktopEntry entry(fileName);
+    QCOMPARE(entry.rawValue("Icon"), QStringLiteral("app"));
+    QVERIFY(!entry.isModified());
+    // nothing changed, so nothing is written.
+    QVERIFY(QFile::remove(fileName));
+    QVERIFY(entry.save());
+    QVERIFY(!QFile::exists(fileName));
+
+    QVERIFY(entry.setRawValue("app2 %f", "Exec"));
+    QVERIFY(entry.removeEntry("Icon"));
+    QVERIFY(entry.setRawValue("x", "X-New"));
+    QVERIFY(entry.setRawValue("y", "X-Other", "Desktop Action Other"));
+    QVERIFY(entry.isModified());
+    QVERIFY(entry.save());
+    QVERIFY(!entry.isModified());
+
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    QCOMPARE(file.readAll(), QByteArray("# header comment\n[Desktop Entry]\nName=App\n# keep me\nExec = app2 %f\n"
+                                        "Hidden=false\nX-New=x\n\n[Desktop Action New]\nName=New\n"
+                                        "[Desktop Action Other]\nX-Other=y\n"));
+    file.close();
+
+    QXdgDesktopEntry reloaded(fileName);
+    QCOMPARE(reloaded.allGroups(true), QStringList({"Desktop Entry", "Desktop Action New", "Desktop Action Other"}));
+    QCOMPARE(reloaded.rawValue("Exec"), QStringLiteral("app2 %f"));
+    QVERIFY(!reloaded.contains("Icon"));
+}
+
+void QXdgDesktopEntryTest::testCase_Transaction()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString first = dir.filePath("first.desktop");
+    const QString second = dir.filePath("second.desktop");
+    const QString created = dir.filePath("sub/created.desktop");
+    for (const QString &fileName : {first, second}) {
+        QFile file(fileName);
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        file.write("[Desktop Entry]\nName=Old\n");
+    }
+
+    QXdgDesktopEntry firstEntry(first);
+    QXdgDesktopEntry secondEntry(second);
+    QXdgDesktopEntry createdEntry(created);
+    QVERIFY(firstEntry.setRawValue("First", "Name"));
+    QVERIFY(createdEntry.setRawValue("Created", "Name"));
+
+    QXdgDesktopEntryTransaction transaction;
+    transaction.add(firstEntry);
+    transaction.add(secondEntry);
+    transaction.add(createdEntry);
+    QCOMPARE(transaction.count(), 3);
+    QVERIFY2(transaction.commit(), qPrintable(transaction.errorString()));
+    QCOMPARE(transaction.count(), 0);
+    QVERIFY(!firstEntry.isModified());
+    QVERIFY(!createdEntry.isModified());
+
+    QCOMPARE(QXdgDesktopEntry(first).rawValue("Name"), QStringLiteral("First"));
+    QCOMPARE(QXdgDesktopEntry(second).rawValue("Name"), QStringLiteral("Old"));
+    QCOMPARE(QXdgDesktopEntry(created).rawValue("Name"), QStringLiteral("Created"));
+
+    // the second file can't be replaced, so the first one must not be either.
+    const QString blocked = dir.filePath("blocked.desktop");
+    QXdgDesktopEntry blockedEntry(blocked);
+    QVERIFY(blockedEntry.setRawValue("Blocked", "Name"));
+    QVERIFY(QDir().mkpath(blocked + "/content"));
+    QVERIFY(firstEntry.setRawValue("Again", "Name"));
+    transaction.add(firstEntry);
+    transaction.add(blockedEntry);
+    QVERIFY(!transaction.commit());
+    QVERIFY(transaction.errorString().startsWith(blocked));
+    QCOMPARE(transaction.count(), 2);
+    QVERIFY(firstEntry.isModified());
+    QCOMPARE(QXdgDesktopEntry(first).rawValue("Name"), QStringLiteral("First"));
+    // no temporary file is left behind.
+    QCOMPARE(QDir(dir.path()).entryList(QDir::Files | QDir::Hidden),
+             QStringList({"first.desktop", "second.desktop"}));
+}
+
+void QXdgDesktopEntryTest::testCase_Stats()
+{
+    QVERIFY(!QXdgStats::isEnabled());
+    QXdgStats::setEnabled(true);
+    QXdgStats::reset();
+    const QXdgStats before = QXdgStats::snapshot();
+    QCOMPARE(before.lookups, quint64(0));
+
+    {
+        const QXdgDesktopEntry entry = QXdgDesktopEntry::fromData("[Desktop Entry]\nName=Foo\nNoDisplay=true\n\n"
+                                                                  "[Desktop Action New]\nName=New\n");
+        QCOMPARE(entry.rawValue("Name"), QStringLiteral("Foo"));
+        QVERIFY(entry.boolValue("NoDisplay"));
+        QVERIFY(entry.boolValue("NoDisplay"));
+        QString escaped = "a b";
+        QXdgDesktopEntry::unescape(QXdgDesktopEntry::escape(escaped));
+
+        const QXdgStats stats = QXdgStats::snapshot();
+        QCOMPARE(stats.sectionsDiscovered, quint64(2));
+        QCOMPARE(stats.sectionsParsed, quint64(1));
+        QCOMPARE(stats.lookups, quint64(3));
+        QCOMPARE(stats.cacheHits, quint64(1));
+        QCOMPARE(stats.escapeCalls, quint64(1));
+        QCOMPARE(stats.unescapeCalls, quint64(1));
+        QCOMPARE(stats.liveEntries, before.liveEntries + 1);
+        QVERIFY(stats.liveEntryBytes > before.liveEntryBytes);
+        QVERIFY(stats.bytesPerEntry() > 0);
+    }
+    // destroyed entries don't hold anything anymore.
+    QCOMPARE(QXdgStats::snapshot().liveEntries, before.liveEntries);
+    QCOMPARE(QXdgStats::snapshot().liveEntryBytes, before.liveEntryBytes);
+
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString filePath = dir.filePath("stats.desktop");
+    QFile file(filePath);
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    QCOMPARE(file.write("[Desktop Entry]\nName=Foo\n"), qint64(25));
+    file.close();
+
+    QXdgDesktopEntry entry(filePath);
+    QVERIFY(entry.setRawValue("Bar", "Name"));
+    QVERIFY(entry.save());
+    const QXdgStats stats = QXdgStats::snapshot();
+    QCOMPARE(stats.filesRead, quint64(1));
+    QCOMPARE(stats.bytesRead, quint64(25));
+    QCOMPARE(stats.saves, quint64(1));
+    QVERIFY(stats.maxSaveNanoseconds > 0);
+    QCOMPARE(stats.averageSaveNanoseconds(), stats.maxSaveNanoseconds);
+    QVERIFY(stats.toString().contains("saves:"));
+
+    // nothing is counted while it's off.
+    QXdgStats::setEnabled(false);
+    entry.rawValue("Name");
+    QCOMPARE(QXdgStats::snapshot().lookups, stats.lookups);
+}
+
+void QXdgDesktopEntryTest::testCase_GroupHeaders()
+{
+    QTemporaryFile file("testGroupsXXXXXX.desktop");
+    QVERIFY(file.open());
+    const QString fileName = file.fileName();
+    // escaped line break, leading white spaces and CRLF line endings.
+    file.write("[Desktop Entry]\nName=A\\\n[NotAGroup]\n  [Desktop Action Foo]\nName=B\r\n"
+               "# [NotAGroupEither]\r\n[Desktop Action Bar]\r\nExec=bar\n");
+    file.close();
+
+    QXdgDesktopEntry desktopFile(fileName);
+    QCOMPARE(desktopFile.allGroups(true), QStringList({"Desktop Entry", "Desktop Action Foo", "Desktop Action Bar"}));
+    QCOMPARE(desktopFile.rawValue("Name", "Desktop Action Foo"), QStringLiteral("B"));
+    QCOMPARE(desktopFile.rawValue("Exec", "Desktop Action Bar"), QStringLiteral("bar"));
+}
+
+void QXdgDesktopEntryTest::testCase_SectionOrder()
+{
+    // lots of action groups, in an order which is not the one of their names.
+    QByteArray content("[Desktop Entry]\nName=Many\n");
+    QStringList expectedGroups { "Desktop Entry" };
+    for (int i = 300; i > 0; i--) {
+        const QString group = QStringLiteral("Desktop Action %1").arg(i);
+        content.append(QStringLiteral("[%1]\nName=%2\n").arg(group).arg(i).toUtf8());
+        expectedGroups << group;
+    }
+    const QXdgDesktopEntry many = QXdgDesktopEntry::fromData(content);
+    QCOMPARE(many.allGroups(true), expectedGroups);
+    QStringList groupsByName = expectedGroups;
+    groupsByName.sort();
+    QCOMPARE(many.allGroups(), groupsByName);
+    QCOMPARE(many.rawValue("Name", "Desktop Action 17"), QStringLiteral("17"));
+
+    // the first of duplicated groups is the one which is used, the others are kept for saving.
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString filePath = dir.filePath("duplicate.desktop");
+    QFile file(filePath);
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    file.write("[Desktop Entry]\nName=First\n[Desktop Action A]\nExec=a\n[Desktop Entry]\nName=Second\n");
+    file.close();
+
+    QXdgDesktopEntry duplicate(filePath);
+    QCOMPARE(duplicate.status(), QXdgDesktopEntry::FormatError);
+    QCOMPARE(duplicate.rawValue("Name"), QStringLiteral("First"));
+    QCOMPARE(duplicate.allGroups(true), QStringList({ "Desktop Entry", "Desktop Action A" }));
+    int groupCount = 0;
+    duplicate.forEachGroup([&groupCount](QStringView) {
+        groupCount++;
+        return true;
+    });
+    QCOMPARE(groupCount, 2);
+
+    QVERIFY(duplicate.setRawValue("Changed", "Name"));
+    QVERIFY(duplicate.setRawValue("b", "Exec", "Desktop Action B"));
+    QVERIFY(duplicate.save());
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    QCOMPARE(file.readAll(), QByteArray("[Desktop Entry]\nName=Changed\n[Desktop Action A]\nExec=a\n"
+                                        "[Desktop Entry]\nName=Second\n[Desktop Action B]\nExec=b\n"));
+}
+
+// The byte-at-a-time tokenizer which was used before the vectorized one, kept as-is for differential testing.
+enum { Space = 0x1, Special = 0x2 };
+
+static const char charTraits[256] = {
+    // Space: '\t', '\n', '\r', ' '
+    // Special: '\n', '\r', ';', '=', '\\', '#'
+    // Please note that '"' is NOT a special character
+
+    0, 0, 0, 0, 0, 0, 0, 0, 0, Space, Space | Special, 0, 0, Space | Special, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    Space, 0, 0, Special, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, Special, 0, Special, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, Special, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+};
+
+static bool referenceReadLineFromData(const QByteArray &data, int &dataPos, int &lineStart, int &lineLen, int &equalsPos)
+{
+    int dataLen = data.length();
+
+    equalsPos = -1;
+
+    lineStart = dataPos;
+    while (lineStart < dataLen && (charTraits[uint(uchar(data.at(lineStart)))] & Space))
+        ++lineStart;
+
+    int i = lineStart;
+    while (i < dataLen) {
+        while (!(charTraits[uint(uchar(data.at(i)))] & Special)) {
+            if (++i == dataLen)
+                goto break_out_of_outer_loop;
+        }
+
+        char ch = data.at(i++);
+        if (ch == '=') {
+            if (equalsPos == -1)
+                equalsPos = i - 1;
+        } else if (ch == '\n' || ch == '\r') {
+            if (i == lineStart + 1) {
+                ++lineStart;
+            } else {
+                --i;
+                goto break_out_of_outer_loop;
+            }
+        } else if (ch == '\\') {
+            if (i < dataLen) {
+                char ch = data.at(i++);
+                if (i < dataLen) {
+                    char ch2 = data.at(i);
+                    // \n, \r, \r\n, and \n\r are legitimate line terminators in INI files
+                    if ((ch == '\n' && ch2 == '\r') || (ch == '\r' && ch2 == '\n'))
+                        ++i;
+                }
+            }
+        } else if (ch == ';') {
+            // The multiple values should be separated by a semicolon and the value of the key
+            // may be optionally terminated by a semicolon. Trailing empty strings must always
+            // be terminated with a semicolon. Semicolons in these values need to be escaped
+            // using \; .
+            // Don't need to do anything here.
+        } else {
+            Q_ASSERT(ch == '#');
+
+            if (i == lineStart + 1) {
+                char ch;
+                while (i < dataLen && (((ch = data.at(i)) != '\n') && ch != '\r'))
+                    ++i;
+                lineStart = i;
+            }
+        }
+    }
+
+break_out_of_outer_loop:
+    dataPos = i;
+    lineLen = i - lineStart;
+    return lineLen > 0;
+}
+
+static QByteArray randomDesktopEntryData(std::mt19937 &generator)
+{
+    // mostly plain text, with all the characters the tokenizer cares about mixed in.
+    static const char specials[] = "=[]#;\\\n\r \t";
+    std::uniform_int_distribution<int> lengthDist(0, 200);
+    std::uniform_int_distribution<int> percentDist(0, 99);
+    std::uniform_int_distribution<int> specialDist(0, int(sizeof(specials)) - 2);
+
+    QByteArray data;
+    const int length = lengthDist(generator);
+    for (int i = 0; i < length; i++) {
+        data.append(percentDist(generator) < 70 ? char('a' + percentDist(generator) % 26) : specials[specialDist(generator)]);
+    }
+    return data;
+}
+
+void QXdgDesktopEntryTest::testCase_TokenizerSimd()
+{
+    const QXdgSimdLevel bestLevel = qxdgBestTokenizerSimdLevel();
+    QCOMPARE(qxdgTokenizerSimdLevel(), bestLevel);
+
+    QList<QByteArray> samples;
+    samples << testFileContent.toUtf8() << QByteArray() << QByteArray("\\") << QByteArray("#\n  [a]\\\r\n[b]");
+    std::mt19937 generator(20190109);
+    for (int i = 0; i < 20000; i++) {
+        samples << randomDesktopEntryData(generator);
+    }
+
+    for (QXdgSimdLevel level : {QXdgSimdLevel::Scalar, QXdgSimdLevel::Sse2, QXdgSimdLevel::Avx2}) {
+        if (!qxdgSetTokenizerSimdLevel(level)) {
+            QVERIFY(level > bestLevel);
+            continue;
+        }
+
+        for (const QByteArray &data : samples) {
+            int refPos = 0, refLineStart, refLineLen, refEqualsPos;
+            int pos = 0, lineStart, lineLen, equalsPos;
+            QVector<QXdgDesktopEntryGroupHeader> refHeaders;
+            while (true) {
+                bool refOk = referenceReadLineFromData(data, refPos, refLineStart, refLineLen, refEqualsPos);
+                bool ok = readLineFromData(data.constData(), data.length(), pos, lineStart, lineLen, equalsPos);
+                QCOMPARE(ok, refOk);
+                QCOMPARE(pos, refPos);
+                QCOMPARE(lineStart, refLineStart);
+                QCOMPARE(lineLen, refLineLen);
+                QCOMPARE(equalsPos, refEqualsPos);
+                if (!refOk) break;
+                if (data.at(refLineStart) == '[') {
+                    refHeaders.append({refLineStart, refLineLen});
+                }
+            }
+
+            const QVector<QXdgDesktopEntryGroupHeader> headers = readGroupHeadersFromData(data.constData(), data.length());
+            QCOMPARE(headers.count(), refHeaders.count());
+            for (int i = 0; i < headers.count(); i++) {
+                QCOMPARE(headers[i].lineStart, refHeaders[i].lineStart);
+                QCOMPARE(headers[i].lineLen, refHeaders[i].lineLen);
+            }
+        }
+    }
+
+    QVERIFY(qxdgSetTokenizerSimdLevel(bestLevel));
+}
+
+void QXdgDesktopEntryTest::testCase_ManyKeys()
+{
+    QTemporaryFile file("testManyKeysXXXXXX.desktop");
+    QVERIFY(file.open());
+    const QString fileName = file.fileName();
+    QByteArray content("[Desktop Entry]\n");
+    for (int i = 39; i >= 0; i--) {
+        content.append(QStringLiteral("Key%1=Value%1\n").arg(i).toUtf8());
+    }
+    // the last one wins for duplicated keys.
+    content.append("Key7=Duplicated\n");
+    file.write(content);
+    file.close();
+
+    QXdgDesktopEntry desktopFile(fileName);
+    QCOMPARE(desktopFile.keys().count(), 40);
+    QCOMPARE(desktopFile.rawValue("Key0"), QStringLiteral("Value0"));
+    QCOMPARE(desktopFile.rawValue("Key39"), QStringLiteral("Value39"));
+    QCOMPARE(desktopFile.rawValue("Key7"), QStringLiteral("Duplicated"));
+
+    QCOMPARE(desktopFile.removeEntry("Key20"), true);
+    QCOMPARE(desktopFile.removeEntry("Key20"), false);
+    QCOMPARE(desktopFile.contains("Key20"), false);
+    QCOMPARE(desktopFile.rawValue("Key19"), QStringLiteral("Value19"));
+    QCOMPARE(desktopFile.rawValue("Key21"), QStringLiteral("Value21"));
+    QCOMPARE(desktopFile.setRawValue("NewValue", "NewKey"), true);
+    QCOMPARE(desktopFile.setRawValue("Changed", "Key39"), true);
+    QCOMPARE(desktopFile.save(), true);
+
+    // keys are written back in their original order, new keys go last. Lines which are not modified stay
+    // as they were, even the overridden duplicate.
+    QFile savedFile(fileName);
+    QVERIFY(savedFile.open(QIODevice::ReadOnly));
+    const QList<QByteArray> lines = savedFile.readAll().split('\n');
+    QCOMPARE(lines[0], QByteArray("[Desktop Entry]"));
+    QCOMPARE(lines[1], QByteArray("Key39=Changed"));
+    QCOMPARE(lines[2], QByteArray("Key38=Value38"));
+    QCOMPARE(lines[20], QByteArray("Key19=Value19"));
+    QCOMPARE(lines[32], QByteArray("Key7=Value7"));
+    QCOMPARE(lines[40], QByteArray("Key7=Duplicated"));
+    QCOMPARE(lines[41], QByteArray("NewKey=NewValue"));
+}
+
+void QXdgDesktopEntryTest::testCase_KeyAtoms()
+{
+    QCOMPARE(QXdgKeyAtomTable::intern("Name", 4), QXdgKeyAtom(QXdgKeyAtomTable::Name));
+    QCOMPARE(QXdgKeyAtomTable::intern(QStringLiteral("SingleMainWindow")), QXdgKeyAtom(QXdgKeyAtomTable::SingleMainWindow));
+    QCOMPARE(QXdgKeyAtomTable::name(QXdgKeyAtomTable::Categories), QStringLiteral("Categories"));
+
+    QCOMPARE(QXdgKeyAtomTable::find(QStringLiteral("X-QXdg-Never-Interned")), QXdgKeyAtom(QXdgKeyAtomTable::InvalidAtom));
+    const QXdgKeyAtom custom = QXdgKeyAtomTable::intern(QStringLiteral("X-QXdg-Custom"));
+    QVERIFY(custom >= QXdgKeyAtomTable::WellKnownKeyCount);
+    QCOMPARE(QXdgKeyAtomTable::intern("X-QXdg-Custom", 13), custom);
+    QCOMPARE(QXdgKeyAtomTable::find(QStringLiteral("X-QXdg-Custom")), custom);
+    QCOMPARE(QXdgKeyAtomTable::name(custom), QStringLiteral("X-QXdg-Custom"));
+
+    const QString localized = QStringLiteral("Name[zh_CN]");
+    QVERIFY(QXdgKeyAtomTable::intern(localized) != QXdgKeyAtom(QXdgKeyAtomTable::Name));
+    QCOMPARE(QXdgKeyAtomTable::name(QXdgKeyAtomTable::intern(QStringLiteral("名称"))), QStringLiteral("名称"));
+
+    // the stored names don't move when the table grows.
+    const QString *customName = &QXdgKeyAtomTable::nameRef(custom);
+    QVector<QXdgKeyAtom> grown;
+    for (int i = 0; i < 300; i++) {
+        grown << QXdgKeyAtomTable::intern(QStringLiteral("X-QXdg-Grow-%1").arg(i));
+    }
+    QCOMPARE(&QXdgKeyAtomTable::nameRef(custom), customName);
+    for (int i = 0; i < grown.count(); i++) {
+        QCOMPARE(QXdgKeyAtomTable::nameRef(grown.at(i)), QStringLiteral("X-QXdg-Grow-%1").arg(i));
+    }
+    QVERIFY(QXdgKeyAtomTable::nameRef(grown.last() + 1).isEmpty());
+}
+
+void QXdgDesktopEntryTest::testCase_LocaleFallback()
+{
+    QTemporaryFile file("testLocaleFallbackXXXXXX.desktop");
+    QVERIFY(file.open());
+    file.write("[Desktop Entry]\n"
+               "Name[sr]=sr\n"
+               "Name[sr_YU]=sr_YU\n"
+               "Name[sr@Latn]=sr@Latn\n"
+               "Name=Untranslated\n"
+               "Name[de]=de\n"
+               "Comment[C]=C\n");
+    file.close();
+
+    QXdgDesktopEntry desktopFile(file.fileName());
+    QCOMPARE(desktopFile.localizedValue("Name", "sr_YU@Latn"), QStringLiteral("sr_YU"));
+    QCOMPARE(desktopFile.localizedValue("Name", "sr_CS@Latn"), QStringLiteral("sr@Latn"));
+    QCOMPARE(desktopFile.localizedValue("Name", "sr_CS.UTF-8"), QStringLiteral("sr"));
+    QCOMPARE(desktopFile.localizedValue("Name", "de_AT"), QStringLiteral("de"));
+    QCOMPARE(desktopFile.localizedValue("Name", "fr_FR"), QStringLiteral("Untranslated"));
+    QCOMPARE(desktopFile.localizedValue("Name", "empty"), QStringLiteral("Untranslated"));
+    QCOMPARE(desktopFile.localizedValue("Comment", "fr_FR"), QStringLiteral("C"));
+    QCOMPARE(desktopFile.localizedValue("Icon", "fr_FR", "Desktop Entry", "fallback"), QStringLiteral("fallback"));
+
+    // the variants follow modifications.
+    QVERIFY(desktopFile.setLocalizedValue("fr", "fr", "Name"));
+    QCOMPARE(desktopFile.localizedValue("Name", "fr_FR"), QStringLiteral("fr"));
+    QVERIFY(desktopFile.removeEntry("Name[sr_YU]"));
+    QCOMPARE(desktopFile.localizedValue("Name", "sr_YU@Latn"), QStringLiteral("sr@Latn"));
+    QVERIFY(desktopFile.removeEntry("Name"));
+    QCOMPARE(desktopFile.localizedValue("Name", "empty"), QString());
+}
+
+QTEST_GUILESS_MAIN(QXdgDesktopEntryTest)
 
 #include "tst_qxdgdesktopentrytest.moc"
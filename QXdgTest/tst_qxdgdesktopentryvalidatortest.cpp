@@ -0,0 +1,112 @@
+/*
+ * Copyright (C) 2019 Deepin Technology Co., Ltd.
+ *               2019 Gary Wang
+ *
+ * Author:     Gary Wang <wzc782970009@gmail.com>
+ *
+ * Maintainer: Gary Wang <wzc782970009@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <QString>
+#include <QtTest>
+
+#include "qxdg/qxdgdesktopentryvalidator.h"
+#include "qxdgtestutils.h"
+
+#include <tuple>
+
+class QXdgDesktopEntryValidatorTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void testCase_Validator();
+};
+
+void QXdgDesktopEntryValidatorTest::testCase_Validator()
+{
+    const QByteArray data("[Desktop Entry]\n"
+                          "Type=Application\n"
+                          "Name=Foo\n"
+                          "Exec=foo \"unterminated\n"
+                          "Terminal=yes\n"
+                          "NoDisplay=1\n"
+                          "Name=Bar\n"
+                          "Bogus\n"
+                          "Actions=New;Gone;\n"
+                          "Comment=\xff\n"
+                          "[Desktop Action New]\n"
+                          "Name=New\n"
+                          "[Desktop Action Orphan]\n"
+                          "Name=Orphan\n"
+                          "[X-Extension\n");
+
+    typedef QXdgDesktopEntryDiagnostic D;
+    const QVector<D> diagnostics = QXdgDesktopEntryValidator::validateData(data, "test.desktop");
+    const QVector<std::tuple<int, int, D::Severity>> expected {
+        std::make_tuple(4, 6, D::Error),     // unterminated quote
+        std::make_tuple(5, 10, D::Error),    // not a boolean
+        std::make_tuple(6, 11, D::Warning),  // deprecated boolean
+        std::make_tuple(7, 1, D::Error),     // duplicate key
+        std::make_tuple(8, 1, D::Error),     // invalid line
+        std::make_tuple(9, 13, D::Error),    // action without group
+        std::make_tuple(10, 9, D::Error),    // invalid UTF-8
+        std::make_tuple(13, 1, D::Warning),  // action group not listed
+        std::make_tuple(15, 13, D::Error)    // missing ']'
+    };
+    QCOMPARE(diagnostics.count(), expected.count());
+    for (int i = 0; i < expected.count(); i++) {
+        QCOMPARE(diagnostics[i].line, std::get<0>(expected[i]));
+        QCOMPARE(diagnostics[i].column, std::get<1>(expected[i]));
+        QCOMPARE(diagnostics[i].severity, std::get<2>(expected[i]));
+    }
+    QVERIFY(diagnostics[3].message.contains("line 3"));
+    QVERIFY(diagnostics[0].toString().startsWith("test.desktop:4:6: error: "));
+
+    // a file without any group is reported as a whole.
+    const QVector<D> empty = QXdgDesktopEntryValidator::validateData("# nothing\n", "empty.desktop");
+    QCOMPARE(empty.count(), 1);
+    QCOMPARE(empty.first().line, 0);
+    QVERIFY(empty.first().toString().startsWith("empty.desktop: error: "));
+
+    QCOMPARE(QXdgDesktopEntryValidator::validateData("[Desktop Entry]\nType=Application\nName=Foo\nExec=foo %f\n").count(), 0);
+
+    // directories get searched, and the diagnostics come in the order of the files.
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QStringList fileNames { "a.desktop", "sub/b.desktop", "c.desktop", "ignored.txt" };
+    for (const QString &fileName : fileNames) {
+        const QByteArray content = fileName == "c.desktop" ? "[Desktop Entry]\nType=Application\nName=C\nExec=c\n"
+                                                           : "[Desktop Entry]\n";
+        QVERIFY(writeTestFile(dir.filePath(fileName), content));
+    }
+    const QStringList filePaths = QXdgDesktopEntryValidator::findDesktopFiles({ dir.path() });
+    QCOMPARE(filePaths, QStringList({ dir.filePath("a.desktop"), dir.filePath("c.desktop"), dir.filePath("sub/b.desktop") }));
+
+    QXdgDesktopEntryValidator validator;
+    validator.setMaxThreadCount(2);
+    const QVector<D> fileDiagnostics = validator.validateFiles(filePaths + QStringList(dir.filePath("missing.desktop")));
+    // Type and Name missing in a and b, plus the unreadable file.
+    QCOMPARE(fileDiagnostics.count(), 5);
+    QCOMPARE(fileDiagnostics[0].filePath, dir.filePath("a.desktop"));
+    QCOMPARE(fileDiagnostics[2].filePath, dir.filePath("sub/b.desktop"));
+    QCOMPARE(fileDiagnostics[4].filePath, dir.filePath("missing.desktop"));
+    QCOMPARE(fileDiagnostics[4].line, 0);
+}
+
+QTEST_GUILESS_MAIN(QXdgDesktopEntryValidatorTest)
+
+#include "tst_qxdgdesktopentryvalidatortest.moc"
@@ -0,0 +1,115 @@
+/*
+ * Copyright (C) 2019 Deepin Technology Co., Ltd.
+ *               2019 Gary Wang
+ *
+ * Author:     Gary Wang <wzc782970009@gmail.com>
+ *
+ * Maintainer: Gary Wang <wzc782970009@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <QString>
+#include <QtTest>
+
+#include "qxdg/qxdgdesktopentrycollection.h"
+#include "qxdg/qxdgdesktopentrywatcher.h"
+#include "qxdgtestutils.h"
+
+class QXdgDesktopEntryWatcherTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void testCase_Watcher();
+};
+
+void QXdgDesktopEntryWatcherTest::testCase_Watcher()
+{
+#ifndef Q_OS_LINUX
+    QSKIP("QXdgDesktopEntryWatcher is only supported on Linux");
+#else
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString homeDir = dir.path() + "/home";
+    const QString systemDir = dir.path() + "/system";
+    QVERIFY(QDir().mkpath(homeDir));
+    QVERIFY(QDir().mkpath(systemDir));
+
+    QVERIFY(writeTestFile(systemDir + "/foo.desktop", applicationEntryData("Foo")));
+
+    QXdgDesktopEntryCollection collection;
+    QVERIFY(collection.load({ homeDir, systemDir }));
+    QCOMPARE(collection.count(), 1);
+
+    QXdgDesktopEntryWatcher watcher(&collection);
+    QVERIFY(watcher.isActive());
+    QSignalSpy addedSpy(&watcher, &QXdgDesktopEntryWatcher::entryAdded);
+    QSignalSpy changedSpy(&watcher, &QXdgDesktopEntryWatcher::entryChanged);
+    QSignalSpy removedSpy(&watcher, &QXdgDesktopEntryWatcher::entryRemoved);
+
+    QVERIFY(writeTestFile(systemDir + "/bar.desktop", applicationEntryData("Bar")));
+    QTRY_VERIFY(collection.contains("bar.desktop"));
+    QCOMPARE(addedSpy.count(), 1);
+    QCOMPARE(addedSpy.first().first().toString(), QStringLiteral("bar.desktop"));
+
+    // a file in a new sub directory.
+    QVERIFY(QDir().mkpath(systemDir + "/kde"));
+    QVERIFY(writeTestFile(systemDir + "/kde/baz.desktop", applicationEntryData("Baz")));
+    QTRY_VERIFY(collection.contains("kde-baz.desktop"));
+
+    // the home directory takes precedence.
+    QVERIFY(writeTestFile(homeDir + "/foo.desktop", applicationEntryData("Foo Home")));
+    QTRY_COMPARE(collection.filePath("foo.desktop"), homeDir + "/foo.desktop");
+    QCOMPARE(collection.entry("foo.desktop").localizedValue("Name"), QStringLiteral("Foo Home"));
+    QVERIFY(changedSpy.count() >= 1);
+
+    // so it's the system one which shows up again when it goes away.
+    QVERIFY(QFile::remove(homeDir + "/foo.desktop"));
+    QTRY_COMPARE(collection.filePath("foo.desktop"), systemDir + "/foo.desktop");
+    QCOMPARE(removedSpy.count(), 0);
+
+    QVERIFY(QFile::remove(systemDir + "/foo.desktop"));
+    QTRY_VERIFY(!collection.contains("foo.desktop"));
+    QCOMPARE(removedSpy.count(), 1);
+    QCOMPARE(removedSpy.first().first().toString(), QStringLiteral("foo.desktop"));
+
+    // Overflow the event queue, alternating the names so the events aren't merged. What happens after that
+    // is only found by walking the directories again.
+    QFile maxQueuedEvents("/proc/sys/fs/inotify/max_queued_events");
+    if (!maxQueuedEvents.open(QIODevice::ReadOnly)) {
+        QSKIP("Can't read the size of the inotify event queue");
+    }
+    const int maxEvents = maxQueuedEvents.readAll().trimmed().toInt();
+    if (maxEvents <= 0 || maxEvents > 1000000) {
+        QSKIP("The inotify event queue is too large to overflow");
+    }
+    for (int i = 0; i <= maxEvents; i++) {
+        QFile flood(systemDir + (i % 2 ? "/flood-a" : "/flood-b"));
+        QVERIFY(flood.open(QIODevice::WriteOnly));
+    }
+    QVERIFY(writeTestFile(systemDir + "/late.desktop", applicationEntryData("Late")));
+    QVERIFY(QDir().mkpath(systemDir + "/new"));
+    QVERIFY(writeTestFile(systemDir + "/new/late.desktop", applicationEntryData("New Late")));
+    QTRY_VERIFY(collection.contains("late.desktop") && collection.contains("new-late.desktop"));
+
+    // and the new sub directory is watched.
+    QVERIFY(writeTestFile(systemDir + "/new/later.desktop", applicationEntryData("New Later")));
+    QTRY_VERIFY(collection.contains("new-later.desktop"));
+#endif
+}
+
+QTEST_GUILESS_MAIN(QXdgDesktopEntryWatcherTest)
+
+#include "tst_qxdgdesktopentrywatchertest.moc"
@@ -0,0 +1,119 @@
+/*
+ * Copyright (C) 2019 Deepin Technology Co., Ltd.
+ *               2019 Gary Wang
+ *
+ * Author:     Gary Wang <wzc782970009@gmail.com>
+ *
+ * Maintainer: Gary Wang <wzc782970009@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <QString>
+#include <QtTest>
+
+#include "qxdg/qxdgicontheme.h"
+#include "qxdgtestutils.h"
+
+class QXdgIconThemeTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void testCase_IconTheme();
+};
+
+void QXdgIconThemeTest::testCase_IconTheme()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString userIcons = dir.path() + "/user";
+    const QString systemIcons = dir.path() + "/system";
+
+    // Test inherits Parent, which inherits Test back.
+    QVERIFY(writeTestFile(systemIcons + "/Test/index.theme",
+                          "[Icon Theme]\nName=Test Theme\nName[de]=Testthema\nInherits=Parent\n"
+                          "Directories=16x16/apps,48x48/apps,scalable/apps,nosize\nScaledDirectories=16x16@2/apps\n"
+                          "[16x16/apps]\nSize=16\nType=Fixed\n"
+                          "[16x16@2/apps]\nSize=16\nScale=2\nType=Fixed\n"
+                          "[48x48/apps]\nSize=48\n"
+                          "[scalable/apps]\nSize=64\nMinSize=64\nMaxSize=256\nType=Scalable\n"));
+    QVERIFY(writeTestFile(systemIcons + "/Parent/index.theme",
+                          "[Icon Theme]\nName=Parent\nInherits=Test\nDirectories=32x32/apps\n"
+                          "[32x32/apps]\nSize=32\nType=Fixed\n"));
+    QVERIFY(writeTestFile(systemIcons + "/hicolor/index.theme",
+                          "[Icon Theme]\nName=Hicolor\nDirectories=48x48/apps\n[48x48/apps]\nSize=48\nType=Fixed\n"));
+    QVERIFY(writeTestFile(systemIcons + "/Test/16x16/apps/foo.png", "png"));
+    QVERIFY(writeTestFile(systemIcons + "/Test/16x16@2/apps/foo.png", "png"));
+    QVERIFY(writeTestFile(systemIcons + "/Test/48x48/apps/foo.svg", "svg"));
+    QVERIFY(writeTestFile(systemIcons + "/Test/48x48/apps/foo.xpm", "xpm"));
+    QVERIFY(writeTestFile(systemIcons + "/Test/scalable/apps/foo.svg", "svg"));
+    QVERIFY(writeTestFile(systemIcons + "/Test/nosize/bar.png", "png"));
+    // the user copy of the theme has no index.theme, it extends the system one.
+    QVERIFY(writeTestFile(userIcons + "/Test/48x48/apps/user.png", "png"));
+    QVERIFY(writeTestFile(systemIcons + "/Parent/32x32/apps/parent.png", "png"));
+    QVERIFY(writeTestFile(systemIcons + "/hicolor/48x48/apps/generic.png", "png"));
+    QVERIFY(writeTestFile(systemIcons + "/legacy.xpm", "xpm"));
+
+    QXdgIconTheme theme("Test");
+    theme.setSearchPaths({ userIcons, systemIcons });
+    QVERIFY(theme.isValid());
+    QCOMPARE(theme.themeName(), QStringLiteral("Test"));
+    QCOMPARE(theme.inheritanceChain(), QStringList({ "Test", "Parent", "hicolor" }));
+
+    // exact matches, png is preferred over svg and xpm.
+    QCOMPARE(theme.findIcon("foo", 16), systemIcons + "/Test/16x16/apps/foo.png");
+    QCOMPARE(theme.findIcon("foo", 16, 2), systemIcons + "/Test/16x16@2/apps/foo.png");
+    QCOMPARE(theme.findIcon("foo", 50), systemIcons + "/Test/48x48/apps/foo.svg");
+    QCOMPARE(theme.findIcon("foo", 128), systemIcons + "/Test/scalable/apps/foo.svg");
+    // closest sizes.
+    QCOMPARE(theme.findIcon("foo", 24), systemIcons + "/Test/16x16/apps/foo.png");
+    QCOMPARE(theme.findIcon("foo", 40), systemIcons + "/Test/48x48/apps/foo.svg");
+    QCOMPARE(theme.findIcon("foo", 512), systemIcons + "/Test/scalable/apps/foo.svg");
+    // a directory without Size is never searched.
+    QVERIFY(theme.findIcon("bar", 16).isEmpty());
+
+    QCOMPARE(theme.findIcon("user", 48), userIcons + "/Test/48x48/apps/user.png");
+    QCOMPARE(theme.findIcon("parent", 16), systemIcons + "/Parent/32x32/apps/parent.png");
+    QCOMPARE(theme.findIcon("generic", 16), systemIcons + "/hicolor/48x48/apps/generic.png");
+    QCOMPARE(theme.findIcon("legacy", 16), systemIcons + "/legacy.xpm");
+    QCOMPARE(theme.findIcon(systemIcons + "/legacy.xpm", 16), systemIcons + "/legacy.xpm");
+    QVERIFY(theme.findIcon(systemIcons + "/missing.png", 16).isEmpty());
+    QVERIFY(theme.findIcon("missing", 16).isEmpty());
+    QVERIFY(theme.findIcon("", 16).isEmpty());
+
+    QCOMPARE(theme.findIcons({ "foo", "missing", "parent" }, 16),
+             QStringList({ systemIcons + "/Test/16x16/apps/foo.png", QString(), systemIcons + "/Parent/32x32/apps/parent.png" }));
+    QCOMPARE(theme.findIcons({ { "foo", 16, 2 }, { "foo", 48, 1 }, { "user", 16, 1 } }),
+             QStringList({ systemIcons + "/Test/16x16@2/apps/foo.png", systemIcons + "/Test/48x48/apps/foo.svg",
+                           userIcons + "/Test/48x48/apps/user.png" }));
+
+    // changes of the directories are noticed by the next lookup.
+    QVERIFY(writeTestFile(userIcons + "/Test/16x16/apps/foo.png", "png"));
+    QCOMPARE(theme.findIcon("foo", 16), userIcons + "/Test/16x16/apps/foo.png");
+    QVERIFY(QFile::remove(userIcons + "/Test/16x16/apps/foo.png"));
+    QCOMPARE(theme.findIcon("foo", 16), systemIcons + "/Test/16x16/apps/foo.png");
+
+    // a theme which doesn't exist falls back to hicolor.
+    QXdgIconTheme missingTheme("Missing");
+    missingTheme.setSearchPaths({ userIcons, systemIcons });
+    QVERIFY(!missingTheme.isValid());
+    QCOMPARE(missingTheme.inheritanceChain(), QStringList({ "Missing", "hicolor" }));
+    QCOMPARE(missingTheme.findIcon("generic", 48), systemIcons + "/hicolor/48x48/apps/generic.png");
+    QVERIFY(missingTheme.findIcon("foo", 48).isEmpty());
+}
+
+QTEST_GUILESS_MAIN(QXdgIconThemeTest)
+
+#include "tst_qxdgiconthemetest.moc"
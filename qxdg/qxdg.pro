@@ -24,12 +24,44 @@ DEFINES += QT_DEPRECATED_WARNINGS
 
 SOURCES += \
         qxdgstandardpath.cpp \
-    qxdgdesktopentry.cpp
+    qxdgdesktopentry.cpp \
+    qxdgdesktopentrytokenizer.cpp \
+    qxdgkeyatomtable.cpp \
+    qxdglocalechain.cpp \
+    qxdgdesktopentrycollection.cpp \
+    qxdgdesktopentrycache.cpp \
+    qxdgdesktopentryindex.cpp \
+    qxdgdesktopentrywatcher.cpp \
+    qxdgdesktopentryreader.cpp \
+    qxdgdesktopentryescape.cpp \
+    qxdgdesktopentryexec.cpp \
+    qxdgdesktopentrytransaction.cpp \
+    qxdgdesktopentryvalidator.cpp \
+    qxdgstats.cpp \
+    qxdgicontheme.cpp
 
 HEADERS += \
         qxdgstandardpath.h \
         qxdg_global.h \ 
-    qxdgdesktopentry.h
+    qxdgdesktopentry.h \
+    qxdgdesktopentrytokenizer_p.h \
+    qxdgkeyatomtable_p.h \
+    qxdglocalechain_p.h \
+    qxdgdesktopentrycollection.h \
+    qxdgdesktopentry_p.h \
+    qxdgdesktopentrycache_p.h \
+    qxdgdesktopentryindex.h \
+    qxdgdesktopentrywatcher.h \
+    qxdgdesktopentrycollection_p.h \
+    qxdgdesktopentryreader.h \
+    qxdgdesktopentryescape_p.h \
+    qxdgdesktopentryexec.h \
+    qxdgdesktopentrytransaction.h \
+    qxdgdesktopentryvalidator.h \
+    qxdgstats.h \
+    qxdgstats_p.h \
+    qxdgicontheme.h \
+    qxdgicontheme_p.h
 
 unix {
     target.path = /usr/lib
@@ -21,400 +21,601 @@
  */
 
 #include "qxdgdesktopentry.h"
+#include "qxdgdesktopentry_p.h"
+#include "qxdgdesktopentryescape_p.h"
 
 #include <QDir>
 #include <QFileInfo>
-#include <QMutex>
-#include <QTemporaryFile>
 #include <QDebug>
+#include <QElapsedTimer>
 #include <QSaveFile>
 
-enum { Space = 0x1, Special = 0x2 };
-
-static const char charTraits[256] = {
-    // Space: '\t', '\n', '\r', ' '
-    // Special: '\n', '\r', ';', '=', '\\', '#'
-    // Please note that '"' is NOT a special character
-
-    0, 0, 0, 0, 0, 0, 0, 0, 0, Space, Space | Special, 0, 0, Space | Special, 0, 0,
-    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-    Space, 0, 0, Special, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, Special, 0, Special, 0, 0,
-    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, Special, 0, 0, 0,
-    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-
-    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-};
-
-bool readLineFromData(const QByteArray &data, int &dataPos, int &lineStart, int &lineLen, int &equalsPos)
+static QString &doEscape(QString &str, QXdgEscapeMode mode)
 {
-    int dataLen = data.length();
-
-    equalsPos = -1;
-
-    lineStart = dataPos;
-    while (lineStart < dataLen && (charTraits[uint(uchar(data.at(lineStart)))] & Space))
-        ++lineStart;
-
-    int i = lineStart;
-    while (i < dataLen) {
-        while (!(charTraits[uint(uchar(data.at(i)))] & Special)) {
-            if (++i == dataLen)
-                goto break_out_of_outer_loop;
-        }
+    const int length = qxdgEscapedLength(str.constData(), str.size(), mode);
+    if (length == str.size()) {
+        return str;
+    }
 
-        char ch = data.at(i++);
-        if (ch == '=') {
-            if (equalsPos == -1)
-                equalsPos = i - 1;
-        } else if (ch == '\n' || ch == '\r') {
-            if (i == lineStart + 1) {
-                ++lineStart;
-            } else {
-                --i;
-                goto break_out_of_outer_loop;
-            }
-        } else if (ch == '\\') {
-            if (i < dataLen) {
-                char ch = data.at(i++);
-                if (i < dataLen) {
-                    char ch2 = data.at(i);
-                    // \n, \r, \r\n, and \n\r are legitimate line terminators in INI files
-                    if ((ch == '\n' && ch2 == '\r') || (ch == '\r' && ch2 == '\n'))
-                        ++i;
-                }
-            }
-        } else if (ch == ';') {
-            // The multiple values should be separated by a semicolon and the value of the key
-            // may be optionally terminated by a semicolon. Trailing empty strings must always
-            // be terminated with a semicolon. Semicolons in these values need to be escaped
-            // using \; .
-            // Don't need to do anything here.
-        } else {
-            Q_ASSERT(ch == '#');
+    QString escaped(length, Qt::Uninitialized);
+    qxdgEscape(str.constData(), str.size(), escaped.data(), mode);
+    str.swap(escaped);
+    return str;
+}
 
-            if (i == lineStart + 1) {
-                char ch;
-                while (i < dataLen && (((ch = data.at(i)) != '\n') && ch != '\r'))
-                    ++i;
-                lineStart = i;
-            }
-        }
+static QString &doEscape(QStringView str, QString &out, QXdgEscapeMode mode)
+{
+    // growing the buffer would free the chars we are reading from.
+    if (str.data() >= out.constData() && str.data() < out.constData() + out.size()) {
+        out = str.toString();
+        return doEscape(out, mode);
     }
 
-break_out_of_outer_loop:
-    dataPos = i;
-    lineLen = i - lineStart;
-    return lineLen > 0;
+    const int size = int(str.size());
+    out.resize(qxdgEscapedLength(str.data(), size, mode));
+    qxdgEscape(str.data(), size, out.data(), mode);
+    return out;
 }
 
-QString &doEscape(QString& str, const QHash<QChar,QChar> &repl)
+static QString &doUnescape(QString &str, QXdgUnescapeMode mode)
 {
-    // First we replace slash.
-    str.replace(QLatin1Char('\\'), QLatin1String("\\\\"));
-
-    QHashIterator<QChar,QChar> i(repl);
-    while (i.hasNext()) {
-        i.next();
-        if (i.key() != QLatin1Char('\\'))
-            str.replace(i.key(), QString::fromLatin1("\\\\%1").arg(i.value()));
+    const int pos = qxdgFindEscape(str.constData(), str.size());
+    if (pos == -1) {
+        return str;
     }
 
+    // unescaping never makes the string longer, so it can be done in place.
+    QChar *data = str.data();
+    str.resize(pos + qxdgUnescape(data + pos, str.size() - pos, data + pos, mode));
     return str;
 }
 
-QString &doUnescape(QString& str, const QHash<QChar,QChar> &repl)
+static QString &doUnescape(QStringView str, QString &out, QXdgUnescapeMode mode)
 {
-    int n = 0;
-    while (1) {
-        n=str.indexOf(QLatin1String("\\"), n);
-        if (n < 0 || n > str.length() - 2)
-            break;
+    // shrinking the buffer keeps it, so the chars we are reading from stay valid.
+    const int size = int(str.size());
+    out.resize(size);
+    out.resize(qxdgUnescape(str.data(), size, out.data(), mode));
+    return out;
+}
 
-        if (repl.contains(str.at(n+1))) {
-            str.replace(n, 2, repl.value(str.at(n+1)));
+// Decodes UTF-8 without going through a QString, so the value of a visitor can stay on the stack. UTF-16
+// never takes more code units than UTF-8 takes bytes. Invalid sequences become U+FFFD, one per byte.
+template <int Prealloc>
+static void decodeUtf8(const char *utf8, int length, QVarLengthArray<QChar, Prealloc> &out)
+{
+    out.resize(length);
+    QChar *dst = out.data();
+    const uchar *src = reinterpret_cast<const uchar *>(utf8);
+    const uchar *end = src + length;
+
+    while (src < end) {
+        const uchar lead = *src;
+        if (lead < 0x80) {
+            *dst++ = QChar(ushort(lead));
+            ++src;
+            continue;
         }
 
-        n++;
+        const int extra = lead >= 0xf0 ? 3 : lead >= 0xe0 ? 2 : lead >= 0xc0 ? 1 : -1;
+        uint ucs = extra == 3 ? lead & 0x07 : extra == 2 ? lead & 0x0f : lead & 0x1f;
+        bool valid = extra > 0 && lead < 0xf5 && end - src > extra;
+        for (int i = 1; valid && i <= extra; i++) {
+            valid = (src[i] & 0xc0) == 0x80;
+            ucs = (ucs << 6) | (src[i] & 0x3f);
+        }
+        // overlong forms, surrogates and code points out of range.
+        static const uint minimum[4] = { 0, 0x80, 0x800, 0x10000 };
+        valid = valid && ucs >= minimum[extra] && ucs <= 0x10ffff && (ucs < 0xd800 || ucs > 0xdfff);
+
+        if (!valid) {
+            *dst++ = QChar(QChar::ReplacementCharacter);
+            ++src;
+        } else if (ucs > 0xffff) {
+            *dst++ = QChar(QChar::highSurrogate(ucs));
+            *dst++ = QChar(QChar::lowSurrogate(ucs));
+            src += extra + 1;
+        } else {
+            *dst++ = QChar(ushort(ucs));
+            src += extra + 1;
+        }
     }
 
-    return str;
+    out.resize(int(dst - out.data()));
+}
+
+// Doesn't load anything, for entries which get their content from somewhere else than the file,
+// see QXdgDesktopEntryCache.
+QXdgDesktopEntryPrivate::QXdgDesktopEntryPrivate(const QString &filePath, QXdgDesktopEntry::LoadOptions options)
+    : filePath(filePath), loadOptions(options)
+{
+
 }
 
-/*! \internal */
-class QXdgDesktopEntrySection
+// Used when a shared entry gets detached. The mapping (if any) stays shared, it's read-only anyway.
+QXdgDesktopEntryPrivate::QXdgDesktopEntryPrivate(const QXdgDesktopEntryPrivate &other)
+    : QSharedData(other)
+    , filePath(other.filePath)
+    , loadOptions(other.loadOptions)
+    , loadGroups(other.loadGroups)
+    , partial(other.partial)
+    , data(other.data)
+    , mapping(other.mapping)
+    , frozen(other.frozen)
+    , status(other.status.load())
+    , modifications(other.modifications)
+    , savedModifications(other.savedModifications.loadAcquire())
 {
-public:
-    QString name;
-    QMap<QString, QString> valuesMap;
-    QByteArray unparsedDatas;
-    int sectionPos = 99;
+    // Readers of the other entry may be parsing its sections right now, so copy them (not only share
+    // the map) while they can't.
+    QMutexLocker locker(&other.mutex);
+    sections = other.sections;
+    sections.detach();
+    sectionIndex = other.sectionIndex;
+    execCache = other.execCache;
+}
 
-    inline operator QString() const {
-        return QLatin1String("QXdgDesktopEntrySection(") + name + QLatin1String(")");
+QXdgDesktopEntryPrivate::~QXdgDesktopEntryPrivate()
+{
+    const quint64 bytes = accountedBytes.load();
+    if (bytes) {
+        QXdgStatsPrivate::counters[QXdgStatsPrivate::LiveEntries].fetchAndSubRelaxed(1);
+        QXdgStatsPrivate::counters[QXdgStatsPrivate::LiveEntryBytes].fetchAndSubRelaxed(bytes);
     }
+}
 
-    QByteArray sectionData() const {
-        if (unparsedDatas.isEmpty()) {
-            // construct data and return
-            QByteArray data;
+// By key atom, see qxdgWellKnownKeyType().
+static const QXdgDesktopEntry::ValueType wellKnownKeyTypes[QXdgKeyAtomTable::WellKnownKeyCount] = {
+    QXdgDesktopEntry::NotExisted,   // InvalidAtom
+    QXdgDesktopEntry::String,       // Type
+    QXdgDesktopEntry::String,       // Version
+    QXdgDesktopEntry::String,       // Name
+    QXdgDesktopEntry::String,       // GenericName
+    QXdgDesktopEntry::Boolean,      // NoDisplay
+    QXdgDesktopEntry::String,       // Comment
+    QXdgDesktopEntry::String,       // Icon
+    QXdgDesktopEntry::Boolean,      // Hidden
+    QXdgDesktopEntry::Strings,      // OnlyShowIn
+    QXdgDesktopEntry::Strings,      // NotShowIn
+    QXdgDesktopEntry::Boolean,      // DBusActivatable
+    QXdgDesktopEntry::String,       // TryExec
+    QXdgDesktopEntry::String,       // Exec
+    QXdgDesktopEntry::String,       // Path
+    QXdgDesktopEntry::Boolean,      // Terminal
+    QXdgDesktopEntry::Strings,      // Actions
+    QXdgDesktopEntry::Strings,      // MimeType
+    QXdgDesktopEntry::Strings,      // Categories
+    QXdgDesktopEntry::Strings,      // Implements
+    QXdgDesktopEntry::Strings,      // Keywords
+    QXdgDesktopEntry::Boolean,      // StartupNotify
+    QXdgDesktopEntry::String,       // StartupWMClass
+    QXdgDesktopEntry::String,       // URL
+    QXdgDesktopEntry::Boolean,      // PrefersNonDefaultGPU
+    QXdgDesktopEntry::Boolean       // SingleMainWindow
+};
 
-            data.append(QString("[%1]\n").arg(name));
+/*!
+ * \internal
+ * \brief Returns the type the spec gives to \a key, or NotExisted if the spec doesn't define the key.
+ */
+QXdgDesktopEntry::ValueType qxdgWellKnownKeyType(QXdgKeyAtom key)
+{
+    return key < QXdgKeyAtomTable::WellKnownKeyCount ? wellKnownKeyTypes[key] : QXdgDesktopEntry::NotExisted;
+}
 
-            QMap<QString, QString>::const_iterator i;
-            for (i = valuesMap.begin(); i != valuesMap.end(); i++) {
-                data.append(QString("%1=%2\n").arg(i.key(), i.value()));
-            }
+template <typename Char>
+static bool endsWithSeparator(const Char *chars, int length)
+{
+    if (length == 0 || chars[length - 1] != ';') {
+        return false;
+    }
+    // the separator is escaped if an odd number of backslashes come before it.
+    int backslashes = 0;
+    while (backslashes < length - 1 && chars[length - 2 - backslashes] == '\\') {
+        backslashes++;
+    }
+    return backslashes % 2 == 0;
+}
 
-            return data;
-        } else {
-            return unparsedDatas;
-        }
+// Keys which are not in the spec have no fixed type, so it's guessed from the content the first time.
+static QXdgDesktopEntry::ValueType guessValueType(const QXdgDesktopEntryValue &value, const QByteArray &data)
+{
+    const int guessed = value.conversions.loadAcquire() >> QXdgDesktopEntryValue::GuessedTypeShift;
+    if (guessed) {
+        return QXdgDesktopEntry::ValueType(guessed - 1);
     }
 
-    bool ensureSectionDataParsed() {
-        if (unparsedDatas.isEmpty()) return true;
+    QXdgDesktopEntry::ValueType type = QXdgDesktopEntry::String;
+    bool ok;
+    value.toBool(data, &ok);
+    if (ok) {
+        type = QXdgDesktopEntry::Boolean;
+    } else {
+        value.toNumeric(data, &ok);
+        if (ok) {
+            type = QXdgDesktopEntry::Numeric;
+        } else if (value.isModified() ? endsWithSeparator(reinterpret_cast<const ushort *>(value.modifiedValue.constData()),
+                                                          value.modifiedValue.size())
+                                      : endsWithSeparator(data.constData() + value.start, value.length)) {
+            type = QXdgDesktopEntry::Strings;
+        }
+    }
 
-        valuesMap.clear();
+    value.conversions.fetchAndOrRelease((type + 1) << QXdgDesktopEntryValue::GuessedTypeShift);
+    return type;
+}
 
-        // for readLineFromFileData()
-        int dataPos = 0;
-        int lineStart;
-        int lineLen;
-        int equalsPos;
+// Reads at most \a maxSize bytes. Sequential devices are waited for if they have nothing to read yet,
+// so an empty result means the device has reached its end (or failed).
+static QByteArray readChunk(QIODevice &device, qint64 maxSize)
+{
+    QByteArray chunk = device.read(maxSize);
+    while (chunk.isEmpty() && device.isSequential() && device.isReadable() && device.waitForReadyRead(-1)) {
+        chunk = device.read(maxSize);
+    }
+    return chunk;
+}
 
-        while(readLineFromData(unparsedDatas, dataPos, lineStart, lineLen, equalsPos)) {
-            if (unparsedDatas.at(lineStart) == '[') continue; // section name already parsed
+static QByteArray readAll(QIODevice &device)
+{
+    // The size of the others is known, and read in one go.
+    if (!device.isSequential()) {
+        return device.readAll();
+    }
 
-            if (equalsPos != -1) {
-                QString key = unparsedDatas.mid(lineStart, equalsPos - lineStart).trimmed();
-                QString rawValue = unparsedDatas.mid(equalsPos + 1, lineStart + lineLen - equalsPos - 1).trimmed();
+    QByteArray data;
+    for (QByteArray chunk = readChunk(device, 16384); !chunk.isEmpty(); chunk = readChunk(device, 16384)) {
+        data.append(chunk);
+    }
+    return data;
+}
 
-                valuesMap[key] = rawValue;
-            }
+// Reads \a device until the header of its second group shows up, in growing chunks, so the rest of a large
+// file is never read. Returns the content before that header.
+static QByteArray readFirstGroup(QIODevice &device, bool *truncated)
+{
+    QByteArray data;
+    qint64 chunkSize = 4096;
+    *truncated = false;
+
+    for (;;) {
+        const QByteArray chunk = readChunk(device, chunkSize);
+        if (chunk.isEmpty()) break;
+        data.append(chunk);
+        chunkSize *= 2;
+
+        // Lines before the last one are complete, so a header found in them is a real one.
+        const QVector<QXdgDesktopEntryGroupHeader> headers = readGroupHeadersFromData(data.constData(), data.length(), 2);
+        if (headers.count() == 2) {
+            data.truncate(headers[1].lineStart);
+            *truncated = true;
+            break;
         }
+    }
 
-        unparsedDatas.clear();
+    return data;
+}
 
+bool QXdgDesktopEntryPrivate::fuzzyLoad()
+{
+    QFileInfo fileInfo(filePath);
+
+    if (!fileInfo.exists()) {
         return true;
     }
 
-    bool contains(const QString &key) const {
-        const_cast<QXdgDesktopEntrySection*>(this)->ensureSectionDataParsed();
-        return valuesMap.contains(key);
+    if (loadOptions & QXdgDesktopEntry::MapFile) {
+        QSharedPointer<QXdgDesktopEntryMapping> fileMapping(new QXdgDesktopEntryMapping(filePath));
+        // Empty files can't be mapped, fallback to the regular way for them.
+        if (fileMapping->map()) {
+            mapping = fileMapping;
+            data = mapping->data;
+        }
     }
 
-    QStringList allKeys() const {
-        const_cast<QXdgDesktopEntrySection*>(this)->ensureSectionDataParsed();
-        return valuesMap.keys();
+    if (!mapping) {
+        QFile file(filePath);
+        if (!file.open(QFile::ReadOnly)) {
+            setStatus(QXdgDesktopEntry::AccessError);
+            return false;
+        }
+        QXdgStatsPrivate::add(QXdgStatsPrivate::FilesRead);
+        return loadDevice(file);
     }
 
-    QString get(const QString &key, QString &defaultValue) {
-        if (this->contains(key)) {
-            return valuesMap[key];
-        } else {
-            return defaultValue;
-        }
+    QXdgStatsPrivate::add(QXdgStatsPrivate::FilesRead);
+    QXdgStatsPrivate::add(QXdgStatsPrivate::BytesRead, quint64(data.size()));
+    return loadData();
+}
+
+bool QXdgDesktopEntryPrivate::loadDevice(QIODevice &device)
+{
+    if (!device.isReadable()) {
+        setStatus(QXdgDesktopEntry::AccessError);
+        return false;
     }
 
-    bool set(const QString &key, const QString &value) {
-        if (this->contains(key)) {
-            valuesMap.remove(key);
-        }
-        valuesMap[key] = value;
-        return true;
+    if (loadOptions & (QXdgDesktopEntry::FirstGroupOnly | QXdgDesktopEntry::PeekOnly)) {
+        bool truncated;
+        data = readFirstGroup(device, &truncated);
+        partial = truncated;
+    } else {
+        data = readAll(device);
     }
 
-    bool remove(const QString &key) {
-        if (this->contains(key)) {
-            valuesMap.remove(key);
-            return true;
+    QXdgStatsPrivate::add(QXdgStatsPrivate::BytesRead, quint64(data.size()));
+    return loadData();
+}
+
+// Index the sections of data, which is already set.
+bool QXdgDesktopEntryPrivate::loadData()
+{
+    if (!data.isEmpty()) {
+        bool ok = initSectionsFromData();
+
+        if (!ok) {
+            setStatus(QXdgDesktopEntry::FormatError);
+            return false;
         }
-        return false;
+        accountLoaded();
     }
-};
 
-typedef QMap<QString, QXdgDesktopEntrySection> SectionMap;
+    return true;
+}
 
-class QXdgDesktopEntryPrivate
+bool QXdgDesktopEntryPrivate::initSectionsFromData()
 {
-public:
-    QXdgDesktopEntryPrivate(const QString &filePath, QXdgDesktopEntry *qq);
+    sections.clear();
+    sectionIndex.clear();
 
-    bool isWritable() const;
-    bool fuzzyLoad();
-    bool initSectionsFromData(const QByteArray &data);
-    void setStatus(const QXdgDesktopEntry::Status &newStatus) const;
-    bool write(QIODevice &device) const;
+    bool formatOk = true;
 
-    int sectionPos(const QString &sectionName) const;
-    bool contains(const QString &sectionName, const QString &key) const;
-    QStringList keys(const QString &sectionName) const;
-    bool get(const QString &sectionName, const QString &key, QString *value);
-    bool set(const QString &sectionName, const QString &key, const QString &value);
-    bool remove(const QString &sectionName, const QString &key);
+    // The header of the second group is still needed to know where the first one ends.
+    const bool firstGroupOnly = loadOptions & (QXdgDesktopEntry::FirstGroupOnly | QXdgDesktopEntry::PeekOnly);
+    const QVector<QXdgDesktopEntryGroupHeader> headers = readGroupHeadersFromData(data.constData(), data.length(),
+                                                                                  firstGroupOnly ? 2 : -1);
+    const int sectionCount = firstGroupOnly ? qMin(headers.count(), 1) : headers.count();
+    if (sectionCount < headers.count()) {
+        partial = true;
+    }
 
-protected:
-    QString filePath;
-    QMutex fileMutex;
-    SectionMap sectionsMap;
-    mutable QXdgDesktopEntry::Status status;
+    for (int sectionIdx = 0; sectionIdx < sectionCount; sectionIdx++) {
+        const int lineStart = headers[sectionIdx].lineStart;
+        const int lineLen = headers[sectionIdx].lineLen;
+        // a section ends where the next one starts.
+        const int sectionEnd = sectionIdx + 1 < headers.count() ? headers[sectionIdx + 1].lineStart : data.length();
+
+        // process section name line
+        QByteArray sectionName;
+        const char *lineData = data.constData() + lineStart;
+        const char *closeBracket = static_cast<const char *>(memchr(lineData, ']', size_t(lineLen)));
+        if (!closeBracket) {
+            qWarning() << "Bad desktop file format while reading line:" << data.mid(lineStart, lineLen);
+            formatOk = false;
+            sectionName = data.mid(lineStart + 1, lineLen - 1).trimmed();
+        } else {
+            sectionName = data.mid(lineStart + 1, int(closeBracket - lineData) - 1).trimmed();
+        }
 
-private:
-    QXdgDesktopEntry *q_ptr = nullptr;
+        if (sectionName.isEmpty()) {
+            continue;
+        }
 
-    Q_DECLARE_PUBLIC(QXdgDesktopEntry)
-};
+        QXdgDesktopEntrySection section;
+        section.name = QString::fromUtf8(sectionName);
+        if (!loadGroups.isEmpty() && !loadGroups.contains(section.name)) {
+            partial = true;
+            continue;
+        }
+        section.dataStart = lineStart;
+        section.dataLength = sectionEnd - lineStart;
+        section.parsed.store(0);
+        section.sectionPos = sectionIdx;
+        if (loadOptions & QXdgDesktopEntry::PeekOnly) {
+            section.peekOnly = true;
+            partial = true;
+        }
+        if (!appendSection(section)) {
+            qWarning() << "Bad desktop file format, duplicate group:" << section.name;
+            formatOk = false;
+        }
+    }
 
-QXdgDesktopEntryPrivate::QXdgDesktopEntryPrivate(const QString &filePath, QXdgDesktopEntry *qq)
-    : filePath(filePath), q_ptr(qq)
-{
-    fuzzyLoad();
+    if (partial && !loadGroups.isEmpty() && !mapping) {
+        compactData();
+    }
+
+    QXdgStatsPrivate::add(QXdgStatsPrivate::SectionsDiscovered, quint64(sectionCount));
+
+    return formatOk;
 }
 
-bool QXdgDesktopEntryPrivate::isWritable() const
+// Drop the data of the groups which were not loaded, the others are moved together.
+void QXdgDesktopEntryPrivate::compactData()
 {
-    QFileInfo fileInfo(filePath);
+    int keptLength = 0;
+    for (const QXdgDesktopEntrySection &section : qAsConst(sections)) {
+        keptLength += section.dataLength;
+    }
 
-#ifndef QT_NO_TEMPORARYFILE
-    if (fileInfo.exists()) {
-#endif
-        QFile file(filePath);
-        return file.open(QFile::ReadWrite);
-#ifndef QT_NO_TEMPORARYFILE
-    } else {
-        // Create the directories to the file.
-        QDir dir(fileInfo.absolutePath());
-        if (!dir.exists()) {
-            if (!dir.mkpath(dir.absolutePath()))
-                return false;
-        }
+    QByteArray compacted;
+    compacted.reserve(keptLength);
+    for (QXdgDesktopEntrySection &section : sections) {
+        const int dataStart = compacted.length();
+        compacted.append(data.constData() + section.dataStart, section.dataLength);
+        section.dataStart = dataStart;
+    }
+    data = compacted;
+}
 
-        // we use a temporary file to avoid race conditions
-        QTemporaryFile file(filePath);
-        return file.open();
+// Parse every section and its Exec key, so readers never need to lock, and refuse any later modification.
+void QXdgDesktopEntryPrivate::freeze()
+{
+    QMutexLocker locker(&mutex);
+    for (QXdgDesktopEntrySection &section : sections) {
+        parseSection(section);
     }
-#endif
+    // every section is parsed now, parseExec() doesn't lock again.
+    for (QHash<QString, int>::const_iterator it = sectionIndex.constBegin(); it != sectionIndex.constEnd(); ++it) {
+        if (!execCache.contains(it.key())) {
+            execCache.insert(it.key(), parseExec(it.key()));
+        }
+    }
+    frozen = true;
 }
 
-bool QXdgDesktopEntryPrivate::fuzzyLoad()
+// Callers which may race with other readers must hold the mutex, see QXdgDesktopEntrySection::ensureSectionDataParsed().
+void QXdgDesktopEntryPrivate::parseSection(QXdgDesktopEntrySection &section) const
 {
-    QFile file(filePath);
-    QFileInfo fileInfo(filePath);
+    if (section.parsed.loadAcquire()) return;
 
-    if (fileInfo.exists() && !file.open(QFile::ReadOnly)) {
-        setStatus(QXdgDesktopEntry::AccessError);
-        return false;
+    section.ensureSectionDataParsed(data);
+    if (QXdgStatsPrivate::isEnabled()) {
+        QXdgStatsPrivate::add(QXdgStatsPrivate::SectionsParsed);
+        account(section.parsedMemoryUsage());
     }
+}
 
-    if (file.isReadable() && file.size() != 0) {
-        bool ok = false;
-        QByteArray data = file.readAll();
-
-        ok = initSectionsFromData(data);
+// Adds \a bytes to the memory held by the entry, see QXdgStats::liveEntryBytes. Nothing is added while stats
+// are off, and the destructor removes exactly what was added.
+void QXdgDesktopEntryPrivate::account(quint64 bytes) const
+{
+    if (!QXdgStatsPrivate::isEnabled() || bytes == 0) return;
 
-        if (!ok) {
-            setStatus(QXdgDesktopEntry::FormatError);
-            return false;
-        }
+    if (accountedBytes.fetchAndAddRelaxed(bytes) == 0) {
+        QXdgStatsPrivate::counters[QXdgStatsPrivate::LiveEntries].fetchAndAddRelaxed(1);
     }
-
-    return true;
+    QXdgStatsPrivate::counters[QXdgStatsPrivate::LiveEntryBytes].fetchAndAddRelaxed(bytes);
 }
 
-bool QXdgDesktopEntryPrivate::initSectionsFromData(const QByteArray &data)
+// The data and the unparsed sections, their values are accounted once they get parsed.
+void QXdgDesktopEntryPrivate::accountLoaded() const
 {
-    sectionsMap.clear();
+    if (!QXdgStatsPrivate::isEnabled()) return;
 
-    QString lastSectionName;
-    int lastSectionStart = 0;
-    bool formatOk = true;
-    int sectionIdx = 0;
-    // for readLineFromFileData()
-    int dataPos = 0;
-    int lineStart;
-    int lineLen;
-    int equalsPos;
-
-    auto commitSection = [=](const QString &name, int sectionStartPos, int sectionLength, int sectionIndex) {
-        QXdgDesktopEntrySection lastSection;
-        lastSection.name = name;
-        lastSection.unparsedDatas = data.mid(sectionStartPos, sectionLength);
-        lastSection.sectionPos = sectionIndex;
-        sectionsMap[name] = lastSection;
-    };
-
-    // TODO: here we only need to find the section start, so things like equalsPos are useless here.
-    //       maybe we can do some optimization here via adding extra argument to readLineFromData().
-    while(readLineFromData(data, dataPos, lineStart, lineLen, equalsPos)) {
-        // qDebug() << "CurrentLine:" << data.mid(lineStart, lineLen);
-        if (data.at(lineStart) == '[') {
-            // commit the last section we've ever read before we read the new one.
-            if (!lastSectionName.isEmpty()) {
-                commitSection(lastSectionName, lastSectionStart, lineStart - lastSectionStart, sectionIdx);
-                sectionIdx++;
-            }
-            // process section name line
-            QByteArray sectionName;
-            int idx = data.indexOf(']', lineStart);
-            if (idx == -1 || idx >= lineStart + lineLen) {
-                qWarning() << "Bad desktop file format while reading line:" << data.mid(lineStart, lineLen);
-                formatOk = false;
-                sectionName = data.mid(lineStart + 1, lineLen - 1).trimmed();
-            } else {
-                sectionName = data.mid(lineStart + 1, idx - lineStart - 1).trimmed();
-            }
-            lastSectionName = sectionName;
-            lastSectionStart = lineStart;
-        }
+    quint64 bytes = sizeof(*this) + quint64(data.size());
+    for (const QXdgDesktopEntrySection &section : sections) {
+        // a hash node, the section and its name.
+        bytes += 3 * sizeof(void *) + sizeof(QXdgDesktopEntrySection) + quint64(section.name.size()) * sizeof(QChar);
     }
+    account(bytes);
+}
 
-    Q_ASSERT(lineStart == data.length());
-    if (!lastSectionName.isEmpty()) {
-        commitSection(lastSectionName, lastSectionStart, lineStart - lastSectionStart, sectionIdx);
+bool QXdgDesktopEntryPrivate::checkWritable(const char *function) const
+{
+    if (frozen) {
+        qWarning("%s: The entry is frozen", function);
+        return false;
     }
-
-    return formatOk;
+    return true;
 }
 
 // Always keep the first meet error status. and allowed clear the status.
 void QXdgDesktopEntryPrivate::setStatus(const QXdgDesktopEntry::Status &newStatus) const
 {
-    if (newStatus == QXdgDesktopEntry::NoError || this->status == QXdgDesktopEntry::NoError) {
-        this->status = newStatus;
+    if (newStatus == QXdgDesktopEntry::NoError) {
+        this->status.store(newStatus);
+    } else {
+        this->status.testAndSetOrdered(QXdgDesktopEntry::NoError, newStatus);
     }
 }
 
 bool QXdgDesktopEntryPrivate::write(QIODevice &device) const
 {
-    Q_Q(const QXdgDesktopEntry);
+    const QByteArray content = serialize();
+    return device.write(content) == content.size();
+}
+
+// The content to save. Whatever is around the sections (like comments before the first group) is kept too,
+// new sections go to the end.
+QByteArray QXdgDesktopEntryPrivate::serialize() const
+{
+    // Readers may be parsing sections right now.
+    QMutexLocker locker(&mutex);
+
+    QByteArray content;
+    content.reserve(data.size() + 256);
+    int copied = 0;
+    for (const QXdgDesktopEntrySection &section : sections) {
+        if (section.dataLength > 0 && section.dataStart >= copied) {
+            content.append(data.constData() + copied, section.dataStart - copied);
+            copied = section.dataStart + section.dataLength;
+        } else if (section.dataLength == 0 && copied < data.size()) {
+            content.append(data.constData() + copied, data.size() - copied);
+            copied = data.size();
+        }
+        section.writeData(data, content);
+    }
+    content.append(data.constData() + copied, data.size() - copied);
 
-    QStringList sortedKeys = q->allGroups(true);
+    return content;
+}
+
+bool QXdgDesktopEntryPrivate::isModified() const
+{
+    return modifications != savedModifications.loadAcquire();
+}
 
-    for (const QString &key : sortedKeys) {
-        qint64 ret = device.write(sectionsMap[key].sectionData());
-        if (ret == -1) return false;
+// In file order if \a sorted, by name otherwise, like the keys of the map the sections used to be in.
+QStringList QXdgDesktopEntryPrivate::allGroups(bool sorted) const
+{
+    QStringList groups;
+    groups.reserve(sections.count());
+    for (const QXdgDesktopEntrySection &section : sections) {
+        if (!section.duplicate) {
+            groups << section.name;
+        }
+    }
+    if (!sorted) {
+        std::sort(groups.begin(), groups.end());
     }
+    return groups;
+}
 
+// Appends \a section after the others. Returns false if there is one with the same name already, the new one
+// is kept then, so saving writes it back, but lookups only ever find the first one.
+bool QXdgDesktopEntryPrivate::appendSection(const QXdgDesktopEntrySection &section)
+{
+    sections.append(section);
+    if (sectionIndex.contains(section.name)) {
+        sections.last().duplicate = true;
+        return false;
+    }
+    sectionIndex.insert(section.name, sections.count() - 1);
     return true;
 }
 
-int QXdgDesktopEntryPrivate::sectionPos(const QString &sectionName) const
+// The first section named \a sectionName, parsed or not.
+const QXdgDesktopEntrySection *QXdgDesktopEntryPrivate::findSection(const QString &sectionName) const
+{
+    const int index = sectionIndex.value(sectionName, -1);
+    return index == -1 ? nullptr : &sections.at(index);
+}
+
+// Returns the section with its values parsed, or nullptr if there is no section named \a sectionName.
+//
+// Safe to call from several threads at once: a section is parsed only once, under the mutex, and published
+// with release semantics. So once it's parsed, readers only need the acquire load to use it.
+QXdgDesktopEntrySection *QXdgDesktopEntryPrivate::parsedSection(const QString &sectionName) const
 {
-    if (sectionsMap.contains(sectionName)) {
-        return sectionsMap[sectionName].sectionPos;
+    // Not through the non-const vector, which could detach it.
+    QXdgDesktopEntrySection *section = const_cast<QXdgDesktopEntrySection *>(findSection(sectionName));
+    if (!section) {
+        return nullptr;
     }
 
-    return -1;
+    if (!section->parsed.loadAcquire()) {
+        QMutexLocker locker(&mutex);
+        // parses nothing if another reader was faster.
+        parseSection(*section);
+    }
+    return section;
+}
+
+int QXdgDesktopEntryPrivate::sectionPos(const QString &sectionName) const
+{
+    const QXdgDesktopEntrySection *section = findSection(sectionName);
+    return section ? section->sectionPos : -1;
 }
 
 bool QXdgDesktopEntryPrivate::contains(const QString &sectionName, const QString &key) const
@@ -423,8 +624,9 @@ bool QXdgDesktopEntryPrivate::contains(const QString &sectionName, const QString
         return false;
     }
 
-    if (sectionsMap.contains(sectionName)) {
-        return sectionsMap[sectionName].contains(key);
+    QXdgStatsPrivate::add(QXdgStatsPrivate::Lookups);
+    if (const QXdgDesktopEntrySection *section = parsedSection(sectionName)) {
+        return section->contains(key);
     }
 
     return false;
@@ -436,52 +638,126 @@ QStringList QXdgDesktopEntryPrivate::keys(const QString &sectionName) const
         return {};
     }
 
-    if (sectionsMap.contains(sectionName)) {
-        return sectionsMap[sectionName].allKeys();
+    if (const QXdgDesktopEntrySection *section = parsedSection(sectionName)) {
+        return section->allKeys();
     }
 
     return {};
 }
 
 // return true if we found the value, and set the value to *value
-bool QXdgDesktopEntryPrivate::get(const QString &sectionName, const QString &key, QString *value)
+bool QXdgDesktopEntryPrivate::get(const QString &sectionName, const QString &key, QString *value) const
 {
     if (!this->contains(sectionName, key)) {
         return false;
     }
 
-    if (sectionsMap.contains(sectionName)) {
-        QString &&result = sectionsMap[sectionName].get(key, *value);
-        *value = result;
-        return true;
+    *value = parsedSection(sectionName)->get(data, key, *value);
+    return true;
+}
+
+// The stored value of \a key, which keeps the typed conversions of it.
+const QXdgDesktopEntryValue *QXdgDesktopEntryPrivate::value(const QString &sectionName, const QString &key) const
+{
+    QXdgStatsPrivate::add(QXdgStatsPrivate::Lookups);
+    const QXdgDesktopEntrySection *section = parsedSection(sectionName);
+    const int pos = section ? section->indexOf(key) : -1;
+    return pos == -1 ? nullptr : &section->values[pos];
+}
+
+// Same as get(), but looks for the best variant of \a key for the locales of \a chain.
+bool QXdgDesktopEntryPrivate::getLocalized(const QString &sectionName, const QString &key,
+                                           const QXdgLocaleChain &chain, QString *value) const
+{
+    QXdgStatsPrivate::add(QXdgStatsPrivate::Lookups);
+    const QXdgKeyAtom baseKey = QXdgKeyAtomTable::find(key);
+    if (baseKey == QXdgKeyAtomTable::InvalidAtom) {
+        return false;
     }
 
-    return false;
+    const QXdgDesktopEntrySection *section = parsedSection(sectionName);
+    if (!section) {
+        return false;
+    }
+
+    const int pos = section->localizedIndexOf(baseKey, chain);
+    if (pos == -1) {
+        return false;
+    }
+
+    *value = section->values[pos].toString(data);
+    return true;
+}
+
+// The Exec key of \a sectionName with the keys its field codes need, see QXdgDesktopEntry::exec(). Locks only
+// to parse the section, if it wasn't yet.
+QXdgDesktopEntryExec QXdgDesktopEntryPrivate::parseExec(const QString &sectionName) const
+{
+    QString value;
+    get(sectionName, "Exec", &value);
+    QXdgDesktopEntryExec result(value);
+
+    value.clear();
+    get(sectionName, "Icon", &value);
+    result.setIconName(QXdgDesktopEntry::unescape(value));
+
+    value.clear();
+    getLocalized(sectionName, "Name", *QXdgLocaleChain::forLocaleKey("default"), &value);
+    result.setName(QXdgDesktopEntry::unescape(value));
+
+    result.setLocation(filePath);
+
+    value.clear();
+    get(sectionName, "Path", &value);
+    result.setWorkingDirectory(QXdgDesktopEntry::unescape(value));
+    return result;
 }
 
 bool QXdgDesktopEntryPrivate::set(const QString &sectionName, const QString &key, const QString &value)
 {
-    if (sectionsMap.contains(sectionName)) {
-        bool result = sectionsMap[sectionName].set(key, value);
-        return result;
-    } else {
-        // create new section.
-        QXdgDesktopEntrySection newSection;
-        newSection.name = sectionName;
-        newSection.set(key, value);
-        sectionsMap[sectionName] = newSection;
-        return true;
+    QMutexLocker locker(&mutex);
+    execCache.remove(sectionName);
+
+    modifications++;
+
+    const int index = sectionIndex.value(sectionName, -1);
+    if (index != -1) {
+        QXdgDesktopEntrySection &section = sections[index];
+        parseSection(section);
+        return section.set(key, value);
     }
 
-    return false;
+    // create new section, after every other one. Groups which were skipped while loading (like one
+    // without name) took a position too, so the count is not enough.
+    QXdgDesktopEntrySection newSection;
+    newSection.name = sectionName;
+    newSection.sectionPos = sections.isEmpty() ? 0 : sections.last().sectionPos + 1;
+    newSection.set(key, value);
+    appendSection(newSection);
+    return true;
 }
 
 bool QXdgDesktopEntryPrivate::remove(const QString &sectionName, const QString &key)
 {
-    if (this->contains(sectionName, key)) {
-        return sectionsMap[sectionName].remove(key);
+    if (sectionName.isNull() || key.isNull()) {
+        return false;
     }
-    return false;
+
+    QMutexLocker locker(&mutex);
+    execCache.remove(sectionName);
+
+    const int index = sectionIndex.value(sectionName, -1);
+    if (index == -1) {
+        return false;
+    }
+
+    QXdgDesktopEntrySection &section = sections[index];
+    parseSection(section);
+    if (!section.remove(key)) {
+        return false;
+    }
+    modifications++;
+    return true;
 }
 
 /*!
@@ -491,12 +767,132 @@ bool QXdgDesktopEntryPrivate::remove(const QString &sectionName, const QString &
  * QXdgDesktopEntry provide method for handling XDG desktop entry read and write. The interface
  * of this class is similar to QSettings.
  *
+ * QXdgDesktopEntry is implicitly shared: copying an entry is cheap, and the copies share their data until
+ * one of them gets modified. So entries can be stored by value in containers and returned from functions.
+ *
+ * \section thread-safety Thread-safety
+ *
+ * Any number of threads can call the const functions of the same entry at the same time. Groups are parsed
+ * lazily when they are first accessed, this happens once under an internal lock, and from then on reading
+ * them doesn't lock at all. Call freeze() (or load with FreezeOnLoad) to parse everything up front, so readers
+ * never wait on each other, and to make sure nobody modifies the entry anymore.
+ *
+ * The non-const functions need exclusive access to the entry they are called on, like the Qt containers do.
+ * Give each writer its own copy instead: copies of the same entry can be used from different threads, a copy
+ * detaching from data that other threads are reading is safe.
+ *
  * For more details about the spec itself, please refer to:
  * https://specifications.freedesktop.org/desktop-entry-spec/desktop-entry-spec-latest.html
  */
 
-QXdgDesktopEntry::QXdgDesktopEntry(QString filePath)
-    : d_ptr(new QXdgDesktopEntryPrivate(filePath, this))
+/*!
+ * \brief Construct an empty desktop entry, which is not associated with any file.
+ */
+QXdgDesktopEntry::QXdgDesktopEntry()
+    : d_ptr(new QXdgDesktopEntryPrivate)
+{
+
+}
+
+/*!
+ * \brief Construct a desktop entry from the file at \a filePath.
+ *
+ * Use \a options to control how the file gets loaded. With QXdgDesktopEntry::MapFile, the file is memory-mapped
+ * instead of read, and values are only copied out of the mapping when they are accessed or modified. The mapping
+ * is released when the entry gets destroyed, and the file must not be truncated by others while it's mapped.
+ */
+QXdgDesktopEntry::QXdgDesktopEntry(QString filePath, LoadOptions options)
+    : QXdgDesktopEntry(filePath, QStringList(), options)
+{
+
+}
+
+/*!
+ * \brief Construct a desktop entry from the file at \a filePath, but only load the given \a groups of it.
+ *
+ * The other groups are skipped, as if they were not in the file. If \a groups is empty, every group gets loaded.
+ * Like the partial load options, an entry which skipped some of the file can't be saved.
+ *
+ * \sa isPartiallyLoaded()
+ */
+QXdgDesktopEntry::QXdgDesktopEntry(QString filePath, const QStringList &groups, LoadOptions options)
+    : d_ptr(new QXdgDesktopEntryPrivate(filePath, options))
+{
+    d_ptr->loadGroups = groups;
+    d_ptr->fuzzyLoad();
+    if (options & FreezeOnLoad) {
+        d_ptr->freeze();
+    }
+}
+
+/*!
+ * \brief Parse a desktop entry from the content of a desktop entry file in \a data.
+ *
+ * The data is not copied but shared with \a data, so an array created with QByteArray::fromRawData() is parsed
+ * in place, and its raw data must then stay valid as long as the entry or any copy of it exists. The entry is not
+ * associated with any file, use save(QIODevice *) to write it. The MapFile option doesn't apply here.
+ *
+ * \sa fromDevice()
+ */
+QXdgDesktopEntry QXdgDesktopEntry::fromData(const QByteArray &data, LoadOptions options)
+{
+    QXdgDesktopEntryPrivate *d = new QXdgDesktopEntryPrivate(QString(), options);
+    d->data = data;
+    d->loadData();
+    if (options & FreezeOnLoad) {
+        d->freeze();
+    }
+    return QXdgDesktopEntry(*d);
+}
+
+/*!
+ * \brief Parse a desktop entry from what is left to read from \a device.
+ *
+ * The device must be open for reading. Sequential devices, like sockets or processes, are read in chunks until
+ * they reach their end, waiting for more data when needed. With FirstGroupOnly or PeekOnly, reading stops as soon
+ * as the first group is complete. If the device can't be read, status() returns AccessError. The entry is not
+ * associated with any file, use save(QIODevice *) to write it. The MapFile option doesn't apply here.
+ *
+ * \sa fromData()
+ */
+QXdgDesktopEntry QXdgDesktopEntry::fromDevice(QIODevice *device, LoadOptions options)
+{
+    QXdgDesktopEntryPrivate *d = new QXdgDesktopEntryPrivate(QString(), options);
+    if (device) {
+        d->loadDevice(*device);
+    } else {
+        d->setStatus(AccessError);
+    }
+    if (options & FreezeOnLoad) {
+        d->freeze();
+    }
+    return QXdgDesktopEntry(*d);
+}
+
+/*!
+ * \brief Construct a copy of \a other.
+ *
+ * This is fast, the data is only copied when one of the entries gets modified.
+ */
+QXdgDesktopEntry::QXdgDesktopEntry(const QXdgDesktopEntry &other)
+    : d_ptr(other.d_ptr)
+{
+
+}
+
+/*!
+ * \brief Move-construct an entry from \a other.
+ *
+ * The moved-from entry can only be assigned to or destroyed.
+ */
+QXdgDesktopEntry::QXdgDesktopEntry(QXdgDesktopEntry &&other) noexcept
+    : d_ptr(std::move(other.d_ptr))
+{
+
+}
+
+QXdgDesktopEntry::QXdgDesktopEntry(QXdgDesktopEntryPrivate &dd)
+    : d_ptr(&dd)
 {
 
 }
@@ -506,54 +902,208 @@ QXdgDesktopEntry::~QXdgDesktopEntry()
 
 }
 
+/*!
+ * \brief Assign \a other to this entry, the data is shared until one of them gets modified.
+ */
+QXdgDesktopEntry &QXdgDesktopEntry::operator=(const QXdgDesktopEntry &other)
+{
+    d_ptr = other.d_ptr;
+    return *this;
+}
+
+/*!
+ * \brief Move-assign \a other to this entry.
+ */
+QXdgDesktopEntry &QXdgDesktopEntry::operator=(QXdgDesktopEntry &&other) noexcept
+{
+    swap(other);
+    return *this;
+}
+
+/*!
+ * \brief Returns true if some content of the file was skipped while loading the entry.
+ *
+ * This happens with the FirstGroupOnly and PeekOnly load options, or when only some groups were asked for.
+ * A partially loaded entry can't be saved, as the skipped content would be lost.
+ */
+bool QXdgDesktopEntry::isPartiallyLoaded() const
+{
+    Q_D(const QXdgDesktopEntry);
+    return d->partial;
+}
+
+/*!
+ * \brief Returns true if this entry doesn't share its data with any copy of it.
+ */
+bool QXdgDesktopEntry::isDetached() const
+{
+    return d_ptr->ref.load() == 1;
+}
+
+/*!
+ * \brief Parse every group of the entry now, and make it read-only.
+ *
+ * Reading a frozen entry never locks, which matters when lots of threads read it. Modifying functions
+ * refuse to change a frozen entry, or any copy of it, and return false.
+ *
+ * \sa isFrozen(), LoadOption
+ */
+void QXdgDesktopEntry::freeze()
+{
+    if (d_ptr.constData()->frozen) {
+        return;
+    }
+
+    Q_D(QXdgDesktopEntry);
+    d->freeze();
+}
+
+/*!
+ * \brief Returns true if the entry was frozen.
+ *
+ * \sa freeze()
+ */
+bool QXdgDesktopEntry::isFrozen() const
+{
+    Q_D(const QXdgDesktopEntry);
+    return d->frozen;
+}
+
+QXdgDesktopEntryPrivate *QXdgDesktopEntry::d_func()
+{
+    return d_ptr.data();
+}
+
+const QXdgDesktopEntryPrivate *QXdgDesktopEntry::d_func() const
+{
+    return d_ptr.constData();
+}
+
 /*!
  * \brief Write back data to the desktop entry file.
+ *
+ * Nothing is written if the entry wasn't modified since it was loaded or saved the last time. Otherwise only the
+ * values which were set or removed change in the file, everything else (including comments and the order of the
+ * keys) is written back exactly as it was read. The file is replaced atomically.
+ *
  * \return true if write success; otherwise returns false.
+ *
+ * \sa isModified(), QXdgDesktopEntryTransaction
  */
 bool QXdgDesktopEntry::save() const
 {
     Q_D(const QXdgDesktopEntry);
 
-    // write to file.
-    if (d->isWritable()) {
-        bool ok = false;
-        bool createFile = false;
-        QFileInfo fileInfo(d->filePath);
+    if (d->partial) {
+        qWarning("QXdgDesktopEntry::save: The entry was only partially loaded");
+        return false;
+    }
+
+    if (d->filePath.isEmpty()) {
+        qWarning("QXdgDesktopEntry::save: The entry is not associated with a file");
+        return false;
+    }
+
+    if (!d->isModified()) {
+        return true;
+    }
+
+    QElapsedTimer timer;
+    if (QXdgStatsPrivate::isEnabled()) {
+        timer.start();
+    }
+
+    // We might write to the very same file we have mapped, so nothing is read from it while it's written.
+    // The entry itself is left as it is, copies of it may be read by other threads right now.
+    const QByteArray content = d->serialize();
+
+    // Create the directories to the file.
+    const QString dirPath = QFileInfo(d->filePath).absolutePath();
+    if (!QDir().mkpath(dirPath)) {
+        d->setStatus(QXdgDesktopEntry::AccessError);
+        return false;
+    }
 
 #if !defined(QT_BOOTSTRAPPED) && QT_CONFIG(temporaryfile)
-        QSaveFile sf(d->filePath);
-        sf.setDirectWriteFallback(true);
+    QSaveFile sf(d->filePath);
+    // Truncating the file would break everyone who still has it mapped.
+    sf.setDirectWriteFallback(!d->mapping || d->mapping->file.fileName() != d->filePath);
 #else
-        QFile sf(d->filePath);
+    QFile sf(d->filePath);
 #endif
-        if (!sf.open(QIODevice::WriteOnly)) {
-            d->setStatus(QXdgDesktopEntry::AccessError);
-            return false;
-        }
+    if (!sf.open(QIODevice::WriteOnly)) {
+        d->setStatus(QXdgDesktopEntry::AccessError);
+        return false;
+    }
 
-        ok = d->write(sf);
+    bool ok = sf.write(content) == content.size();
 
 #if !defined(QT_BOOTSTRAPPED) && QT_CONFIG(temporaryfile)
-        if (ok) {
-            ok = sf.commit();
-        }
+    if (ok) {
+        ok = sf.commit();
+    }
 #endif
 
-        if (ok) {
-            // If we have created the file, apply the file perms
-            if (createFile) {
-                QFile::Permissions perms = fileInfo.permissions() | QFile::ReadOwner | QFile::WriteOwner
-                                                                  | QFile::ReadGroup | QFile::ReadOther;
-                QFile(d->filePath).setPermissions(perms);
-            }
-            return true;
-        } else {
-            d->setStatus(QXdgDesktopEntry::AccessError);
-            return false;
-        }
+    if (!ok) {
+        d->setStatus(QXdgDesktopEntry::AccessError);
+        return false;
     }
 
-    return false;
+    d->markSaved();
+    if (timer.isValid()) {
+        QXdgStatsPrivate::recordSave(quint64(timer.nsecsElapsed()));
+    }
+    return true;
+}
+
+/*!
+ * \brief Returns true if a value was set or removed since the entry was loaded or saved the last time.
+ *
+ * \sa save()
+ */
+bool QXdgDesktopEntry::isModified() const
+{
+    Q_D(const QXdgDesktopEntry);
+    return d->isModified();
+}
+
+/*!
+ * \brief Write the desktop entry to \a device, which must be open for writing.
+ *
+ * The content is written at the current position of the device, the same way save() writes it to the file.
+ * Don't write to the file the entry was loaded from with MapFile this way, use save() for it instead.
+ *
+ * \return true if write success; otherwise returns false.
+ */
+bool QXdgDesktopEntry::save(QIODevice *device) const
+{
+    Q_D(const QXdgDesktopEntry);
+
+    if (d->partial) {
+        qWarning("QXdgDesktopEntry::save: The entry was only partially loaded");
+        return false;
+    }
+
+    if (!device || !device->isWritable()) {
+        qWarning("QXdgDesktopEntry::save: The device is not open for writing");
+        d->setStatus(QXdgDesktopEntry::AccessError);
+        return false;
+    }
+
+    QElapsedTimer timer;
+    if (QXdgStatsPrivate::isEnabled()) {
+        timer.start();
+    }
+
+    if (!d->write(*device)) {
+        d->setStatus(QXdgDesktopEntry::AccessError);
+        return false;
+    }
+
+    if (timer.isValid()) {
+        QXdgStatsPrivate::recordSave(quint64(timer.nsecsElapsed()));
+    }
+    return true;
 }
 
 /*!
@@ -566,7 +1116,7 @@ bool QXdgDesktopEntry::save() const
 QXdgDesktopEntry::Status QXdgDesktopEntry::status() const
 {
     Q_D(const QXdgDesktopEntry);
-    return d->status;
+    return QXdgDesktopEntry::Status(d->status.load());
 }
 
 /*!
@@ -589,38 +1139,133 @@ QStringList QXdgDesktopEntry::keys(const QString &section) const
 /*!
  * \brief Get a list of all section groups inside the desktop entry.
  *
- * If \a sorted is set to true, the returned result will keep the order as-is when reading the entry file.
+ * If \a sorted is set to true, the groups are in the order of the file, new ones at the end, otherwise they
+ * are sorted by name. A group which has the name of an earlier one is not listed, see status().
  *
  * \return all available section groups.
  */
 QStringList QXdgDesktopEntry::allGroups(bool sorted) const
 {
     Q_D(const QXdgDesktopEntry);
+    return d->allGroups(sorted);
+}
 
-    if (!sorted) {
-        return d->sectionsMap.keys();
-    } else {
-        using StrIntPair = QPair<QString, int>;
+/*!
+ * \fn template <typename Visitor> bool QXdgDesktopEntry::forEachGroup(Visitor visitor) const
+ * \brief Calls \a visitor with the name of every group, in the order of the file.
+ *
+ * The visitor takes a QStringView and returns false to stop the walk, in which case this returns false too.
+ * Unlike allGroups(), nothing gets allocated, unless the entry has a lot of groups.
+ *
+ * \code
+ * entry.forEachGroup([](QStringView group) {
+ *     qDebug() << group;
+ *     return true;
+ * });
+ * \endcode
+ */
+
+/*!
+ * \fn template <typename Visitor> bool QXdgDesktopEntry::forEachKey(Visitor visitor, const QString &section) const
+ * \brief Calls \a visitor with every key of \a section, in the order of the file.
+ *
+ * The visitor takes a QStringView and returns false to stop the walk, in which case this returns false too.
+ * Unlike keys(), the keys aren't sorted and nothing gets allocated.
+ */
 
-        QStringList keys = d->sectionsMap.keys();
-        QList<StrIntPair> result;
+/*!
+ * \fn template <typename Visitor> bool QXdgDesktopEntry::forEachListItem(const QString &key, Visitor visitor, const QString &section) const
+ * \brief Calls \a visitor with every unescaped item of the list value of \a key in \a section.
+ *
+ * The visitor takes a QStringView and returns false to stop the walk, in which case this returns false too.
+ * The items are the ones stringListValue() returns, but they are decoded and unescaped into a buffer on the
+ * stack, which gets reused for the next item. So the views are only valid during the call of the visitor,
+ * and nothing gets allocated unless the value is long.
+ *
+ * \code
+ * bool isImageViewer = !entry.forEachListItem("MimeType", [](QStringView mimeType) {
+ *     return !mimeType.startsWith(QLatin1String("image/"));
+ * });
+ * \endcode
+ */
 
-        for (const QString & key : keys) {
-            result << StrIntPair(key, d->sectionPos(key));
+bool QXdgDesktopEntry::visitGroups(VisitFunction function, void *visitor) const
+{
+    Q_D(const QXdgDesktopEntry);
+    for (const QXdgDesktopEntrySection &section : d->sections) {
+        if (!section.duplicate && !function(visitor, QStringView(section.name))) {
+            return false;
         }
+    }
+    return true;
+}
 
-        std::sort(result.begin(), result.end(), [](const StrIntPair& a, const StrIntPair& b) -> bool {
-            return a.second < b.second;
-        });
+bool QXdgDesktopEntry::visitKeys(const QString &section, VisitFunction function, void *visitor) const
+{
+    Q_D(const QXdgDesktopEntry);
+    const QXdgDesktopEntrySection *parsedSection = d->parsedSection(section);
+    if (!parsedSection) {
+        return true;
+    }
 
-        keys.clear();
+    for (const QXdgDesktopEntryValue &value : parsedSection->values) {
+        // a view of the name stored in the atom table, neither copied nor locked.
+        if (!function(visitor, QStringView(QXdgKeyAtomTable::nameRef(value.key)))) {
+            return false;
+        }
+    }
+    return true;
+}
 
-        for (const StrIntPair& pair : result) {
-            keys << pair.first;
+// Splits the string list \a value at the semicolons which aren't escaped, the last one is optional, and
+// calls \a function with every unescaped item until it returns false.
+template <typename Function>
+static bool visitValueListItems(const QXdgDesktopEntryValue &value, const QByteArray &data, Function function)
+{
+    QVarLengthArray<QChar, 256> buffer;
+    if (value.isModified()) {
+        buffer.append(value.modifiedValue.constData(), value.modifiedValue.size());
+    } else {
+        decodeUtf8(data.constData() + value.start, value.length, buffer);
+    }
+
+    // Every item gets unescaped in place, it can only get shorter.
+    QChar *chars = buffer.data();
+    const int size = buffer.size();
+    int itemStart = 0;
+    for (int i = 0; i < size; i++) {
+        const ushort ch = chars[i].unicode();
+        if (ch == '\\') {
+            i++;
+        } else if (ch == ';') {
+            const int length = qxdgUnescape(chars + itemStart, i - itemStart, chars + itemStart,
+                                            QXdgUnescapeMode::StringList);
+            if (!function(QStringView(chars + itemStart, length))) {
+                return false;
+            }
+            itemStart = i + 1;
         }
+    }
+    if (itemStart < size) {
+        const int length = qxdgUnescape(chars + itemStart, size - itemStart, chars + itemStart,
+                                        QXdgUnescapeMode::StringList);
+        return function(QStringView(chars + itemStart, length));
+    }
+    return true;
+}
 
-        return keys;
+bool QXdgDesktopEntry::visitListItems(const QString &section, const QString &key, VisitFunction function,
+                                      void *visitor) const
+{
+    Q_D(const QXdgDesktopEntry);
+    const QXdgDesktopEntryValue *value = d->value(section, key);
+    if (!value) {
+        return true;
     }
+
+    return visitValueListItems(*value, d->data, [function, visitor](QStringView item) {
+        return function(visitor, item);
+    });
 }
 
 /*!
@@ -655,7 +1300,7 @@ QString QXdgDesktopEntry::rawValue(const QString &key, const QString &section, c
         qWarning("QXdgDesktopEntry::value: Empty key or section passed");
         return result;
     }
-    const_cast<QXdgDesktopEntryPrivate *>(d)->get(section, key, &result); // FIXME: better way than const_cast?
+    d->get(section, key, &result);
     return result;
 }
 
@@ -676,8 +1321,10 @@ QString QXdgDesktopEntry::stringValue(const QString &key, const QString &section
 /*!
  * \brief Returns the localized string value associated with the given \a key and \a localeKey in \a section.
  *
- * If the given \a localeKey can't be found, it will fallback to "C", if still cannot found, will fallback to the
- * key without localeKey.
+ * The \a localeKey can be a locale name like "sr_YU@Latn", or "default" and "system" for the name of QLocale()
+ * and QLocale::system(), or "empty" to prefer the key without locale. A lang_COUNTRY\@MODIFIER locale falls back
+ * to lang_COUNTRY\@MODIFIER, lang_COUNTRY, lang\@MODIFIER and lang as described by the spec. If none of them can
+ * be found, it will fallback to "C", if still cannot found, will fallback to the key without localeKey.
  *
  * If the entry contains no item with the key, the function returns a default-constructed value.
  *
@@ -687,81 +1334,166 @@ QString QXdgDesktopEntry::localizedValue(const QString &key, const QString &loca
 {
     Q_D(const QXdgDesktopEntry);
     QString result = defaultValue;
-    QString actualLocaleKey = QLatin1String("C");
     if (key.isEmpty() || section.isEmpty()) {
         qWarning("QXdgDesktopEntry::localizedValue: Empty key or section passed");
         return result;
     }
 
-    QStringList possibleKeys;
+    const QXdgLocaleChain *chain = QXdgLocaleChain::forLocaleKey(localeKey);
+    d->getLocalized(section, key, *chain, &result);
 
-    if (!localeKey.isEmpty()) {
-        if (localeKey == "empty") {
-            possibleKeys << key;
-        } else if (localeKey == "default") {
-            possibleKeys << QString("%1[%2]").arg(key, QLocale().name());
-        } else if (localeKey == "system") {
-            possibleKeys << QString("%1[%2]").arg(key, QLocale::system().name());
-        } else {
-            possibleKeys << QString("%1[%2]").arg(key, localeKey);
-        }
-    }
+    return result;
+}
 
-    if (!actualLocaleKey.isEmpty()) {
-        possibleKeys << QString("%1[%2]").arg(key, actualLocaleKey);
+/*!
+ * \brief Returns a list of strings associated with the given \a key in the given \a section.
+ *
+ * If the entry contains no item with the key, the function returns a empty string list. The list is only
+ * split and unescaped the first time, until the value gets modified.
+ *
+ * \sa setRawValue(), rawValue(), stringValue(), localizedValue(), forEachListItem()
+ */
+QStringList QXdgDesktopEntry::stringListValue(const QString &key, const QString &section) const
+{
+    Q_D(const QXdgDesktopEntry);
+    const QXdgDesktopEntryValue *value = d->value(section, key);
+    if (!value) {
+        return QStringList();
     }
-    possibleKeys << QString("%1[%2]").arg(key, "C");
-    possibleKeys << key;
 
-    for (const QString &oneKey : possibleKeys) {
-        if (d->contains(section, oneKey)) {
-            const_cast<QXdgDesktopEntryPrivate *>(d)->get(section, oneKey, &result);
-            break;
-        }
+    if (const QStringList *cached = value->list.loadAcquire()) {
+        QXdgStatsPrivate::add(QXdgStatsPrivate::CacheHits);
+        return *cached;
     }
 
-    return result;
+    // split the value found above, not looking it up again.
+    QStringList *result = new QStringList;
+    visitValueListItems(*value, d->data, [result](QStringView item) {
+        *result << item.toString();
+        return true;
+    });
+
+    // another thread may have been faster, it has the same list.
+    if (!value->list.testAndSetOrdered(nullptr, result)) {
+        delete result;
+        return *value->list.loadAcquire();
+    }
+    return *result;
 }
 
 /*!
- * \brief Returns a list of strings associated with the given \a key in the given \a section.
+ * \brief Returns the value of the given \a key in the given \a section as a boolean.
  *
- * If the entry contains no item with the key, the function returns a empty string list.
+ * Booleans are either "true" or "false", "1" and "0" are accepted too. If the entry contains no item with the key,
+ * or the value is not a boolean, \a defaultValue is returned.
  *
- * \sa setRawValue(), rawValue(), stringValue(), localizedValue()
+ * The value is only parsed the first time, until it gets modified.
+ *
+ * \sa valueType(), numericValue()
  */
-QStringList QXdgDesktopEntry::stringListValue(const QString &key, const QString &section) const
+bool QXdgDesktopEntry::boolValue(const QString &key, const QString &section, bool defaultValue) const
 {
     Q_D(const QXdgDesktopEntry);
+    const QXdgDesktopEntryValue *value = d->value(section, key);
+    if (!value) {
+        return defaultValue;
+    }
 
-    QString value;
+    bool ok;
+    const bool result = value->toBool(d->data, &ok);
+    return ok ? result : defaultValue;
+}
+
+/*!
+ * \brief Returns the value of the given \a key in the given \a section as a number.
+ *
+ * Numbers are parsed with the C locale. If the entry contains no item with the key, or the value is not a number,
+ * \a defaultValue is returned.
+ *
+ * The value is only parsed the first time, until it gets modified.
+ *
+ * \sa valueType(), boolValue()
+ */
+double QXdgDesktopEntry::numericValue(const QString &key, const QString &section, double defaultValue) const
+{
+    Q_D(const QXdgDesktopEntry);
+    const QXdgDesktopEntryValue *value = d->value(section, key);
+    if (!value) {
+        return defaultValue;
+    }
 
-    const_cast<QXdgDesktopEntryPrivate *>(d)->get(section, key, &value);
+    bool ok;
+    const double result = value->toNumeric(d->data, &ok);
+    return ok ? result : defaultValue;
+}
 
-    if (value.endsWith(';')) {
-        value = value.left(value.length() - 1);
+/*!
+ * \brief Returns the type of the given \a key in the given \a section, or NotExisted if there's no such key.
+ *
+ * Keys defined by the spec have the type the spec gives them, localized keys have the type of their base key.
+ * The type of other keys is guessed from their value: Boolean if boolValue() accepts it, Numeric if
+ * numericValue() does, Strings if it ends with a separator, and String otherwise.
+ *
+ * \sa boolValue(), numericValue(), stringListValue()
+ */
+QXdgDesktopEntry::ValueType QXdgDesktopEntry::valueType(const QString &key, const QString &section) const
+{
+    Q_D(const QXdgDesktopEntry);
+    const QXdgDesktopEntryValue *value = d->value(section, key);
+    if (!value) {
+        return NotExisted;
     }
-    QStringList&& strings = value.split(';');
 
-    QString combine;
-    QStringList result;
-    for (QString oneStr : strings) {
-        if (oneStr.endsWith('\\')) {
-            combine = combine + oneStr + ';';
-            continue;
+    const ValueType wellKnownType = qxdgWellKnownKeyType(value->baseKey);
+    return wellKnownType != NotExisted ? wellKnownType : guessValueType(*value, d->data);
+}
+
+/*!
+ * \brief Returns the parsed Exec key of the given \a section, ready to be launched.
+ *
+ * The %i, %c and %k field codes get the Icon and Name keys of the same section and the path of the entry, and
+ * the Path key becomes the working directory. The result is cached until the section gets modified, so
+ * launching the same entry again doesn't parse anything.
+ *
+ * \sa QXdgDesktopEntryExec
+ */
+QXdgDesktopEntryExec QXdgDesktopEntry::exec(const QString &section) const
+{
+    Q_D(const QXdgDesktopEntry);
+    if (d->frozen) {
+        // freeze() cached every section, and a section which doesn't exist has nothing to parse.
+        QHash<QString, QXdgDesktopEntryExec>::const_iterator it = d->execCache.constFind(section);
+        if (it != d->execCache.constEnd()) {
+            QXdgStatsPrivate::add(QXdgStatsPrivate::CacheHits);
+            return it.value();
         }
-        if (!combine.isEmpty()) {
-            oneStr = combine + oneStr;
-            combine.clear();
+        return d->parseExec(section);
+    }
+
+    {
+        QMutexLocker locker(&d->mutex);
+        QHash<QString, QXdgDesktopEntryExec>::const_iterator it = d->execCache.constFind(section);
+        if (it != d->execCache.constEnd()) {
+            QXdgStatsPrivate::add(QXdgStatsPrivate::CacheHits);
+            return it.value();
         }
-        result << QXdgDesktopEntry::unescape(oneStr, true);
     }
 
+    // reading the keys locks the mutex on its own.
+    const QXdgDesktopEntryExec result = d->parseExec(section);
+
+    QMutexLocker locker(&d->mutex);
+    d->execCache.insert(section, result);
     return result;
 }
 
 bool QXdgDesktopEntry::setRawValue(const QString &value, const QString &key, const QString &section)
 {
+    // before detaching, a frozen entry may be read by other threads.
+    if (!d_ptr.constData()->checkWritable("QXdgDesktopEntry::setRawValue")) {
+        return false;
+    }
+
     Q_D(QXdgDesktopEntry);
     if (key.isEmpty() || section.isEmpty()) {
         qWarning("QXdgDesktopEntry::setRawValue: Empty key or section passed");
@@ -782,6 +1514,10 @@ bool QXdgDesktopEntry::setStringValue(const QString &value, const QString &key,
 
 bool QXdgDesktopEntry::setLocalizedValue(const QString &value, const QString &localeKey, const QString &key, const QString &section)
 {
+    if (!d_ptr.constData()->checkWritable("QXdgDesktopEntry::setLocalizedValue")) {
+        return false;
+    }
+
     Q_D(QXdgDesktopEntry);
     if (key.isEmpty() || section.isEmpty()) {
         qWarning("QXdgDesktopEntry::setLocalizedValue: Empty key or section passed");
@@ -796,6 +1532,10 @@ bool QXdgDesktopEntry::setLocalizedValue(const QString &value, const QString &lo
 
 bool QXdgDesktopEntry::removeEntry(const QString &key, const QString &section)
 {
+    if (!d_ptr.constData()->checkWritable("QXdgDesktopEntry::removeEntry")) {
+        return false;
+    }
+
     Q_D(QXdgDesktopEntry);
     if (key.isEmpty() || section.isEmpty()) {
         qWarning("QXdgDesktopEntry::setLocalizedValue: Empty key or section passed");
@@ -812,12 +1552,17 @@ bool QXdgDesktopEntry::removeEntry(const QString &key, const QString &section)
  ************************************************/
 QString &QXdgDesktopEntry::escape(QString &str)
 {
-    QHash<QChar,QChar> repl;
-    repl.insert(QLatin1Char('\n'),  QLatin1Char('n'));
-    repl.insert(QLatin1Char('\t'),  QLatin1Char('t'));
-    repl.insert(QLatin1Char('\r'),  QLatin1Char('r'));
+    QXdgStatsPrivate::add(QXdgStatsPrivate::EscapeCalls);
+    return doEscape(str, QXdgEscapeMode::String);
+}
 
-    return doEscape(str, repl);
+/*!
+ * \brief Writes \a str escaped like escape() does to \a out, reusing the buffer of \a out.
+ */
+QString &QXdgDesktopEntry::escape(QStringView str, QString &out)
+{
+    QXdgStatsPrivate::add(QXdgStatsPrivate::EscapeCalls);
+    return doEscape(str, out, QXdgEscapeMode::String);
 }
 
 /************************************************
@@ -841,16 +1586,17 @@ is unambiguously represented with ("\\$").
  ************************************************/
 QString &QXdgDesktopEntry::escapeExec(QString &str)
 {
-    QHash<QChar,QChar> repl;
-    // The parseCombinedArgString() splits the string by the space symbols,
-    // we temporarily replace them on the special characters.
-    // Replacement will reverse after the splitting.
-    repl.insert(QLatin1Char('"'), QLatin1Char('"'));    // double quote,
-    repl.insert(QLatin1Char('\''), QLatin1Char('\''));  // single quote ("'"),
-    repl.insert(QLatin1Char('\\'), QLatin1Char('\\'));  // backslash character ("\"),
-    repl.insert(QLatin1Char('$'), QLatin1Char('$'));    // dollar sign ("$"),
+    QXdgStatsPrivate::add(QXdgStatsPrivate::EscapeCalls);
+    return doEscape(str, QXdgEscapeMode::Exec);
+}
 
-    return doEscape(str, repl);
+/*!
+ * \brief Writes \a str escaped like escapeExec() does to \a out, reusing the buffer of \a out.
+ */
+QString &QXdgDesktopEntry::escapeExec(QStringView str, QString &out)
+{
+    QXdgStatsPrivate::add(QXdgStatsPrivate::EscapeCalls);
+    return doEscape(str, out, QXdgEscapeMode::Exec);
 }
 
 /*
@@ -866,18 +1612,17 @@ QString &QXdgDesktopEntry::escapeExec(QString &str)
 */
 QString &QXdgDesktopEntry::unescape(QString &str, bool unescapeSemicolons)
 {
-    QHash<QChar,QChar> repl;
-    repl.insert(QLatin1Char('\\'), QLatin1Char('\\'));
-    repl.insert(QLatin1Char('s'),  QLatin1Char(' '));
-    repl.insert(QLatin1Char('n'),  QLatin1Char('\n'));
-    repl.insert(QLatin1Char('t'),  QLatin1Char('\t'));
-    repl.insert(QLatin1Char('r'),  QLatin1Char('\r'));
-
-    if (unescapeSemicolons) {
-        repl.insert(QLatin1Char(';'),  QLatin1Char(';'));
-    }
+    QXdgStatsPrivate::add(QXdgStatsPrivate::UnescapeCalls);
+    return doUnescape(str, unescapeSemicolons ? QXdgUnescapeMode::StringList : QXdgUnescapeMode::String);
+}
 
-    return doUnescape(str, repl);
+/*!
+ * \brief Writes \a str unescaped like unescape() does to \a out, reusing the buffer of \a out.
+ */
+QString &QXdgDesktopEntry::unescape(QStringView str, QString &out, bool unescapeSemicolons)
+{
+    QXdgStatsPrivate::add(QXdgStatsPrivate::UnescapeCalls);
+    return doUnescape(str, out, unescapeSemicolons ? QXdgUnescapeMode::StringList : QXdgUnescapeMode::String);
 }
 
 /************************************************
@@ -921,33 +1666,17 @@ is unambiguously represented with ("\\$").
  ************************************************/
 QString &QXdgDesktopEntry::unescapeExec(QString &str)
 {
-    unescape(str);
-    QHash<QChar,QChar> repl;
-    // The parseCombinedArgString() splits the string by the space symbols,
-    // we temporarily replace them on the special characters.
-    // Replacement will reverse after the splitting.
-    repl.insert(QLatin1Char(' '),  01);    // space
-    repl.insert(QLatin1Char('\t'), 02);    // tab
-    repl.insert(QLatin1Char('\n'), 03);    // newline,
-
-    repl.insert(QLatin1Char('"'), QLatin1Char('"'));    // double quote,
-    repl.insert(QLatin1Char('\''), QLatin1Char('\''));  // single quote ("'"),
-    repl.insert(QLatin1Char('\\'), QLatin1Char('\\'));  // backslash character ("\"),
-    repl.insert(QLatin1Char('>'), QLatin1Char('>'));    // greater-than sign (">"),
-    repl.insert(QLatin1Char('<'), QLatin1Char('<'));    // less-than sign ("<"),
-    repl.insert(QLatin1Char('~'), QLatin1Char('~'));    // tilde ("~"),
-    repl.insert(QLatin1Char('|'), QLatin1Char('|'));    // vertical bar ("|"),
-    repl.insert(QLatin1Char('&'), QLatin1Char('&'));    // ampersand ("&"),
-    repl.insert(QLatin1Char(';'), QLatin1Char(';'));    // semicolon (";"),
-    repl.insert(QLatin1Char('$'), QLatin1Char('$'));    // dollar sign ("$"),
-    repl.insert(QLatin1Char('*'), QLatin1Char('*'));    // asterisk ("*"),
-    repl.insert(QLatin1Char('?'), QLatin1Char('?'));    // question mark ("?"),
-    repl.insert(QLatin1Char('#'), QLatin1Char('#'));    // hash mark ("#"),
-    repl.insert(QLatin1Char('('), QLatin1Char('('));    // parenthesis ("(")
-    repl.insert(QLatin1Char(')'), QLatin1Char(')'));    // parenthesis (")")
-    repl.insert(QLatin1Char('`'), QLatin1Char('`'));    // backtick character ("`").
-
-    return doUnescape(str, repl);
+    QXdgStatsPrivate::add(QXdgStatsPrivate::UnescapeCalls);
+    return doUnescape(str, QXdgUnescapeMode::Exec);
+}
+
+/*!
+ * \brief Writes \a str unescaped like unescapeExec() does to \a out, reusing the buffer of \a out.
+ */
+QString &QXdgDesktopEntry::unescapeExec(QStringView str, QString &out)
+{
+    QXdgStatsPrivate::add(QXdgStatsPrivate::UnescapeCalls);
+    return doUnescape(str, out, QXdgUnescapeMode::Exec);
 }
 
 bool QXdgDesktopEntry::setStatus(const QXdgDesktopEntry::Status &status)
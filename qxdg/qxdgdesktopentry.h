@@ -27,8 +27,11 @@
 
 #include <QIODevice>
 #include <QObject>
+#include <QSharedDataPointer>
+#include <QStringView>
 #include <QVariant>
 
+class QXdgDesktopEntryExec;
 class QXdgDesktopEntryPrivate;
 class QXDGSHARED_EXPORT QXdgDesktopEntry
 {
@@ -62,15 +65,56 @@ public:
     };
     Q_ENUM(Status)
 
-    explicit QXdgDesktopEntry(QString filePath);
+    enum LoadOption {
+        DefaultLoad = 0x0,    //!< Read the whole file into memory.
+        MapFile = 0x1,        //!< Memory-map the file read-only instead of reading it, the mapping lives as long as the entry.
+        FreezeOnLoad = 0x2,   //!< Parse every group right away and freeze() the entry.
+        FirstGroupOnly = 0x4, //!< Stop reading the file after its first group, which is "Desktop Entry" in valid files.
+        PeekOnly = 0x8        //!< Same as FirstGroupOnly, and only keep the Type, Hidden and NoDisplay keys of it.
+    };
+    Q_DECLARE_FLAGS(LoadOptions, LoadOption)
+    Q_FLAG(LoadOptions)
+
+    QXdgDesktopEntry();
+    explicit QXdgDesktopEntry(QString filePath, LoadOptions options = DefaultLoad);
+    QXdgDesktopEntry(QString filePath, const QStringList &groups, LoadOptions options = DefaultLoad);
+    static QXdgDesktopEntry fromData(const QByteArray &data, LoadOptions options = DefaultLoad);
+    static QXdgDesktopEntry fromDevice(QIODevice *device, LoadOptions options = DefaultLoad);
+    QXdgDesktopEntry(const QXdgDesktopEntry &other);
+    QXdgDesktopEntry(QXdgDesktopEntry &&other) noexcept;
     ~QXdgDesktopEntry();
 
+    QXdgDesktopEntry &operator=(const QXdgDesktopEntry &other);
+    QXdgDesktopEntry &operator=(QXdgDesktopEntry &&other) noexcept;
+    void swap(QXdgDesktopEntry &other) noexcept { qSwap(d_ptr, other.d_ptr); }
+
+    bool isDetached() const;
+    bool isPartiallyLoaded() const;
+
+    void freeze();
+    bool isFrozen() const;
+
     bool save() const;
+    bool save(QIODevice *device) const;
+    bool isModified() const;
 
     Status status() const;
     QStringList keys(const QString &section = "Desktop Entry") const;
     QStringList allGroups(bool sorted = false) const;
 
+    template <typename Visitor>
+    bool forEachGroup(Visitor visitor) const {
+        return visitGroups(&QXdgDesktopEntry::invokeVisitor<Visitor>, &visitor);
+    }
+    template <typename Visitor>
+    bool forEachKey(Visitor visitor, const QString &section = "Desktop Entry") const {
+        return visitKeys(section, &QXdgDesktopEntry::invokeVisitor<Visitor>, &visitor);
+    }
+    template <typename Visitor>
+    bool forEachListItem(const QString &key, Visitor visitor, const QString &section = "Desktop Entry") const {
+        return visitListItems(section, key, &QXdgDesktopEntry::invokeVisitor<Visitor>, &visitor);
+    }
+
     bool contains(const QString& key, const QString &section = "Desktop Entry") const;
 
     QString rawValue(const QString& key, const QString& section = "Desktop Entry",
@@ -80,6 +124,10 @@ public:
     QString localizedValue(const QString& key, const QString& localeKey = "default",
                             const QString& section = "Desktop Entry", const QString& defaultValue = QString()) const;
     QStringList stringListValue(const QString& key, const QString& section = "Desktop Entry") const;
+    bool boolValue(const QString& key, const QString& section = "Desktop Entry", bool defaultValue = false) const;
+    double numericValue(const QString& key, const QString& section = "Desktop Entry", double defaultValue = 0) const;
+    ValueType valueType(const QString& key, const QString& section = "Desktop Entry") const;
+    QXdgDesktopEntryExec exec(const QString& section = "Desktop Entry") const;
 
     bool setRawValue(const QString &value, const QString &key, const QString& section = "Desktop Entry");
     bool setStringValue(const QString &value, const QString &key, const QString& section = "Desktop Entry");
@@ -89,17 +137,42 @@ public:
     bool removeEntry(const QString& key, const QString &section = "Desktop Entry");
 
     static QString &escape(QString& str);
+    static QString &escape(QStringView str, QString &out);
     static QString &escapeExec(QString& str);
+    static QString &escapeExec(QStringView str, QString &out);
     static QString &unescape(QString& str, bool unescapeSemicolons = false);
+    static QString &unescape(QStringView str, QString &out, bool unescapeSemicolons = false);
     static QString &unescapeExec(QString& str);
+    static QString &unescapeExec(QStringView str, QString &out);
 
 protected:
     bool setStatus(const Status& status);
 
 private:
-    QScopedPointer<QXdgDesktopEntryPrivate> d_ptr;
-
-    Q_DECLARE_PRIVATE(QXdgDesktopEntry)
+    explicit QXdgDesktopEntry(QXdgDesktopEntryPrivate &dd);
+
+    // The visitors are called through a plain function pointer, so walking doesn't need a std::function.
+    typedef bool (*VisitFunction)(void *visitor, QStringView view);
+    template <typename Visitor>
+    static bool invokeVisitor(void *visitor, QStringView view) {
+        return (*static_cast<Visitor *>(visitor))(view);
+    }
+    bool visitGroups(VisitFunction function, void *visitor) const;
+    bool visitKeys(const QString &section, VisitFunction function, void *visitor) const;
+    bool visitListItems(const QString &section, const QString &key, VisitFunction function, void *visitor) const;
+
+    // Not Q_DECLARE_PRIVATE, the non-const accessor detaches, and both need the complete private class.
+    QXdgDesktopEntryPrivate *d_func();
+    const QXdgDesktopEntryPrivate *d_func() const;
+
+    QSharedDataPointer<QXdgDesktopEntryPrivate> d_ptr;
+
+    friend class QXdgDesktopEntryPrivate;
+    friend class QXdgDesktopEntryCache;
+    friend class QXdgDesktopEntryTransaction;
 };
 
+Q_DECLARE_SHARED(QXdgDesktopEntry)
+Q_DECLARE_OPERATORS_FOR_FLAGS(QXdgDesktopEntry::LoadOptions)
+
 #endif // QXDGDESKTOPENTRY_H
@@ -0,0 +1,757 @@
+/*
+ * Copyright (C) 2019 Deepin Technology Co., Ltd.
+ *               2019 Gary Wang
+ *
+ * Author:     Gary Wang <wzc782970009@gmail.com>
+ *
+ * Maintainer: Gary Wang <wzc782970009@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QXDGDESKTOPENTRY_P_H
+#define QXDGDESKTOPENTRY_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the QXdg API. It exists purely as an
+// implementation detail. This header file may change from version to
+// version without notice, or even be removed.
+//
+
+#include "qxdgdesktopentry.h"
+#include "qxdgdesktopentryexec.h"
+#include "qxdgdesktopentrytokenizer_p.h"
+#include "qxdgkeyatomtable_p.h"
+#include "qxdglocalechain_p.h"
+#include "qxdgstats_p.h"
+
+#include <QAtomicInt>
+#include <QAtomicPointer>
+#include <QFile>
+#include <QHash>
+#include <QMutex>
+#include <QSharedData>
+#include <QSharedPointer>
+#include <QVarLengthArray>
+#include <QVector>
+
+#include <algorithm>
+#include <limits>
+#include <string.h>
+
+/*! \internal */
+class QXdgDesktopEntryMapping
+{
+public:
+    explicit QXdgDesktopEntryMapping(const QString &filePath)
+        : file(filePath) {}
+
+    bool map() {
+        if (!file.open(QFile::ReadOnly)) {
+            return false;
+        }
+
+        const qint64 size = file.size();
+        if (size > 0 && size <= std::numeric_limits<int>::max()) {
+            address = file.map(0, size);
+        }
+
+        // The file doesn't need to stay open once it's mapped, and we don't want to hold a file
+        // descriptor for every loaded entry. QFile unmaps it when it gets destroyed.
+        file.close();
+
+        if (!address) {
+            return false;
+        }
+
+        data = QByteArray::fromRawData(reinterpret_cast<const char *>(address), int(size));
+        return true;
+    }
+
+    QFile file;
+    uchar *address = nullptr;
+    QByteArray data;
+};
+
+/*! \internal */
+class QXdgDesktopEntryValue
+{
+public:
+    QXdgKeyAtom key = QXdgKeyAtomTable::InvalidAtom;
+    // For a "Key[locale]" key, the atoms of "Key" and "locale". The same as key and InvalidAtom otherwise.
+    QXdgKeyAtom baseKey = QXdgKeyAtomTable::InvalidAtom;
+    QXdgKeyAtom locale = QXdgKeyAtomTable::InvalidAtom;
+    // Position of the next value with the same base key, see QXdgDesktopEntrySection::variants.
+    int nextVariant = -1;
+    // Offset and length of the trimmed raw value inside the entry data. A modified value
+    // doesn't point to the entry data anymore, it keeps its own copy instead.
+    int start = -1;
+    int length = 0;
+    QString modifiedValue;
+
+    // Typed conversions, done the first time the value gets asked for as such. Readers of different threads may
+    // convert it at the same time, they all come to the same result, so the flags are just or-ed in. The number
+    // is stored before its flags get published.
+    enum ConversionFlag {
+        BoolConverted = 0x1,
+        BoolValid = 0x2,
+        BoolTrue = 0x4,
+        NumericConverted = 0x8,
+        NumericValid = 0x10,
+        // the ValueType guessed from the content, plus one, for keys the spec doesn't know.
+        GuessedTypeShift = 8
+    };
+    mutable QAtomicInt conversions;
+    mutable QAtomicInteger<quint64> numericBits;
+    // Split and unescaped list value. The first reader to store its list wins, later readers share it.
+    mutable QAtomicPointer<QStringList> list;
+
+    QXdgDesktopEntryValue() = default;
+    QXdgDesktopEntryValue(const QXdgDesktopEntryValue &other) {
+        *this = other;
+    }
+    ~QXdgDesktopEntryValue() {
+        delete list.load();
+    }
+
+    QXdgDesktopEntryValue &operator=(const QXdgDesktopEntryValue &other) {
+        if (this == &other) return *this;
+        key = other.key;
+        baseKey = other.baseKey;
+        locale = other.locale;
+        nextVariant = other.nextVariant;
+        start = other.start;
+        length = other.length;
+        modifiedValue = other.modifiedValue;
+        // the numeric value must be there when its flag is.
+        const int otherConversions = other.conversions.loadAcquire();
+        numericBits.store(other.numericBits.load());
+        conversions.store(otherConversions);
+        const QStringList *otherList = other.list.loadAcquire();
+        delete list.load();
+        list.store(otherList ? new QStringList(*otherList) : nullptr);
+        return *this;
+    }
+
+    void setModifiedValue(const QString &value) {
+        start = -1;
+        length = 0;
+        modifiedValue = value;
+        conversions.store(0);
+        delete list.load();
+        list.store(nullptr);
+    }
+
+    bool isModified() const {
+        return start == -1;
+    }
+
+    // Whether the value is exactly \a str, without converting it.
+    bool equals(const QByteArray &data, QLatin1String str) const {
+        if (isModified()) {
+            return modifiedValue == str;
+        }
+        return length == str.size() && memcmp(data.constData() + start, str.latin1(), size_t(length)) == 0;
+    }
+
+    bool toBool(const QByteArray &data, bool *ok) const {
+        int flags = conversions.loadAcquire();
+        if (!(flags & BoolConverted)) {
+            // "1" and "0" are not in the spec, but GLib accepts them and so do we.
+            flags = BoolConverted;
+            if (equals(data, QLatin1String("true")) || equals(data, QLatin1String("1"))) {
+                flags |= BoolValid | BoolTrue;
+            } else if (equals(data, QLatin1String("false")) || equals(data, QLatin1String("0"))) {
+                flags |= BoolValid;
+            }
+            conversions.fetchAndOrRelease(flags);
+        } else {
+            QXdgStatsPrivate::add(QXdgStatsPrivate::CacheHits);
+        }
+        *ok = flags & BoolValid;
+        return flags & BoolTrue;
+    }
+
+    double toNumeric(const QByteArray &data, bool *ok) const {
+        int flags = conversions.loadAcquire();
+        double number;
+        if (flags & NumericConverted) {
+            const quint64 bits = numericBits.load();
+            memcpy(&number, &bits, sizeof(number));
+            QXdgStatsPrivate::add(QXdgStatsPrivate::CacheHits);
+        } else {
+            // both use the C locale, as the spec wants.
+            bool valid;
+            number = isModified() ? modifiedValue.toDouble(&valid)
+                                  : QByteArray::fromRawData(data.constData() + start, length).toDouble(&valid);
+            if (!valid) {
+                number = 0;
+            }
+            quint64 bits;
+            memcpy(&bits, &number, sizeof(bits));
+            numericBits.store(bits);
+            flags = NumericConverted | (valid ? NumericValid : 0);
+            conversions.fetchAndOrRelease(flags);
+        }
+        *ok = flags & NumericValid;
+        return number;
+    }
+
+    QString toString(const QByteArray &data) const {
+        if (isModified()) {
+            return modifiedValue;
+        }
+        return QString::fromUtf8(data.constData() + start, length);
+    }
+
+    void setKey(const char *utf8, int keyLength) {
+        key = QXdgKeyAtomTable::intern(utf8, keyLength);
+        baseKey = key;
+        locale = QXdgKeyAtomTable::InvalidAtom;
+
+        if (keyLength < 3 || utf8[keyLength - 1] != ']') return;
+        const char *openBracket = static_cast<const char *>(memchr(utf8, '[', size_t(keyLength)));
+        if (!openBracket || openBracket == utf8) return;
+
+        const int baseLength = int(openBracket - utf8);
+        baseKey = QXdgKeyAtomTable::intern(utf8, baseLength);
+        locale = QXdgKeyAtomTable::intern(openBracket + 1, keyLength - baseLength - 2);
+    }
+};
+
+/*! \internal */
+class QXdgDesktopEntryVariantGroup
+{
+public:
+    // Position of the first value of the chain linked by QXdgDesktopEntryValue::nextVariant.
+    int first = -1;
+    // What we found the last time we were asked: the serial of the locale chain in the upper half, and the
+    // found position plus one in the lower half. Readers of different threads may update it at the same time,
+    // so both are kept in a single atomic.
+    mutable QAtomicInteger<quint64> resolution;
+
+    static quint64 packResolution(int chainSerial, int pos) {
+        return (quint64(quint32(chainSerial)) << 32) | quint32(pos + 1);
+    }
+};
+
+/*!
+ * \internal
+ * \brief Record of a value as stored by QXdgDesktopEntryCache.
+ *
+ * The key is at keyOffset inside the cache file, the value offsets are relative to the entry data.
+ */
+struct QXdgDesktopEntryCachedValue
+{
+    quint32 keyOffset;
+    quint32 keyLength;
+    quint32 valueStart;
+    quint32 valueLength;
+};
+
+/*! \internal */
+class QXdgDesktopEntrySection
+{
+public:
+    // Sections with up to this amount of keys are looked up with a linear scan, which is faster than
+    // hashing for them, and they don't need an index at all.
+    static const int LinearScanLimit = 8;
+
+    QString name;
+    // Values in file order, so we can write them back in the same order.
+    QVector<QXdgDesktopEntryValue> values;
+    // Open addressing hash table of positions inside values (-1 marks a free slot), its size is always
+    // a power of two and at least twice the value count. Empty if the section is small enough.
+    QVector<int> valueIndex;
+    // Base keys which have localized variants, mapped to the chain of all their variants, including the one
+    // without locale. Keys without any translation are not here.
+    QHash<QXdgKeyAtom, QXdgDesktopEntryVariantGroup> variants;
+    // Range of the whole section (including the group header) inside the entry data,
+    // only used when the section is not parsed yet.
+    int dataStart = 0;
+    int dataLength = 0;
+    // Set with release semantics once everything above is filled, readers which see it set with acquire
+    // semantics can use the values without any lock. See QXdgDesktopEntryPrivate::parsedSection().
+    QAtomicInt parsed = 1;
+    int sectionPos = 99;
+    // Set for sections loaded from QXdgDesktopEntryCache, parsing them means reading these records instead of
+    // tokenizing the section data. Both point into the cache mapping, which the entry keeps alive.
+    const char *cacheData = nullptr;
+    const QXdgDesktopEntryCachedValue *cachedValues = nullptr;
+    int cachedValueCount = 0;
+    // Only the keys kept by QXdgDesktopEntry::PeekOnly get parsed.
+    bool peekOnly = false;
+    // Some value was set or removed since the section was loaded, see writeData().
+    bool modified = false;
+    // An earlier group has the same name. Kept so saving writes the group back, but never looked up.
+    bool duplicate = false;
+
+    inline operator QString() const {
+        return QLatin1String("QXdgDesktopEntrySection(") + name + QLatin1String(")");
+    }
+
+    static bool isPeekKey(const char *utf8, int length) {
+        switch (length) {
+        case 4:
+            return memcmp(utf8, "Type", 4) == 0;
+        case 6:
+            return memcmp(utf8, "Hidden", 6) == 0;
+        case 9:
+            return memcmp(utf8, "NoDisplay", 9) == 0;
+        default:
+            return false;
+        }
+    }
+
+    static void appendValueLine(QByteArray &out, const QXdgDesktopEntryValue &value, const QByteArray &data) {
+        out.append(QXdgKeyAtomTable::nameRef(value.key).toUtf8());
+        out.append('=');
+        out.append(value.toString(data).toUtf8());
+        out.append('\n');
+    }
+
+    // Appends the section as it should be saved. Untouched sections are copied byte by byte. In modified ones only
+    // the values which changed are replaced, removed keys lose their line and new keys are added after the last
+    // key, so comments, blank lines and the order of the keys stay as they were.
+    void writeData(const QByteArray &data, QByteArray &out) const {
+        if (!modified) {
+            out.append(data.constData() + dataStart, dataLength);
+            return;
+        }
+
+        if (dataLength == 0) {
+            // a new section.
+            if (!out.isEmpty() && !out.endsWith('\n')) {
+                out.append('\n');
+            }
+            out.append('[');
+            out.append(name.toUtf8());
+            out.append("]\n");
+            for (const QXdgDesktopEntryValue &value : values) {
+                appendValueLine(out, value, data);
+            }
+            return;
+        }
+
+        const char *sectionData = data.constData() + dataStart;
+        QVarLengthArray<bool, 64> written(values.count());
+        std::fill(written.begin(), written.end(), false);
+        // where the section data was copied up to, and where new keys go in the output.
+        int copied = 0;
+        int insertPos = -1;
+        // for readLineFromData()
+        int dataPos = 0;
+        int lineStart;
+        int lineLen;
+        int equalsPos;
+
+        while (readLineFromData(sectionData, dataLength, dataPos, lineStart, lineLen, equalsPos)) {
+            int lineEnd = dataPos;
+            if (lineEnd < dataLength && sectionData[lineEnd] == '\r') lineEnd++;
+            if (lineEnd < dataLength && sectionData[lineEnd] == '\n') lineEnd++;
+
+            if (sectionData[lineStart] != '[' && equalsPos != -1) {
+                int keyStart = lineStart;
+                int keyLength = equalsPos - lineStart;
+                trimRange(sectionData, keyStart, keyLength);
+                const QXdgKeyAtom key = QXdgKeyAtomTable::find(sectionData + keyStart, keyLength);
+                const int pos = key == QXdgKeyAtomTable::InvalidAtom ? -1 : indexOf(key);
+
+                if (pos == -1) {
+                    // removed, together with its indentation and line break.
+                    int physicalLineStart = lineStart;
+                    while (physicalLineStart > copied && (sectionData[physicalLineStart - 1] == ' '
+                                                          || sectionData[physicalLineStart - 1] == '\t')) {
+                        physicalLineStart--;
+                    }
+                    out.append(sectionData + copied, physicalLineStart - copied);
+                    copied = lineEnd;
+                    continue;
+                }
+
+                written[pos] = true;
+                if (values[pos].isModified()) {
+                    int valueStart = equalsPos + 1;
+                    int valueLength = lineStart + lineLen - equalsPos - 1;
+                    trimRange(sectionData, valueStart, valueLength);
+                    out.append(sectionData + copied, valueStart - copied);
+                    out.append(values[pos].modifiedValue.toUtf8());
+                    copied = valueStart + valueLength;
+                }
+            } else if (sectionData[lineStart] != '[') {
+                continue;
+            }
+
+            out.append(sectionData + copied, lineEnd - copied);
+            copied = lineEnd;
+            insertPos = out.size();
+        }
+        out.append(sectionData + copied, dataLength - copied);
+
+        QByteArray added;
+        for (int i = 0; i < values.count(); i++) {
+            if (!written[i]) {
+                appendValueLine(added, values[i], data);
+            }
+        }
+        if (!added.isEmpty()) {
+            if (insertPos == -1) {
+                insertPos = out.size();
+            }
+            if (insertPos > 0 && out.at(insertPos - 1) != '\n') {
+                added.prepend('\n');
+            }
+            out.insert(insertPos, added);
+        }
+    }
+
+    // Callers which may race with other readers must hold QXdgDesktopEntryPrivate::mutex.
+    bool ensureSectionDataParsed(const QByteArray &data) {
+        if (parsed.loadAcquire()) return true;
+
+        values.clear();
+
+        if (cachedValues) {
+            for (int i = 0; i < cachedValueCount; i++) {
+                const QXdgDesktopEntryCachedValue &cachedValue = cachedValues[i];
+                if (peekOnly && !isPeekKey(cacheData + cachedValue.keyOffset, int(cachedValue.keyLength))) continue;
+                QXdgDesktopEntryValue value;
+                value.setKey(cacheData + cachedValue.keyOffset, int(cachedValue.keyLength));
+                value.start = int(cachedValue.valueStart);
+                value.length = int(cachedValue.valueLength);
+                append(value);
+            }
+            cacheData = nullptr;
+            cachedValues = nullptr;
+            parsed.storeRelease(1);
+            return true;
+        }
+
+        const char *sectionData = data.constData() + dataStart;
+        // for readLineFromFileData()
+        int dataPos = 0;
+        int lineStart;
+        int lineLen;
+        int equalsPos;
+
+        while(readLineFromData(sectionData, dataLength, dataPos, lineStart, lineLen, equalsPos)) {
+            if (sectionData[lineStart] == '[') continue; // section name already parsed
+
+            if (equalsPos != -1) {
+                int keyStart = lineStart;
+                int keyLength = equalsPos - lineStart;
+                trimRange(sectionData, keyStart, keyLength);
+                if (peekOnly && !isPeekKey(sectionData + keyStart, keyLength)) continue;
+
+                QXdgDesktopEntryValue value;
+                value.setKey(sectionData + keyStart, keyLength);
+                value.start = equalsPos + 1;
+                value.length = lineStart + lineLen - equalsPos - 1;
+                trimRange(sectionData, value.start, value.length);
+                value.start += dataStart;
+
+                // the last one wins if a key is duplicated.
+                int pos = indexOf(value.key);
+                if (pos == -1) {
+                    append(value);
+                } else {
+                    value.nextVariant = values[pos].nextVariant;
+                    values[pos] = value;
+                }
+            }
+        }
+
+        parsed.storeRelease(1);
+
+        return true;
+    }
+
+    // What parsing the section allocated, for QXdgStats.
+    quint64 parsedMemoryUsage() const {
+        return quint64(values.capacity()) * sizeof(QXdgDesktopEntryValue) + quint64(valueIndex.capacity()) * sizeof(int)
+                + quint64(variants.capacity()) * (sizeof(QXdgKeyAtom) + sizeof(QXdgDesktopEntryVariantGroup) + 2 * sizeof(void *));
+    }
+
+    int indexOf(const QString &key) const {
+        // a key which was never interned can't be here.
+        const QXdgKeyAtom atom = QXdgKeyAtomTable::find(key);
+        return atom == QXdgKeyAtomTable::InvalidAtom ? -1 : indexOf(atom);
+    }
+
+    int indexOf(QXdgKeyAtom key) const {
+        if (valueIndex.isEmpty()) {
+            for (int i = 0; i < values.count(); i++) {
+                if (values[i].key == key) return i;
+            }
+            return -1;
+        }
+
+        const uint mask = uint(valueIndex.count() - 1);
+        for (uint slot = QXdgKeyAtomTable::hash(key) & mask; valueIndex[slot] != -1; slot = (slot + 1) & mask) {
+            if (values[valueIndex[slot]].key == key) return valueIndex[slot];
+        }
+        return -1;
+    }
+
+    // Returns the position of the best variant of \a baseKey for the given locale chain, or -1.
+    int localizedIndexOf(QXdgKeyAtom baseKey, const QXdgLocaleChain &chain) const {
+        QHash<QXdgKeyAtom, QXdgDesktopEntryVariantGroup>::const_iterator it = variants.constFind(baseKey);
+        if (it == variants.constEnd()) {
+            return indexOf(baseKey);
+        }
+
+        const quint64 resolution = it->resolution.loadAcquire();
+        if (int(resolution >> 32) == chain.serial) {
+            return int(quint32(resolution)) - 1;
+        }
+
+        int best = -1;
+        int bestRank = chain.locales.count();
+        for (int pos = it->first; pos != -1; pos = values[pos].nextVariant) {
+            const int rank = chain.rank(values[pos].locale);
+            if (rank != -1 && rank < bestRank) {
+                best = pos;
+                bestRank = rank;
+            }
+        }
+        // Racing readers all find the same position, whoever stores last wins.
+        it->resolution.storeRelease(QXdgDesktopEntryVariantGroup::packResolution(chain.serial, best));
+        return best;
+    }
+
+    void append(const QXdgDesktopEntryValue &value) {
+        values.append(value);
+        linkVariant(values.count() - 1);
+
+        if (values.count() <= LinearScanLimit) return;
+        if (valueIndex.count() < values.count() * 2) {
+            rebuildIndex();
+            return;
+        }
+
+        const uint mask = uint(valueIndex.count() - 1);
+        uint slot = QXdgKeyAtomTable::hash(value.key) & mask;
+        while (valueIndex[slot] != -1) {
+            slot = (slot + 1) & mask;
+        }
+        valueIndex[slot] = values.count() - 1;
+    }
+
+    // Adds a newly appended value to the variant chain of its base key.
+    void linkVariant(int pos) {
+        QXdgDesktopEntryValue &value = values[pos];
+        value.nextVariant = -1;
+
+        QHash<QXdgKeyAtom, QXdgDesktopEntryVariantGroup>::iterator it = variants.find(value.baseKey);
+        if (it == variants.end()) {
+            if (value.locale == QXdgKeyAtomTable::InvalidAtom) return;
+
+            // The first translation of the key, the value without locale (if any) joins the chain now.
+            QXdgDesktopEntryVariantGroup group;
+            const int untranslated = indexOf(value.baseKey);
+            if (untranslated != -1) {
+                values[untranslated].nextVariant = -1;
+                group.first = untranslated;
+            }
+            it = variants.insert(value.baseKey, group);
+        }
+
+        value.nextVariant = it->first;
+        it->first = pos;
+        it->resolution.store(0);
+    }
+
+    void rebuildVariants() {
+        variants.clear();
+
+        // Translations first, so every group exists before the values without locale are linked.
+        for (int i = 0; i < values.count(); i++) {
+            values[i].nextVariant = -1;
+            if (values[i].locale != QXdgKeyAtomTable::InvalidAtom) {
+                QXdgDesktopEntryVariantGroup &group = variants[values[i].baseKey];
+                values[i].nextVariant = group.first;
+                group.first = i;
+            }
+        }
+        for (int i = 0; i < values.count(); i++) {
+            if (values[i].locale == QXdgKeyAtomTable::InvalidAtom) {
+                QHash<QXdgKeyAtom, QXdgDesktopEntryVariantGroup>::iterator it = variants.find(values[i].key);
+                if (it != variants.end()) {
+                    values[i].nextVariant = it->first;
+                    it->first = i;
+                }
+            }
+        }
+    }
+
+    void rebuildIndex() {
+        valueIndex.clear();
+        if (values.count() <= LinearScanLimit) return;
+
+        int size = LinearScanLimit * 4;
+        while (size < values.count() * 2) {
+            size <<= 1;
+        }
+        valueIndex.fill(-1, size);
+
+        const uint mask = uint(size - 1);
+        for (int i = 0; i < values.count(); i++) {
+            uint slot = QXdgKeyAtomTable::hash(values[i].key) & mask;
+            while (valueIndex[slot] != -1) {
+                slot = (slot + 1) & mask;
+            }
+            valueIndex[slot] = i;
+        }
+    }
+
+    bool contains(const QString &key) const {
+        return indexOf(key) != -1;
+    }
+
+    // Sorted, the same as what we returned when the values were stored in a QMap.
+    QStringList allKeys() const {
+        QStringList keys;
+        keys.reserve(values.count());
+        for (const QXdgDesktopEntryValue &value : values) {
+            keys.append(QXdgKeyAtomTable::nameRef(value.key));
+        }
+        keys.sort();
+        return keys;
+    }
+
+    QString get(const QByteArray &data, const QString &key, const QString &defaultValue) const {
+        int pos = indexOf(key);
+        if (pos != -1) {
+            return values[pos].toString(data);
+        } else {
+            return defaultValue;
+        }
+    }
+
+    bool set(const QString &key, const QString &value) {
+        const QByteArray utf8Key = key.toUtf8();
+        QXdgDesktopEntryValue newValue;
+        newValue.setKey(utf8Key.constData(), utf8Key.size());
+        int pos = indexOf(newValue.key);
+        if (pos == -1) {
+            newValue.modifiedValue = value;
+            append(newValue);
+        } else {
+            values[pos].setModifiedValue(value);
+        }
+        modified = true;
+        return true;
+    }
+
+    bool remove(const QString &key) {
+        int pos = indexOf(key);
+        if (pos == -1) {
+            return false;
+        }
+
+        // positions after the removed one are shifted, so the indexes need to be rebuilt.
+        values.remove(pos);
+        rebuildIndex();
+        rebuildVariants();
+        modified = true;
+        return true;
+    }
+};
+
+// Type of the keys defined by the spec, localized keys have the type of their base key.
+QXdgDesktopEntry::ValueType qxdgWellKnownKeyType(QXdgKeyAtom key);
+
+class QXdgDesktopEntryPrivate : public QSharedData
+{
+public:
+    QXdgDesktopEntryPrivate() = default;
+    QXdgDesktopEntryPrivate(const QString &filePath, QXdgDesktopEntry::LoadOptions options);
+    QXdgDesktopEntryPrivate(const QXdgDesktopEntryPrivate &other);
+    ~QXdgDesktopEntryPrivate();
+
+    bool fuzzyLoad();
+    bool loadDevice(QIODevice &device);
+    bool loadData();
+    bool initSectionsFromData();
+    void compactData();
+    void freeze();
+    void parseSection(QXdgDesktopEntrySection &section) const;
+    void account(quint64 bytes) const;
+    void accountLoaded() const;
+    bool checkWritable(const char *function) const;
+    void setStatus(const QXdgDesktopEntry::Status &newStatus) const;
+    bool write(QIODevice &device) const;
+    QByteArray serialize() const;
+    bool isModified() const;
+    void markSaved() const {
+        savedModifications.storeRelease(modifications);
+    }
+
+    QStringList allGroups(bool sorted) const;
+    bool appendSection(const QXdgDesktopEntrySection &section);
+    const QXdgDesktopEntrySection *findSection(const QString &sectionName) const;
+
+    QXdgDesktopEntrySection *parsedSection(const QString &sectionName) const;
+    int sectionPos(const QString &sectionName) const;
+    bool contains(const QString &sectionName, const QString &key) const;
+    QStringList keys(const QString &sectionName) const;
+    const QXdgDesktopEntryValue *value(const QString &sectionName, const QString &key) const;
+    bool get(const QString &sectionName, const QString &key, QString *value) const;
+    bool getLocalized(const QString &sectionName, const QString &key, const QXdgLocaleChain &chain, QString *value) const;
+    bool set(const QString &sectionName, const QString &key, const QString &value);
+    bool remove(const QString &sectionName, const QString &key);
+    QXdgDesktopEntryExec parseExec(const QString &sectionName) const;
+
+protected:
+    QString filePath;
+    QXdgDesktopEntry::LoadOptions loadOptions;
+    // Only these groups get loaded, if not empty.
+    QStringList loadGroups;
+    // Some content of the file was skipped while loading, saving it would lose that.
+    bool partial = false;
+    // Either the content read from the file, or a raw view of the mapped file if QXdgDesktopEntry::MapFile
+    // is used. Unparsed sections and unmodified values are only offsets into it.
+    QByteArray data;
+    QSharedPointer<QXdgDesktopEntryMapping> mapping;
+    // Const functions may be called from several threads at once. Sections are parsed lazily under this mutex
+    // and then published through QXdgDesktopEntrySection::parsed, later readers don't lock at all. Writers
+    // hold it while they change the sections, and detaching a copy holds the one of the copied entry.
+    mutable QMutex mutex;
+    // Sections in the order of the file, new ones are appended. sectionIndex maps names to their positions,
+    // duplicated groups are only in the vector.
+    QVector<QXdgDesktopEntrySection> sections;
+    QHash<QString, int> sectionIndex;
+    // Parsed Exec keys by section, see QXdgDesktopEntry::exec(). Guarded by the mutex, unless the entry is
+    // frozen: freeze() fills it for every section, and nothing changes it afterwards.
+    mutable QHash<QString, QXdgDesktopEntryExec> execCache;
+    // Every section is parsed, and the entry can't be modified anymore.
+    bool frozen = false;
+    mutable QAtomicInt status = QXdgDesktopEntry::NoError;
+    // Counts set and remove calls, the file has what the entry had when the count was savedModifications.
+    // Saving a copy of the entry also saves the entry itself if they are still shared, hence mutable.
+    int modifications = 0;
+    mutable QAtomicInt savedModifications;
+    // Memory of this entry which is in QXdgStats::liveEntryBytes, see account(). Copies start from zero.
+    mutable QAtomicInteger<quint64> accountedBytes;
+
+private:
+    friend class QXdgDesktopEntry;
+    friend class QXdgDesktopEntryCache;
+    friend class QXdgDesktopEntryTransaction;
+};
+
+#endif // QXDGDESKTOPENTRY_P_H
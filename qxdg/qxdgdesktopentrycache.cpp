@@ -0,0 +1,640 @@
+/*
+ * Copyright (C) 2019 Deepin Technology Co., Ltd.
+ *               2019 Gary Wang
+ *
+ * Author:     Gary Wang <wzc782970009@gmail.com>
+ *
+ * Maintainer: Gary Wang <wzc782970009@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "qxdgdesktopentrycache_p.h"
+#include "qxdgdesktopentry_p.h"
+#include "qxdgstandardpath.h"
+
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QSet>
+
+#include <algorithm>
+
+#include <sys/stat.h>
+
+namespace {
+
+// 2: the sections of a file are stored in file order.
+// 3: the size and modification time of each file are stored.
+enum { CacheVersion = 3 };
+
+const char cacheMagic[8] = { 'Q', 'X', 'D', 'G', 'D', 'E', 'C', '\0' };
+const quint32 byteOrderMark = 0x01020304;
+// A directory modified this close before the cache was built may get modified again without any change of
+// its modification time, on file systems with a coarse timestamp resolution.
+const qint64 racyWindow = 2000;
+
+// A stamp this close before the build time may have been followed by another change within the same tick.
+inline bool isRacy(qint64 stamp, qint64 buildTime)
+{
+    return stamp != -1 && stamp >= buildTime - racyWindow && stamp <= buildTime;
+}
+
+// Whether the file at \a path still has the cached content.
+bool hasContent(const QString &path, const char *data, quint32 length)
+{
+    QFile file(path);
+    return file.open(QIODevice::ReadOnly) && file.readAll() == QByteArray::fromRawData(data, int(length));
+}
+
+// All offsets are relative to the start of the cache file, except the ones inside of an entry data.
+struct CacheHeader
+{
+    char magic[8];
+    quint32 version;
+    quint32 byteOrder;
+    qint64 buildTime;
+    quint32 fileSize;
+    quint32 directoryCount;
+    quint32 directoryOffset;
+    quint32 reserved;
+};
+
+struct DirectoryRecord
+{
+    quint32 pathOffset;
+    quint32 pathLength;
+    quint32 stampCount;
+    quint32 stampOffset;
+    quint64 contentHash;
+    quint32 fileCount;
+    quint32 fileOffset;
+};
+
+struct StampRecord
+{
+    quint32 pathOffset;
+    quint32 pathLength;
+    qint64 modificationTime;
+};
+
+struct FileRecord
+{
+    quint32 pathOffset;
+    quint32 pathLength;
+    quint32 dataOffset;
+    quint32 dataLength;
+    quint32 sectionCount;
+    quint32 sectionOffset;
+    quint32 status;
+    quint32 reserved;
+    qint64 size;
+    qint64 modificationTime;
+};
+
+struct SectionRecord
+{
+    quint32 nameOffset;
+    quint32 nameLength;
+    quint32 dataStart;
+    quint32 dataLength;
+    quint32 sectionPos;
+    quint32 valueCount;
+    quint32 valueOffset;
+    quint32 reserved;
+};
+
+Q_STATIC_ASSERT(sizeof(CacheHeader) == 40);
+Q_STATIC_ASSERT(sizeof(DirectoryRecord) == 32);
+Q_STATIC_ASSERT(sizeof(StampRecord) == 16);
+Q_STATIC_ASSERT(sizeof(FileRecord) == 48);
+Q_STATIC_ASSERT(sizeof(SectionRecord) == 32);
+Q_STATIC_ASSERT(sizeof(QXdgDesktopEntryCachedValue) == 16);
+
+// FNV-1a
+class Hasher
+{
+public:
+    void add(const void *data, size_t length) {
+        const uchar *bytes = static_cast<const uchar *>(data);
+        for (size_t i = 0; i < length; i++) {
+            hash ^= bytes[i];
+            hash *= Q_UINT64_C(1099511628211);
+        }
+    }
+
+    quint64 hash = Q_UINT64_C(14695981039346656037);
+};
+
+class CacheWriter
+{
+public:
+    // Space for records, aligned so they can be read in place from the mapping.
+    quint32 allocate(size_t size) {
+        const int offset = (out.size() + 7) & ~7;
+        const int oldSize = out.size();
+        out.resize(offset + int(size));
+        memset(out.data() + oldSize, 0, size_t(out.size() - oldSize));
+        return quint32(offset);
+    }
+
+    quint32 appendBytes(const QByteArray &bytes) {
+        const quint32 offset = quint32(out.size());
+        out.append(bytes);
+        return offset;
+    }
+
+    // Keys and section names are shared by many entries, store each of them once.
+    quint32 appendString(const QByteArray &utf8) {
+        QHash<QByteArray, quint32>::const_iterator it = strings.constFind(utf8);
+        if (it != strings.constEnd()) {
+            return it.value();
+        }
+        const quint32 offset = appendBytes(utf8);
+        strings.insert(utf8, offset);
+        return offset;
+    }
+
+    template <typename T>
+    void put(quint32 offset, const T &record) {
+        memcpy(out.data() + offset, &record, sizeof(T));
+    }
+
+    QByteArray out;
+    QHash<QByteArray, quint32> strings;
+};
+
+} // namespace
+
+QXdgDesktopEntryCache::QXdgDesktopEntryCache(const QString &cacheFilePath)
+    : filePath(cacheFilePath)
+{
+
+}
+
+QXdgDesktopEntryCache::~QXdgDesktopEntryCache()
+{
+
+}
+
+/*!
+ * \internal
+ * \brief Map the cache file, return false if it doesn't exist or is not usable.
+ */
+bool QXdgDesktopEntryCache::open()
+{
+    mapping.reset(new QXdgDesktopEntryMapping(filePath));
+    if (!mapping->map()) {
+        mapping.reset();
+        return false;
+    }
+
+    cacheData = mapping->data.constData();
+    cacheSize = quint32(mapping->data.size());
+
+    const CacheHeader *header = records<CacheHeader>(0, 1);
+    if (!header || memcmp(header->magic, cacheMagic, sizeof(cacheMagic)) != 0 || header->version != CacheVersion
+            || header->byteOrder != byteOrderMark || header->fileSize != cacheSize
+            || !records<DirectoryRecord>(header->directoryOffset, header->directoryCount)) {
+        mapping.reset();
+        cacheData = nullptr;
+        cacheSize = 0;
+        return false;
+    }
+
+    return true;
+}
+
+QString QXdgDesktopEntryCache::cacheFilePath() const
+{
+    return filePath;
+}
+
+// Returns the \a count records at \a offset, or nullptr if they are not entirely inside the cache.
+template <typename T>
+const T *QXdgDesktopEntryCache::records(quint32 offset, quint32 count) const
+{
+    if (offset % alignof(T) != 0 || offset > cacheSize || count > (cacheSize - offset) / sizeof(T)) {
+        return nullptr;
+    }
+    return reinterpret_cast<const T *>(cacheData + offset);
+}
+
+QString QXdgDesktopEntryCache::string(quint32 offset, quint32 length) const
+{
+    if (offset > cacheSize || length > cacheSize - offset) {
+        return QString();
+    }
+    return QString::fromUtf8(cacheData + offset, int(length));
+}
+
+int QXdgDesktopEntryCache::directoryIndex(const QString &path) const
+{
+    if (!mapping) return -1;
+
+    const CacheHeader *header = records<CacheHeader>(0, 1);
+    const DirectoryRecord *directories = records<DirectoryRecord>(header->directoryOffset, header->directoryCount);
+    for (quint32 i = 0; i < header->directoryCount; i++) {
+        if (string(directories[i].pathOffset, directories[i].pathLength) == path) {
+            return int(i);
+        }
+    }
+
+    return -1;
+}
+
+/*!
+ * \internal
+ * \brief Returns whether the cached content of the directory is still the same as the one on disk.
+ */
+bool QXdgDesktopEntryCache::isDirectoryValid(int directoryIndex) const
+{
+    const CacheHeader *header = records<CacheHeader>(0, 1);
+    const DirectoryRecord &directory = records<DirectoryRecord>(header->directoryOffset, header->directoryCount)[directoryIndex];
+    const StampRecord *stamps = records<StampRecord>(directory.stampOffset, directory.stampCount);
+    if (!stamps) return false;
+
+    const QString path = string(directory.pathOffset, directory.pathLength);
+    bool racy = false;
+    for (quint32 i = 0; i < directory.stampCount; i++) {
+        const QString relativePath = string(stamps[i].pathOffset, stamps[i].pathLength);
+        const qint64 stamp = stamps[i].modificationTime;
+        if (modificationTime(relativePath.isEmpty() ? path : path + QLatin1Char('/') + relativePath) != stamp) {
+            return false;
+        }
+        // Adding or removing a file sets the modification time to now, a stamp in the future is changed by it.
+        racy = racy || isRacy(stamp, header->buildTime);
+    }
+
+    // A file rewritten in place doesn't change the modification time of its directory.
+    const FileRecord *files = records<FileRecord>(directory.fileOffset, directory.fileCount);
+    if (!files) return false;
+    for (quint32 i = 0; i < directory.fileCount; i++) {
+        const QString filePath = path + QLatin1Char('/') + string(files[i].pathOffset, files[i].pathLength);
+        qint64 size;
+        qint64 stamp;
+        if (!fileStamp(filePath, &size, &stamp) || size != files[i].size || stamp != files[i].modificationTime
+                || isRacy(stamp, header->buildTime)) {
+            return false;
+        }
+        // Packages may be built with timestamps in the future and get updated without changing them, only the
+        // content tells then.
+        if (stamp > header->buildTime && !hasContent(filePath, cacheData + files[i].dataOffset, files[i].dataLength)) {
+            return false;
+        }
+    }
+
+    if (!racy) return true;
+
+    QVector<DirectoryStamp> directoryStamps;
+    QVector<FileStamp> fileStamps;
+    scanDirectory(path, &directoryStamps, &fileStamps);
+    return directoryStamps.count() == int(directory.stampCount) && contentHash(fileStamps) == directory.contentHash;
+}
+
+int QXdgDesktopEntryCache::fileCount(int directoryIndex) const
+{
+    const CacheHeader *header = records<CacheHeader>(0, 1);
+    const DirectoryRecord &directory = records<DirectoryRecord>(header->directoryOffset, header->directoryCount)[directoryIndex];
+    return records<FileRecord>(directory.fileOffset, directory.fileCount) ? int(directory.fileCount) : 0;
+}
+
+QString QXdgDesktopEntryCache::relativeFilePath(int directoryIndex, int fileIndex) const
+{
+    const CacheHeader *header = records<CacheHeader>(0, 1);
+    const DirectoryRecord &directory = records<DirectoryRecord>(header->directoryOffset, header->directoryCount)[directoryIndex];
+    const FileRecord &file = records<FileRecord>(directory.fileOffset, directory.fileCount)[fileIndex];
+    return string(file.pathOffset, file.pathLength);
+}
+
+/*!
+ * \internal
+ * \brief Create the entry for a cached file, with its data pointing into the cache mapping.
+ *
+ * Returns false and leaves \a entry untouched if the records of the file are damaged.
+ */
+bool QXdgDesktopEntryCache::createEntry(int directoryIndex, int fileIndex, const QString &filePath,
+                                        QXdgDesktopEntry::LoadOptions options, QXdgDesktopEntry *entry) const
+{
+    const CacheHeader *header = records<CacheHeader>(0, 1);
+    const DirectoryRecord &directory = records<DirectoryRecord>(header->directoryOffset, header->directoryCount)[directoryIndex];
+    const FileRecord &file = records<FileRecord>(directory.fileOffset, directory.fileCount)[fileIndex];
+    const SectionRecord *sections = records<SectionRecord>(file.sectionOffset, file.sectionCount);
+    if (!sections || file.dataOffset > cacheSize || file.dataLength > cacheSize - file.dataOffset) {
+        return false;
+    }
+
+    QScopedPointer<QXdgDesktopEntryPrivate> d(new QXdgDesktopEntryPrivate(filePath, options));
+    d->mapping = mapping;
+    d->data = QByteArray::fromRawData(cacheData + file.dataOffset, int(file.dataLength));
+    d->status.store(int(file.status));
+
+    for (quint32 i = 0; i < file.sectionCount; i++) {
+        const SectionRecord &sectionRecord = sections[i];
+        const QXdgDesktopEntryCachedValue *values = records<QXdgDesktopEntryCachedValue>(sectionRecord.valueOffset,
+                                                                                          sectionRecord.valueCount);
+        if (!values || sectionRecord.dataStart > file.dataLength
+                || sectionRecord.dataLength > file.dataLength - sectionRecord.dataStart) {
+            return false;
+        }
+        for (quint32 j = 0; j < sectionRecord.valueCount; j++) {
+            if (values[j].keyOffset > cacheSize || values[j].keyLength > cacheSize - values[j].keyOffset
+                    || values[j].valueStart > file.dataLength
+                    || values[j].valueLength > file.dataLength - values[j].valueStart) {
+                return false;
+            }
+        }
+
+        QXdgDesktopEntrySection section;
+        section.name = string(sectionRecord.nameOffset, sectionRecord.nameLength);
+        section.dataStart = int(sectionRecord.dataStart);
+        section.dataLength = int(sectionRecord.dataLength);
+        section.parsed.store(0);
+        section.sectionPos = int(sectionRecord.sectionPos);
+        section.cacheData = cacheData;
+        section.cachedValues = values;
+        section.cachedValueCount = int(sectionRecord.valueCount);
+        d->appendSection(section);
+    }
+
+    // The cache has every group, drop what the partial load options skip.
+    if ((options & (QXdgDesktopEntry::FirstGroupOnly | QXdgDesktopEntry::PeekOnly)) && !d->sections.isEmpty()) {
+        QXdgDesktopEntrySection firstSection = d->sections.first();
+        firstSection.peekOnly = options & QXdgDesktopEntry::PeekOnly;
+        d->partial = d->sections.count() > 1 || firstSection.peekOnly;
+        d->sections.clear();
+        d->sectionIndex.clear();
+        d->appendSection(firstSection);
+    }
+
+    QXdgStatsPrivate::add(QXdgStatsPrivate::CacheHits);
+    QXdgStatsPrivate::add(QXdgStatsPrivate::SectionsDiscovered, quint64(d->sections.count()));
+    d->accountLoaded();
+    if (options & QXdgDesktopEntry::FreezeOnLoad) {
+        d->freeze();
+    }
+
+    *entry = QXdgDesktopEntry(*d.take());
+    return true;
+}
+
+/*!
+ * \internal
+ * \brief Create the entry of the file at \a filePath from its content \a data, read to build a new cache.
+ *
+ * The entry is the same as one which read the file itself, except that it's never memory-mapped.
+ */
+QXdgDesktopEntry QXdgDesktopEntryCache::entryFromFileData(const QString &filePath, const QByteArray &data,
+                                                          QXdgDesktopEntry::LoadOptions options)
+{
+    QXdgDesktopEntryPrivate *d = new QXdgDesktopEntryPrivate(filePath, options);
+    d->data = data;
+    QXdgStatsPrivate::add(QXdgStatsPrivate::FilesRead);
+    QXdgStatsPrivate::add(QXdgStatsPrivate::BytesRead, quint64(data.size()));
+    d->loadData();
+    if (options & QXdgDesktopEntry::FreezeOnLoad) {
+        d->freeze();
+    }
+    return QXdgDesktopEntry(*d);
+}
+
+/*!
+ * \internal
+ * \brief Returns the content of a cached directory, for writing it again to a new cache.
+ *
+ * The file data is not copied, so it's only valid as long as this cache exists.
+ */
+QXdgDesktopEntryCache::SourceDirectory QXdgDesktopEntryCache::sourceDirectory(int directoryIndex) const
+{
+    const CacheHeader *header = records<CacheHeader>(0, 1);
+    const DirectoryRecord &directory = records<DirectoryRecord>(header->directoryOffset, header->directoryCount)[directoryIndex];
+
+    SourceDirectory result;
+    result.path = string(directory.pathOffset, directory.pathLength);
+    result.contentHash = directory.contentHash;
+
+    if (const StampRecord *stamps = records<StampRecord>(directory.stampOffset, directory.stampCount)) {
+        for (quint32 i = 0; i < directory.stampCount; i++) {
+            result.directoryStamps.append({ string(stamps[i].pathOffset, stamps[i].pathLength), stamps[i].modificationTime });
+        }
+    }
+
+    if (const FileRecord *files = records<FileRecord>(directory.fileOffset, directory.fileCount)) {
+        for (quint32 i = 0; i < directory.fileCount; i++) {
+            if (files[i].dataOffset > cacheSize || files[i].dataLength > cacheSize - files[i].dataOffset) continue;
+            result.files.append({ string(files[i].pathOffset, files[i].pathLength), files[i].size, files[i].modificationTime });
+            result.fileData.append(QByteArray::fromRawData(cacheData + files[i].dataOffset, int(files[i].dataLength)));
+        }
+    }
+
+    return result;
+}
+
+/*!
+ * \internal
+ * \brief Write a new cache file with the given \a directories, replacing the existing one atomically.
+ *
+ * \a buildTime must be taken before the directories were checked or walked.
+ */
+bool QXdgDesktopEntryCache::write(const QString &cacheFilePath, const QVector<SourceDirectory> &directories,
+                                  qint64 buildTime)
+{
+    CacheWriter writer;
+
+    const quint32 headerOffset = writer.allocate(sizeof(CacheHeader));
+    const quint32 directoryOffset = writer.allocate(sizeof(DirectoryRecord) * size_t(directories.count()));
+
+    for (int i = 0; i < directories.count(); i++) {
+        const SourceDirectory &source = directories[i];
+
+        DirectoryRecord directory = {};
+        const QByteArray path = source.path.toUtf8();
+        directory.pathOffset = writer.appendString(path);
+        directory.pathLength = quint32(path.size());
+        directory.contentHash = source.contentHash;
+
+        directory.stampCount = quint32(source.directoryStamps.count());
+        directory.stampOffset = writer.allocate(sizeof(StampRecord) * directory.stampCount);
+        for (int j = 0; j < source.directoryStamps.count(); j++) {
+            const QByteArray relativePath = source.directoryStamps[j].relativePath.toUtf8();
+            StampRecord stamp = {};
+            stamp.pathOffset = writer.appendString(relativePath);
+            stamp.pathLength = quint32(relativePath.size());
+            stamp.modificationTime = source.directoryStamps[j].modificationTime;
+            writer.put(directory.stampOffset + quint32(j * sizeof(StampRecord)), stamp);
+        }
+
+        directory.fileCount = quint32(source.fileData.count());
+        directory.fileOffset = writer.allocate(sizeof(FileRecord) * directory.fileCount);
+        for (int j = 0; j < source.fileData.count(); j++) {
+            const QByteArray relativePath = source.files[j].relativePath.toUtf8();
+            FileRecord file = {};
+            file.pathOffset = writer.appendString(relativePath);
+            file.pathLength = quint32(relativePath.size());
+            file.size = source.files[j].size;
+            file.modificationTime = source.files[j].modificationTime;
+            file.dataOffset = writer.appendBytes(source.fileData[j]);
+            file.dataLength = quint32(source.fileData[j].size());
+
+            // Parse it the same way a QXdgDesktopEntry would.
+            QXdgDesktopEntryPrivate parser(QString(), QXdgDesktopEntry::DefaultLoad);
+            parser.data = source.fileData[j];
+            if (!parser.data.isEmpty() && !parser.initSectionsFromData()) {
+                file.status = QXdgDesktopEntry::FormatError;
+            }
+
+            file.sectionCount = quint32(parser.sections.count());
+            file.sectionOffset = writer.allocate(sizeof(SectionRecord) * file.sectionCount);
+            quint32 sectionIndex = 0;
+            for (QXdgDesktopEntrySection &section : parser.sections) {
+                SectionRecord sectionRecord = {};
+                const QByteArray name = section.name.toUtf8();
+                sectionRecord.nameOffset = writer.appendString(name);
+                sectionRecord.nameLength = quint32(name.size());
+                sectionRecord.dataStart = quint32(section.dataStart);
+                sectionRecord.dataLength = quint32(section.dataLength);
+                sectionRecord.sectionPos = quint32(section.sectionPos);
+
+                section.ensureSectionDataParsed(parser.data);
+                sectionRecord.valueCount = quint32(section.values.count());
+                sectionRecord.valueOffset = writer.allocate(sizeof(QXdgDesktopEntryCachedValue) * sectionRecord.valueCount);
+                for (int k = 0; k < section.values.count(); k++) {
+                    const QXdgDesktopEntryValue &value = section.values[k];
+                    const QByteArray key = QXdgKeyAtomTable::nameRef(value.key).toUtf8();
+                    QXdgDesktopEntryCachedValue cachedValue = {};
+                    cachedValue.keyOffset = writer.appendString(key);
+                    cachedValue.keyLength = quint32(key.size());
+                    cachedValue.valueStart = quint32(value.start);
+                    cachedValue.valueLength = quint32(value.length);
+                    writer.put(sectionRecord.valueOffset + quint32(k * sizeof(QXdgDesktopEntryCachedValue)), cachedValue);
+                }
+
+                writer.put(file.sectionOffset + sectionIndex * quint32(sizeof(SectionRecord)), sectionRecord);
+                sectionIndex++;
+            }
+
+            writer.put(directory.fileOffset + quint32(j * sizeof(FileRecord)), file);
+        }
+
+        writer.put(directoryOffset + quint32(i * sizeof(DirectoryRecord)), directory);
+    }
+
+    CacheHeader header = {};
+    memcpy(header.magic, cacheMagic, sizeof(cacheMagic));
+    header.version = CacheVersion;
+    header.byteOrder = byteOrderMark;
+    header.buildTime = buildTime;
+    header.fileSize = quint32(writer.out.size());
+    header.directoryCount = quint32(directories.count());
+    header.directoryOffset = directoryOffset;
+    writer.put(headerOffset, header);
+
+    if (!QDir().mkpath(QFileInfo(cacheFilePath).absolutePath())) {
+        return false;
+    }
+
+    QSaveFile file(cacheFilePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    file.write(writer.out);
+    return file.commit();
+}
+
+/*!
+ * \internal
+ * \brief Returns the cache file used for the given list of \a directories, under XDG_CACHE_HOME.
+ */
+QString QXdgDesktopEntryCache::defaultCacheFilePath(const QStringList &directories)
+{
+    Hasher hasher;
+    for (const QString &directory : directories) {
+        const QByteArray path = directory.toUtf8();
+        hasher.add(path.constData(), size_t(path.size()) + 1);
+    }
+
+    const QString cacheHome = QXdgStandardPath::standardLocations(QXdgStandardPath::XdgCacheHomeLocation).value(0);
+    return QStringLiteral("%1/qxdg/desktop-entries-%2.cache").arg(cacheHome).arg(hasher.hash, 16, 16, QLatin1Char('0'));
+}
+
+// In milliseconds since epoch, -1 if \a path doesn't exist.
+qint64 QXdgDesktopEntryCache::modificationTime(const QString &path)
+{
+    qint64 size;
+    qint64 modificationTime;
+    return fileStamp(path, &size, &modificationTime) ? modificationTime : -1;
+}
+
+// The size and modification time of \a path with a single stat(), without building a QFileInfo and a QDateTime.
+// The time is in milliseconds since epoch, like QFileInfo::lastModified().
+bool QXdgDesktopEntryCache::fileStamp(const QString &path, qint64 *size, qint64 *modificationTime)
+{
+    struct stat status;
+    if (stat(QFile::encodeName(path).constData(), &status) != 0) {
+        return false;
+    }
+    *size = qint64(status.st_size);
+    *modificationTime = qint64(status.st_mtim.tv_sec) * 1000 + status.st_mtim.tv_nsec / 1000000;
+    return true;
+}
+
+quint64 QXdgDesktopEntryCache::contentHash(QVector<FileStamp> files)
+{
+    std::sort(files.begin(), files.end(), [](const FileStamp &a, const FileStamp &b) {
+        return a.relativePath < b.relativePath;
+    });
+
+    Hasher hasher;
+    for (const FileStamp &file : files) {
+        const QByteArray relativePath = file.relativePath.toUtf8();
+        hasher.add(relativePath.constData(), size_t(relativePath.size()) + 1);
+        hasher.add(&file.size, sizeof(file.size));
+        hasher.add(&file.modificationTime, sizeof(file.modificationTime));
+    }
+    return hasher.hash;
+}
+
+/*!
+ * \internal
+ * \brief Collect the stamps of every directory and desktop file below \a path.
+ *
+ * This visits the same directories and files as QXdgDesktopEntryCollection::load() does, one after another.
+ */
+void QXdgDesktopEntryCache::scanDirectory(const QString &path, QVector<DirectoryStamp> *directoryStamps,
+                                          QVector<FileStamp> *files)
+{
+    QSet<QString> visitedDirs;
+    QStringList pendingDirs { QString() };
+
+    while (!pendingDirs.isEmpty()) {
+        const QString relativeDir = pendingDirs.takeLast();
+        const QDir dir(relativeDir.isEmpty() ? path : path + QLatin1Char('/') + relativeDir);
+        const QString canonicalPath = dir.canonicalPath();
+        if (visitedDirs.contains(canonicalPath)) continue;
+        visitedDirs.insert(canonicalPath);
+
+        directoryStamps->append({ relativeDir, modificationTime(dir.path()) });
+
+        const QString prefix = relativeDir.isEmpty() ? QString() : relativeDir + QLatin1Char('/');
+        for (const QFileInfo &fileInfo : dir.entryInfoList(QDir::Dirs | QDir::Files | QDir::NoDotAndDotDot)) {
+            if (fileInfo.isDir()) {
+                pendingDirs.append(prefix + fileInfo.fileName());
+            } else if (fileInfo.fileName().endsWith(QLatin1String(".desktop"))) {
+                files->append({ prefix + fileInfo.fileName(), fileInfo.size(), fileInfo.lastModified().toMSecsSinceEpoch() });
+            }
+        }
+    }
+}
@@ -0,0 +1,118 @@
+/*
+ * Copyright (C) 2019 Deepin Technology Co., Ltd.
+ *               2019 Gary Wang
+ *
+ * Author:     Gary Wang <wzc782970009@gmail.com>
+ *
+ * Maintainer: Gary Wang <wzc782970009@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QXDGDESKTOPENTRYCACHE_P_H
+#define QXDGDESKTOPENTRYCACHE_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the QXdg API. It exists purely as an
+// implementation detail. This header file may change from version to
+// version without notice, or even be removed.
+//
+
+#include "qxdgdesktopentry.h"
+
+#include <QSharedPointer>
+#include <QStringList>
+#include <QVector>
+
+class QXdgDesktopEntryMapping;
+
+/*!
+ * \internal
+ * \brief Binary cache of the desktop entries found in a set of directories.
+ *
+ * The cache file holds, for every source directory, the content of each desktop file together with the offsets
+ * of its sections, keys and values, so entries can be created straight from the memory-mapped cache without
+ * touching the desktop files or tokenizing them again. A directory is valid as long as the modification time
+ * of each directory in its tree, and the size and modification time of each cached file, are the same as when
+ * the cache was built. The files are checked one by one since a file rewritten in place doesn't change the
+ * modification time of its directory. Directories modified too close to the build time can't be trusted by their
+ * modification time alone, so the hash of their listing is checked too, and files modified that close make the
+ * directory invalid. Files with a modification time after the build time are compared with their cached content.
+ *
+ * Checking a warm cache thus costs one stat() per directory and one per cached file, not only a few stat() calls
+ * for the roots: a file rewritten in place would be missed otherwise.
+ */
+class QXdgDesktopEntryCache
+{
+public:
+    struct DirectoryStamp {
+        QString relativePath;
+        qint64 modificationTime;
+    };
+
+    struct FileStamp {
+        QString relativePath;
+        qint64 size;
+        qint64 modificationTime;
+    };
+
+    // What a directory of the cache gets built from.
+    struct SourceDirectory {
+        QString path;
+        QVector<DirectoryStamp> directoryStamps;
+        quint64 contentHash = 0;
+        // The cached files, and their content in the same order.
+        QVector<FileStamp> files;
+        QVector<QByteArray> fileData;
+    };
+
+    explicit QXdgDesktopEntryCache(const QString &cacheFilePath);
+    ~QXdgDesktopEntryCache();
+
+    bool open();
+    QString cacheFilePath() const;
+
+    int directoryIndex(const QString &path) const;
+    bool isDirectoryValid(int directoryIndex) const;
+    int fileCount(int directoryIndex) const;
+    QString relativeFilePath(int directoryIndex, int fileIndex) const;
+    bool createEntry(int directoryIndex, int fileIndex, const QString &filePath,
+                     QXdgDesktopEntry::LoadOptions options, QXdgDesktopEntry *entry) const;
+    SourceDirectory sourceDirectory(int directoryIndex) const;
+
+    static QXdgDesktopEntry entryFromFileData(const QString &filePath, const QByteArray &data,
+                                              QXdgDesktopEntry::LoadOptions options);
+
+    static bool write(const QString &cacheFilePath, const QVector<SourceDirectory> &directories, qint64 buildTime);
+    static QString defaultCacheFilePath(const QStringList &directories);
+    static qint64 modificationTime(const QString &path);
+    static bool fileStamp(const QString &path, qint64 *size, qint64 *modificationTime);
+    static quint64 contentHash(QVector<FileStamp> files);
+    static void scanDirectory(const QString &path, QVector<DirectoryStamp> *directoryStamps, QVector<FileStamp> *files);
+
+private:
+    template <typename T>
+    const T *records(quint32 offset, quint32 count) const;
+    QString string(quint32 offset, quint32 length) const;
+
+    QString filePath;
+    QSharedPointer<QXdgDesktopEntryMapping> mapping;
+    const char *cacheData = nullptr;
+    quint32 cacheSize = 0;
+};
+
+#endif // QXDGDESKTOPENTRYCACHE_P_H
@@ -0,0 +1,639 @@
+/*
+ * Copyright (C) 2019 Deepin Technology Co., Ltd.
+ *               2019 Gary Wang
+ *
+ * Author:     Gary Wang <wzc782970009@gmail.com>
+ *
+ * Maintainer: Gary Wang <wzc782970009@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "qxdgdesktopentrycollection.h"
+#include "qxdgdesktopentrycollection_p.h"
+#include "qxdgdesktopentrycache_p.h"
+#include "qxdgstandardpath.h"
+
+#include <QAtomicInt>
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QHash>
+#include <QMutex>
+#include <QSet>
+#include <QThread>
+#include <QThreadPool>
+#include <QVector>
+
+#include <algorithm>
+
+namespace {
+
+// A desktop file found while walking the directories, not loaded yet.
+struct FoundDesktopFile
+{
+    int rootIndex;
+    QString relativePath;
+    QString filePath;
+    qint64 size;
+    qint64 modificationTime;
+    // Where to find the file in the cache, if it comes from there.
+    int cacheDirectory;
+    int cacheFile;
+};
+
+class DirectoryWalker
+{
+public:
+    DirectoryWalker(QThreadPool *pool, int rootCount) : pool(pool), directoryStamps(rootCount) {}
+
+    void walk(int rootIndex, const QString &root, const QString &relativeDir);
+
+    QThreadPool *pool;
+    QMutex mutex;
+    QVector<FoundDesktopFile> files;
+    // Of every walked directory, by root index. Only needed to build the cache.
+    QVector<QVector<QXdgDesktopEntryCache::DirectoryStamp>> directoryStamps;
+    // Canonical paths of the directories already walked, prefixed by their root index, so symlink loops
+    // are only walked once per root.
+    QSet<QString> visitedDirs;
+};
+
+class WalkTask : public QRunnable
+{
+public:
+    WalkTask(DirectoryWalker *walker, int rootIndex, const QString &root, const QString &relativeDir)
+        : walker(walker), rootIndex(rootIndex), root(root), relativeDir(relativeDir) {}
+
+    void run() override {
+        walker->walk(rootIndex, root, relativeDir);
+    }
+
+private:
+    DirectoryWalker *walker;
+    int rootIndex;
+    QString root;
+    QString relativeDir;
+};
+
+// Every subdirectory is listed by its own task, so big trees are spread over the whole pool.
+void DirectoryWalker::walk(int rootIndex, const QString &root, const QString &relativeDir)
+{
+    const QDir dir(relativeDir.isEmpty() ? root : root + QLatin1Char('/') + relativeDir);
+    const QString visitedKey = QString::number(rootIndex) + QLatin1Char(':') + dir.canonicalPath();
+    {
+        QMutexLocker locker(&mutex);
+        if (visitedDirs.contains(visitedKey)) return;
+        visitedDirs.insert(visitedKey);
+    }
+
+    // Taken before listing, so changes made while we list show up as a newer modification time.
+    const qint64 modificationTime = QXdgDesktopEntryCache::modificationTime(dir.path());
+
+    const QString prefix = relativeDir.isEmpty() ? QString() : relativeDir + QLatin1Char('/');
+    QVector<FoundDesktopFile> found;
+    for (const QFileInfo &fileInfo : dir.entryInfoList(QDir::Dirs | QDir::Files | QDir::NoDotAndDotDot)) {
+        if (fileInfo.isDir()) {
+            pool->start(new WalkTask(this, rootIndex, root, prefix + fileInfo.fileName()));
+        } else if (fileInfo.fileName().endsWith(QLatin1String(".desktop"))) {
+            found.append({ rootIndex, prefix + fileInfo.fileName(), fileInfo.filePath(), fileInfo.size(),
+                           fileInfo.lastModified().toMSecsSinceEpoch(), -1, -1 });
+        }
+    }
+
+    QMutexLocker locker(&mutex);
+    directoryStamps[rootIndex].append({ relativeDir, modificationTime });
+    files += found;
+}
+
+// The content of a walked file, kept when the cache gets built again so the file is only read once.
+struct ReadDesktopFile
+{
+    bool ok = false;
+    QByteArray data;
+};
+
+// Workers claim small chunks of the file list until it runs out, so a worker which got fast files
+// picks up the remaining work of the slow ones instead of idling.
+class ParseTask : public QRunnable
+{
+public:
+    enum { ChunkSize = 8 };
+
+    ParseTask(const QVector<FoundDesktopFile> &files, QXdgDesktopEntry *results, ReadDesktopFile *readFiles,
+              QAtomicInt *nextIndex, QXdgDesktopEntry::LoadOptions options, const QXdgDesktopEntryCache *cache)
+        : files(files), results(results), readFiles(readFiles), nextIndex(nextIndex), options(options), cache(cache) {}
+
+    void run() override {
+        for (;;) {
+            const int begin = nextIndex->fetchAndAddRelaxed(ChunkSize);
+            if (begin >= files.count()) return;
+
+            const int end = qMin(begin + int(ChunkSize), files.count());
+            for (int i = begin; i < end; i++) {
+                const FoundDesktopFile &file = files[i];
+                if (file.cacheFile != -1) {
+                    // a damaged cache record falls back to the file itself.
+                    if (!cache->createEntry(file.cacheDirectory, file.cacheFile, file.filePath, options, &results[i])) {
+                        results[i] = QXdgDesktopEntry(file.filePath, options);
+                    }
+                    continue;
+                }
+
+                // The new cache needs the content of the file, read it once for both.
+                if (readFiles) {
+                    QFile desktopFile(file.filePath);
+                    readFiles[i].ok = desktopFile.open(QIODevice::ReadOnly);
+                    if (readFiles[i].ok) {
+                        readFiles[i].data = desktopFile.readAll();
+                        results[i] = QXdgDesktopEntryCache::entryFromFileData(file.filePath, readFiles[i].data, options);
+                        continue;
+                    }
+                }
+                results[i] = QXdgDesktopEntry(file.filePath, options);
+            }
+        }
+    }
+
+private:
+    const QVector<FoundDesktopFile> &files;
+    QXdgDesktopEntry *results;
+    ReadDesktopFile *readFiles;
+    QAtomicInt *nextIndex;
+    QXdgDesktopEntry::LoadOptions options;
+    const QXdgDesktopEntryCache *cache;
+};
+
+// Cached directories are copied from the old cache, the others take the content ParseTask read from the walked
+// files. \a parsedIndex maps a walked file to its index in \a readFiles, or -1 if it was not parsed.
+static void writeCache(const QXdgDesktopEntryCache &cache, const QStringList &roots, const QVector<int> &cachedDirectories,
+                       const DirectoryWalker &walker, const QVector<int> &parsedIndex,
+                       const QVector<ReadDesktopFile> &readFiles, qint64 buildTime)
+{
+    QVector<QXdgDesktopEntryCache::SourceDirectory> sources;
+    for (int i = 0; i < roots.count(); i++) {
+        if (cachedDirectories[i] != -1) {
+            sources.append(cache.sourceDirectory(cachedDirectories[i]));
+            continue;
+        }
+
+        QXdgDesktopEntryCache::SourceDirectory source;
+        source.path = roots[i];
+        source.directoryStamps = walker.directoryStamps[i];
+
+        QVector<QXdgDesktopEntryCache::FileStamp> fileStamps;
+        for (int j = 0; j < walker.files.count(); j++) {
+            const FoundDesktopFile &file = walker.files[j];
+            if (file.rootIndex != i) continue;
+            fileStamps.append({ file.relativePath, file.size, file.modificationTime });
+
+            const int parsed = parsedIndex[j];
+            if (parsed != -1) {
+                if (readFiles[parsed].ok) {
+                    source.files.append(fileStamps.last());
+                    source.fileData.append(readFiles[parsed].data);
+                }
+                continue;
+            }
+
+            // hidden by a file with the same desktop file ID, so it was not read yet.
+            QFile desktopFile(file.filePath);
+            if (desktopFile.open(QIODevice::ReadOnly)) {
+                source.files.append(fileStamps.last());
+                source.fileData.append(desktopFile.readAll());
+            }
+        }
+        source.contentHash = QXdgDesktopEntryCache::contentHash(fileStamps);
+        sources.append(source);
+    }
+
+    QXdgDesktopEntryCache::write(cache.cacheFilePath(), sources, buildTime);
+}
+
+} // namespace
+
+static QString desktopFileIdOf(const QString &relativePath)
+{
+    QString desktopFileId = relativePath;
+    desktopFileId.replace(QLatin1Char('/'), QLatin1Char('-'));
+    return desktopFileId;
+}
+
+void QXdgDesktopEntryCollectionPrivate::clear()
+{
+    items.clear();
+    idIndex.clear();
+}
+
+const QXdgDesktopEntryCollectionItem *QXdgDesktopEntryCollectionPrivate::item(const QString &desktopFileId) const
+{
+    const int pos = idIndex.value(desktopFileId, -1);
+    return pos == -1 ? nullptr : &items[pos];
+}
+
+void QXdgDesktopEntryCollectionPrivate::rebuildIdIndex()
+{
+    idIndex.clear();
+    for (int i = 0; i < items.count(); i++) {
+        idIndex.insert(items[i].desktopFileId, i);
+    }
+}
+
+// Items are kept sorted by root index then relative path, which is the precedence order.
+void QXdgDesktopEntryCollectionPrivate::insertItem(const QXdgDesktopEntryCollectionItem &item)
+{
+    QVector<QXdgDesktopEntryCollectionItem>::iterator it = std::lower_bound(items.begin(), items.end(), item,
+            [](const QXdgDesktopEntryCollectionItem &a, const QXdgDesktopEntryCollectionItem &b) {
+        if (a.rootIndex != b.rootIndex) return a.rootIndex < b.rootIndex;
+        return a.relativePath < b.relativePath;
+    });
+    items.insert(it, item);
+    rebuildIdIndex();
+}
+
+// Returns false if the file doesn't exist or can't be read.
+bool QXdgDesktopEntryCollectionPrivate::loadFile(int rootIndex, const QString &relativePath, QXdgDesktopEntry *entry) const
+{
+    const QString filePath = roots[rootIndex] + QLatin1Char('/') + relativePath;
+    if (!QFileInfo(filePath).isFile()) {
+        return false;
+    }
+
+    QXdgDesktopEntry loadedEntry(filePath, loadOptions);
+    if (loadedEntry.status() == QXdgDesktopEntry::AccessError) {
+        return false;
+    }
+    *entry = std::move(loadedEntry);
+    return true;
+}
+
+/*!
+ * \internal
+ * \brief Load again the file at \a relativePath of the root directory \a rootIndex, after it changed on disk.
+ *
+ * The file may have been created, modified or removed. Only the entry with the desktop file ID of the file is
+ * affected: if the file is hidden by an entry of higher precedence nothing changes, and if the file was the
+ * visible one and is gone, the same path in the following root directories takes over.
+ *
+ * Sets \a desktopFileId to the ID of the file, and returns how the entry with this ID changed.
+ */
+QXdgDesktopEntryCollectionPrivate::Change QXdgDesktopEntryCollectionPrivate::reloadFile(int rootIndex,
+        const QString &relativePath, QString *desktopFileId)
+{
+    *desktopFileId = desktopFileIdOf(relativePath);
+    const int pos = idIndex.value(*desktopFileId, -1);
+
+    if (pos != -1) {
+        const QXdgDesktopEntryCollectionItem &current = items[pos];
+        if (current.rootIndex < rootIndex
+                || (current.rootIndex == rootIndex && current.relativePath < relativePath)) {
+            return NoChange;
+        }
+    }
+
+    const bool isCurrent = pos != -1 && items[pos].rootIndex == rootIndex && items[pos].relativePath == relativePath;
+    QXdgDesktopEntry entry;
+    if (loadFile(rootIndex, relativePath, &entry)) {
+        if (pos != -1) {
+            items.remove(pos);
+        }
+        const QString filePath = roots[rootIndex] + QLatin1Char('/') + relativePath;
+        insertItem({ *desktopFileId, filePath, entry, rootIndex, relativePath });
+        return pos == -1 ? Added : Changed;
+    }
+
+    if (!isCurrent) {
+        return NoChange;
+    }
+
+    // The visible file is gone, the same path in the following root directories takes over.
+    for (int i = rootIndex + 1; i < roots.count(); i++) {
+        if (loadFile(i, relativePath, &entry)) {
+            items.remove(pos);
+            insertItem({ *desktopFileId, roots[i] + QLatin1Char('/') + relativePath, entry, i, relativePath });
+            return Changed;
+        }
+    }
+
+    items.remove(pos);
+    rebuildIdIndex();
+    return Removed;
+}
+
+/*!
+ * \class QXdgDesktopEntryCollection
+ * \brief Loads all desktop entries of a set of directories at once.
+ *
+ * Directories are walked, and the desktop entries found in them are loaded, in parallel. Entries are
+ * identified by their desktop file ID as described by the spec: the path relative to the directory it
+ * was found in, with "/" replaced by "-". If several directories contain the same ID, the one from the
+ * directory listed first takes precedence and the others are ignored.
+ *
+ * For more details about the desktop file ID, please refer to:
+ * https://specifications.freedesktop.org/desktop-entry-spec/latest/ar01s02.html#desktop-file-id
+ */
+
+QXdgDesktopEntryCollection::QXdgDesktopEntryCollection()
+    : d_ptr(new QXdgDesktopEntryCollectionPrivate)
+{
+
+}
+
+QXdgDesktopEntryCollection::~QXdgDesktopEntryCollection()
+{
+
+}
+
+/*!
+ * \brief Returns the "applications" directories under XDG_DATA_HOME and XDG_DATA_DIRS, in precedence order.
+ */
+QStringList QXdgDesktopEntryCollection::applicationDirs()
+{
+    QStringList dataDirs = QXdgStandardPath::standardLocations(QXdgStandardPath::XdgDataHomeLocation);
+    dataDirs << QXdgStandardPath::standardLocations(QXdgStandardPath::XdgDataDirsLocation);
+
+    QStringList result;
+    for (const QString &dataDir : dataDirs) {
+        result << QDir::cleanPath(dataDir + QLatin1String("/applications"));
+    }
+    result.removeDuplicates();
+    return result;
+}
+
+/*!
+ * \brief Load every desktop entry of applicationDirs().
+ *
+ * \sa load()
+ */
+bool QXdgDesktopEntryCollection::loadApplications(QXdgDesktopEntry::LoadOptions options)
+{
+    return load(applicationDirs(), options);
+}
+
+/*!
+ * \brief Load every desktop entry in \a directories and their subdirectories, replacing the current content.
+ *
+ * \a directories are in precedence order, an entry in the first directory hides the entries with the same
+ * desktop file ID in the following ones. Missing directories are skipped. Each entry is constructed with
+ * \a options.
+ *
+ * \return false if some of the files couldn't be read, they are left out of the collection.
+ */
+bool QXdgDesktopEntryCollection::load(const QStringList &directories, QXdgDesktopEntry::LoadOptions options)
+{
+    Q_D(QXdgDesktopEntryCollection);
+
+    d->clear();
+
+    QStringList &roots = d->roots;
+    roots.clear();
+    for (const QString &directory : directories) {
+        roots << QDir::cleanPath(directory);
+    }
+    d->loadOptions = options;
+
+    // Directories still valid in the cache don't need to be walked at all.
+    const qint64 buildTime = QDateTime::currentMSecsSinceEpoch();
+    QScopedPointer<QXdgDesktopEntryCache> cache;
+    QVector<int> cachedDirectories(roots.count(), -1);
+    bool cacheStale = false;
+    if (d->cacheEnabled) {
+        const QString cacheFile = d->cacheFilePath.isEmpty() ? QXdgDesktopEntryCache::defaultCacheFilePath(roots)
+                                                             : d->cacheFilePath;
+        cache.reset(new QXdgDesktopEntryCache(cacheFile));
+        const bool cacheOpened = cache->open();
+        for (int i = 0; i < roots.count(); i++) {
+            const int directoryIndex = cacheOpened ? cache->directoryIndex(roots[i]) : -1;
+            if (directoryIndex != -1 && cache->isDirectoryValid(directoryIndex)) {
+                cachedDirectories[i] = directoryIndex;
+            } else {
+                cacheStale = true;
+            }
+        }
+    }
+
+    QThreadPool pool;
+    pool.setMaxThreadCount(qMax(1, d->maxThreadCount));
+
+    DirectoryWalker walker(&pool, roots.count());
+    for (int i = 0; i < roots.count(); i++) {
+        if (cachedDirectories[i] == -1) {
+            pool.start(new WalkTask(&walker, i, roots[i], QString()));
+        }
+    }
+    pool.waitForDone();
+
+    QVector<FoundDesktopFile> &files = walker.files;
+    for (int i = 0; i < roots.count(); i++) {
+        const int directoryIndex = cachedDirectories[i];
+        if (directoryIndex == -1) continue;
+        for (int j = 0; j < cache->fileCount(directoryIndex); j++) {
+            const QString relativePath = cache->relativeFilePath(directoryIndex, j);
+            files.append({ i, relativePath, roots[i] + QLatin1Char('/') + relativePath, 0, 0, directoryIndex, j });
+        }
+    }
+
+    // Walking order depends on scheduling, sort to get back to precedence order.
+    std::sort(files.begin(), files.end(), [](const FoundDesktopFile &a, const FoundDesktopFile &b) {
+        if (a.rootIndex != b.rootIndex) return a.rootIndex < b.rootIndex;
+        return a.relativePath < b.relativePath;
+    });
+
+    QVector<FoundDesktopFile> visibleFiles;
+    visibleFiles.reserve(files.count());
+    QVector<int> parsedIndex(files.count(), -1);
+    for (int i = 0; i < files.count(); i++) {
+        const FoundDesktopFile &file = files[i];
+        const QString desktopFileId = desktopFileIdOf(file.relativePath);
+        if (d->idIndex.contains(desktopFileId)) continue;
+
+        d->idIndex.insert(desktopFileId, d->items.count());
+        d->items.append({ desktopFileId, file.filePath, QXdgDesktopEntry(), file.rootIndex, file.relativePath });
+        parsedIndex[i] = visibleFiles.count();
+        visibleFiles.append(file);
+    }
+
+    QVector<QXdgDesktopEntry> results(visibleFiles.count());
+    QVector<ReadDesktopFile> readFiles(cacheStale ? visibleFiles.count() : 0);
+    QAtomicInt nextIndex(0);
+    const int workerCount = qMin(pool.maxThreadCount(), (visibleFiles.count() + ParseTask::ChunkSize - 1) / ParseTask::ChunkSize);
+    for (int i = 0; i < workerCount; i++) {
+        pool.start(new ParseTask(visibleFiles, results.data(), cacheStale ? readFiles.data() : nullptr, &nextIndex,
+                                 options, cache.data()));
+    }
+    pool.waitForDone();
+
+    if (cacheStale) {
+        writeCache(*cache, roots, cachedDirectories, walker, parsedIndex, readFiles, buildTime);
+    }
+
+    bool allLoaded = true;
+    QVector<QXdgDesktopEntryCollectionItem> loadedItems;
+    loadedItems.reserve(d->items.count());
+    for (int i = 0; i < d->items.count(); i++) {
+        if (results[i].status() == QXdgDesktopEntry::AccessError) {
+            allLoaded = false;
+            continue;
+        }
+        d->items[i].entry = results[i];
+        loadedItems.append(d->items[i]);
+    }
+
+    if (!allLoaded) {
+        d->items = loadedItems;
+        d->rebuildIdIndex();
+    }
+
+    return allLoaded;
+}
+
+/*!
+ * \brief Returns whether load() uses the binary cache, false by default.
+ *
+ * \sa setCacheEnabled()
+ */
+bool QXdgDesktopEntryCollection::isCacheEnabled() const
+{
+    Q_D(const QXdgDesktopEntryCollection);
+    return d->cacheEnabled;
+}
+
+/*!
+ * \brief Set whether load() uses the binary cache.
+ *
+ * The cache holds the content and the parsed structure of every desktop entry in the loaded directories, and
+ * is memory-mapped by the following loads, so they don't need to walk the directories nor read and parse the
+ * desktop files, only check the size and modification time of each of them: a load from the cache still costs
+ * one stat() per directory and per desktop file. Directories where a file was added, removed or modified since
+ * the cache was built are loaded the regular way, and the cache gets built again.
+ * Entries loaded from the cache share the mapping of the cache file.
+ *
+ * \sa setCacheFilePath()
+ */
+void QXdgDesktopEntryCollection::setCacheEnabled(bool enabled)
+{
+    Q_D(QXdgDesktopEntryCollection);
+    d->cacheEnabled = enabled;
+}
+
+/*!
+ * \brief Returns the path of the cache file set by setCacheFilePath().
+ *
+ * If it's empty, load() uses a file under XDG_CACHE_HOME named after the list of loaded directories.
+ */
+QString QXdgDesktopEntryCollection::cacheFilePath() const
+{
+    Q_D(const QXdgDesktopEntryCollection);
+    return d->cacheFilePath;
+}
+
+void QXdgDesktopEntryCollection::setCacheFilePath(const QString &cacheFilePath)
+{
+    Q_D(QXdgDesktopEntryCollection);
+    d->cacheFilePath = cacheFilePath;
+}
+
+/*!
+ * \brief Remove all the entries from the collection.
+ */
+void QXdgDesktopEntryCollection::clear()
+{
+    Q_D(QXdgDesktopEntryCollection);
+    d->clear();
+}
+
+/*!
+ * \brief Returns the maximum amount of threads used by load(), QThread::idealThreadCount() by default.
+ */
+int QXdgDesktopEntryCollection::maxThreadCount() const
+{
+    Q_D(const QXdgDesktopEntryCollection);
+    return d->maxThreadCount;
+}
+
+void QXdgDesktopEntryCollection::setMaxThreadCount(int maxThreadCount)
+{
+    Q_D(QXdgDesktopEntryCollection);
+    d->maxThreadCount = maxThreadCount;
+}
+
+int QXdgDesktopEntryCollection::count() const
+{
+    Q_D(const QXdgDesktopEntryCollection);
+    return d->items.count();
+}
+
+bool QXdgDesktopEntryCollection::isEmpty() const
+{
+    Q_D(const QXdgDesktopEntryCollection);
+    return d->items.isEmpty();
+}
+
+bool QXdgDesktopEntryCollection::contains(const QString &desktopFileId) const
+{
+    Q_D(const QXdgDesktopEntryCollection);
+    return d->idIndex.contains(desktopFileId);
+}
+
+/*!
+ * \brief Returns the desktop file IDs of all the entries in precedence order.
+ *
+ * Entries are ordered by the directory they come from, then by their path inside of it.
+ */
+QStringList QXdgDesktopEntryCollection::desktopFileIds() const
+{
+    Q_D(const QXdgDesktopEntryCollection);
+    QStringList result;
+    result.reserve(d->items.count());
+    for (const QXdgDesktopEntryCollectionItem &item : d->items) {
+        result.append(item.desktopFileId);
+    }
+    return result;
+}
+
+/*!
+ * \brief Returns the path of the file the entry with \a desktopFileId was loaded from.
+ */
+QString QXdgDesktopEntryCollection::filePath(const QString &desktopFileId) const
+{
+    Q_D(const QXdgDesktopEntryCollection);
+    const QXdgDesktopEntryCollectionItem *item = d->item(desktopFileId);
+    return item ? item->filePath : QString();
+}
+
+/*!
+ * \brief Returns the entry with \a desktopFileId, or an empty entry if there is no such entry.
+ *
+ * The returned entry shares its data with the one in the collection, modifying it doesn't change the collection.
+ */
+QXdgDesktopEntry QXdgDesktopEntryCollection::entry(const QString &desktopFileId) const
+{
+    Q_D(const QXdgDesktopEntryCollection);
+    const QXdgDesktopEntryCollectionItem *item = d->item(desktopFileId);
+    return item ? item->entry : QXdgDesktopEntry();
+}
+
+/*!
+ * \brief Returns all the entries, in the same order as desktopFileIds().
+ */
+QVector<QXdgDesktopEntry> QXdgDesktopEntryCollection::entries() const
+{
+    Q_D(const QXdgDesktopEntryCollection);
+    QVector<QXdgDesktopEntry> result;
+    result.reserve(d->items.count());
+    for (const QXdgDesktopEntryCollectionItem &item : d->items) {
+        result.append(item.entry);
+    }
+    return result;
+}
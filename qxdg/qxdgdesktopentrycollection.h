@@ -0,0 +1,69 @@
+/*
+ * Copyright (C) 2019 Deepin Technology Co., Ltd.
+ *               2019 Gary Wang
+ *
+ * Author:     Gary Wang <wzc782970009@gmail.com>
+ *
+ * Maintainer: Gary Wang <wzc782970009@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QXDGDESKTOPENTRYCOLLECTION_H
+#define QXDGDESKTOPENTRYCOLLECTION_H
+
+#include "qxdg_global.h"
+#include "qxdgdesktopentry.h"
+
+#include <QStringList>
+#include <QVector>
+
+class QXdgDesktopEntryCollectionPrivate;
+class QXDGSHARED_EXPORT QXdgDesktopEntryCollection
+{
+public:
+    QXdgDesktopEntryCollection();
+    ~QXdgDesktopEntryCollection();
+
+    static QStringList applicationDirs();
+
+    bool loadApplications(QXdgDesktopEntry::LoadOptions options = QXdgDesktopEntry::DefaultLoad);
+    bool load(const QStringList &directories, QXdgDesktopEntry::LoadOptions options = QXdgDesktopEntry::DefaultLoad);
+    void clear();
+
+    int maxThreadCount() const;
+    void setMaxThreadCount(int maxThreadCount);
+
+    bool isCacheEnabled() const;
+    void setCacheEnabled(bool enabled);
+    QString cacheFilePath() const;
+    void setCacheFilePath(const QString &cacheFilePath);
+
+    int count() const;
+    bool isEmpty() const;
+    bool contains(const QString &desktopFileId) const;
+    QStringList desktopFileIds() const;
+    QString filePath(const QString &desktopFileId) const;
+    QXdgDesktopEntry entry(const QString &desktopFileId) const;
+    QVector<QXdgDesktopEntry> entries() const;
+
+private:
+    QScopedPointer<QXdgDesktopEntryCollectionPrivate> d_ptr;
+
+    Q_DECLARE_PRIVATE(QXdgDesktopEntryCollection)
+    Q_DISABLE_COPY(QXdgDesktopEntryCollection)
+    friend class QXdgDesktopEntryWatcherPrivate;
+};
+
+#endif // QXDGDESKTOPENTRYCOLLECTION_H
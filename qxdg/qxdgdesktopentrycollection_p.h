@@ -0,0 +1,80 @@
+/*
+ * Copyright (C) 2019 Deepin Technology Co., Ltd.
+ *               2019 Gary Wang
+ *
+ * Author:     Gary Wang <wzc782970009@gmail.com>
+ *
+ * Maintainer: Gary Wang <wzc782970009@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QXDGDESKTOPENTRYCOLLECTION_P_H
+#define QXDGDESKTOPENTRYCOLLECTION_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the QXdg API. It exists purely as an
+// implementation detail. This header file may change from version to
+// version without notice, or even be removed.
+//
+
+#include "qxdgdesktopentrycollection.h"
+
+#include <QHash>
+#include <QThread>
+#include <QVector>
+
+/*! \internal */
+class QXdgDesktopEntryCollectionItem
+{
+public:
+    QString desktopFileId;
+    QString filePath;
+    QXdgDesktopEntry entry;
+    // Where the file was found, index of the root directory passed to load() and path relative to it.
+    int rootIndex;
+    QString relativePath;
+};
+
+class QXdgDesktopEntryCollectionPrivate
+{
+public:
+    enum Change {
+        NoChange,
+        Added,
+        Changed,
+        Removed
+    };
+
+    QVector<QXdgDesktopEntryCollectionItem> items;
+    QHash<QString, int> idIndex;
+    // The directories of the last load(), in precedence order.
+    QStringList roots;
+    QXdgDesktopEntry::LoadOptions loadOptions;
+    int maxThreadCount = QThread::idealThreadCount();
+    bool cacheEnabled = false;
+    QString cacheFilePath;
+
+    void clear();
+    const QXdgDesktopEntryCollectionItem *item(const QString &desktopFileId) const;
+    void rebuildIdIndex();
+    void insertItem(const QXdgDesktopEntryCollectionItem &item);
+    bool loadFile(int rootIndex, const QString &relativePath, QXdgDesktopEntry *entry) const;
+    Change reloadFile(int rootIndex, const QString &relativePath, QString *desktopFileId);
+};
+
+#endif // QXDGDESKTOPENTRYCOLLECTION_P_H
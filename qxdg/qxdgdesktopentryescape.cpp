@@ -0,0 +1,240 @@
+/*
+ * Copyright (C) 2019 Deepin Technology Co., Ltd.
+ *               2019 Gary Wang
+ *
+ * Author:     Gary Wang <wzc782970009@gmail.com>
+ *
+ * Maintainer: Gary Wang <wzc782970009@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "qxdgdesktopentryescape_p.h"
+
+// Expands to the 128 values of f(0) ... f(127), to fill the ASCII lookup tables at compile time.
+#define QXDG_TABLE_ROW(f, i) f(i), f(i + 1), f(i + 2), f(i + 3), f(i + 4), f(i + 5), f(i + 6), f(i + 7)
+#define QXDG_TABLE(f) \
+    QXDG_TABLE_ROW(f, 0), QXDG_TABLE_ROW(f, 8), QXDG_TABLE_ROW(f, 16), QXDG_TABLE_ROW(f, 24), \
+    QXDG_TABLE_ROW(f, 32), QXDG_TABLE_ROW(f, 40), QXDG_TABLE_ROW(f, 48), QXDG_TABLE_ROW(f, 56), \
+    QXDG_TABLE_ROW(f, 64), QXDG_TABLE_ROW(f, 72), QXDG_TABLE_ROW(f, 80), QXDG_TABLE_ROW(f, 88), \
+    QXDG_TABLE_ROW(f, 96), QXDG_TABLE_ROW(f, 104), QXDG_TABLE_ROW(f, 112), QXDG_TABLE_ROW(f, 120)
+
+// An escape rule is the number of backslashes to put before a char in the upper byte, and the char to put
+// after them in the lower one. Zero means the char is written as-is.
+static Q_DECL_CONSTEXPR ushort escapeRule(int backslashes, int ch)
+{
+    return ushort((backslashes << 8) | ch);
+}
+
+// The escape sequences \s, \n, \t, \r, and \\ are supported for values of type string and localestring.
+static Q_DECL_CONSTEXPR ushort stringEscapeRule(int ch)
+{
+    return ch == '\\' ? escapeRule(1, '\\')
+         : ch == '\n' ? escapeRule(1, 'n')
+         : ch == '\t' ? escapeRule(1, 't')
+         : ch == '\r' ? escapeRule(1, 'r')
+         : 0;
+}
+
+// The Exec quoting rule escapes with a backslash, and the string rule gets applied on top of that, so a quote
+// becomes \\" and a literal backslash takes four of them.
+static Q_DECL_CONSTEXPR ushort execEscapeRule(int ch)
+{
+    return ch == '\\' ? escapeRule(3, '\\')
+         : (ch == '"' || ch == '\'' || ch == '`' || ch == '$') ? escapeRule(2, ch)
+         : stringEscapeRule(ch);
+}
+
+// The char an escape sequence stands for, by the char following the backslash. Zero means the sequence is kept.
+static Q_DECL_CONSTEXPR uchar stringUnescapeRule(int ch)
+{
+    return ch == '\\' ? '\\'
+         : ch == 's' ? ' '
+         : ch == 'n' ? '\n'
+         : ch == 't' ? '\t'
+         : ch == 'r' ? '\r'
+         : 0;
+}
+
+static Q_DECL_CONSTEXPR uchar stringListUnescapeRule(int ch)
+{
+    return ch == ';' ? ';' : stringUnescapeRule(ch);
+}
+
+// Undoes the Exec quoting. White spaces get replaced by placeholders, so the arguments can still be split at
+// the unquoted ones afterwards.
+static Q_DECL_CONSTEXPR uchar execUnescapeRule(int ch)
+{
+    return ch == ' ' ? 01
+         : ch == '\t' ? 02
+         : ch == '\n' ? 03
+         : (ch == '"' || ch == '\'' || ch == '\\' || ch == '>' || ch == '<' || ch == '~' || ch == '|'
+            || ch == '&' || ch == ';' || ch == '$' || ch == '*' || ch == '?' || ch == '#' || ch == '('
+            || ch == ')' || ch == '`') ? uchar(ch)
+         : 0;
+}
+
+static const ushort stringEscapeTable[128] = { QXDG_TABLE(stringEscapeRule) };
+static const ushort execEscapeTable[128] = { QXDG_TABLE(execEscapeRule) };
+static const uchar stringUnescapeTable[128] = { QXDG_TABLE(stringUnescapeRule) };
+static const uchar stringListUnescapeTable[128] = { QXDG_TABLE(stringListUnescapeRule) };
+static const uchar execUnescapeTable[128] = { QXDG_TABLE(execUnescapeRule) };
+
+static inline const ushort *escapeTable(QXdgEscapeMode mode)
+{
+    return mode == QXdgEscapeMode::Exec ? execEscapeTable : stringEscapeTable;
+}
+
+static inline ushort lookup(const ushort *table, ushort ch)
+{
+    return ch < 128 ? table[ch] : 0;
+}
+
+static inline uchar lookup(const uchar *table, ushort ch)
+{
+    return ch < 128 ? table[ch] : 0;
+}
+
+/*!
+ * \internal
+ * \brief Returns the length of \a str after escaping it, which is \a size if there is nothing to escape.
+ */
+int qxdgEscapedLength(const QChar *str, int size, QXdgEscapeMode mode)
+{
+    const ushort *table = escapeTable(mode);
+    int length = size;
+    for (int i = 0; i < size; i++) {
+        length += lookup(table, str[i].unicode()) >> 8;
+    }
+    return length;
+}
+
+/*!
+ * \internal
+ * \brief Escapes \a str into \a out, which must have room for qxdgEscapedLength() chars.
+ */
+void qxdgEscape(const QChar *str, int size, QChar *out, QXdgEscapeMode mode)
+{
+    const ushort *table = escapeTable(mode);
+    for (int i = 0; i < size; i++) {
+        const ushort ch = str[i].unicode();
+        const ushort rule = lookup(table, ch);
+        if (!rule) {
+            *out++ = QChar(ch);
+            continue;
+        }
+        for (int backslashes = rule >> 8; backslashes > 0; backslashes--) {
+            *out++ = QLatin1Char('\\');
+        }
+        *out++ = QChar(ushort(rule & 0xff));
+    }
+}
+
+/*! \internal */
+int qxdgFindEscape(const QChar *str, int size)
+{
+    for (int i = 0; i < size; i++) {
+        if (str[i].unicode() == '\\') {
+            return i;
+        }
+    }
+    return -1;
+}
+
+namespace {
+
+// Collects the output of the string unescaping, and undoes the Exec quoting on the fly so both rules are
+// applied in the same pass: a backslash is held back until we know whether it starts a quoted char.
+class ExecUnescapeSink
+{
+public:
+    explicit ExecUnescapeSink(QChar *out) : out(out) {}
+
+    void put(ushort ch) {
+        if (pendingBackslash) {
+            pendingBackslash = false;
+            if (const uchar replacement = lookup(execUnescapeTable, ch)) {
+                *out++ = QChar(ushort(replacement));
+                return;
+            }
+            *out++ = QLatin1Char('\\');
+        }
+        if (ch == '\\') {
+            pendingBackslash = true;
+        } else {
+            *out++ = QChar(ch);
+        }
+    }
+
+    QChar *finish() {
+        if (pendingBackslash) {
+            *out++ = QLatin1Char('\\');
+        }
+        return out;
+    }
+
+private:
+    QChar *out;
+    bool pendingBackslash = false;
+};
+
+class PlainSink
+{
+public:
+    explicit PlainSink(QChar *out) : out(out) {}
+    void put(ushort ch) { *out++ = QChar(ch); }
+    QChar *finish() { return out; }
+
+private:
+    QChar *out;
+};
+
+} // namespace
+
+template <typename Sink>
+static inline int unescape(const QChar *str, int size, QChar *out, const uchar *table)
+{
+    Sink sink(out);
+    int i = 0;
+    while (i < size) {
+        const ushort ch = str[i].unicode();
+        uchar replacement;
+        if (ch == '\\' && i + 1 < size && (replacement = lookup(table, str[i + 1].unicode()))) {
+            sink.put(replacement);
+            i += 2;
+        } else {
+            sink.put(ch);
+            i++;
+        }
+    }
+    return int(sink.finish() - out);
+}
+
+/*!
+ * \internal
+ * \brief Unescapes \a str into \a out, and returns the length of the result.
+ *
+ * An unknown escape sequence, or a backslash at the end, is kept as-is.
+ */
+int qxdgUnescape(const QChar *str, int size, QChar *out, QXdgUnescapeMode mode)
+{
+    switch (mode) {
+    case QXdgUnescapeMode::Exec:
+        return unescape<ExecUnescapeSink>(str, size, out, stringUnescapeTable);
+    case QXdgUnescapeMode::StringList:
+        return unescape<PlainSink>(str, size, out, stringListUnescapeTable);
+    default:
+        return unescape<PlainSink>(str, size, out, stringUnescapeTable);
+    }
+}
@@ -0,0 +1,60 @@
+/*
+ * Copyright (C) 2019 Deepin Technology Co., Ltd.
+ *               2019 Gary Wang
+ *
+ * Author:     Gary Wang <wzc782970009@gmail.com>
+ *
+ * Maintainer: Gary Wang <wzc782970009@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QXDGDESKTOPENTRYESCAPE_P_H
+#define QXDGDESKTOPENTRYESCAPE_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the QXdg API. It exists purely as an
+// implementation detail. This header file may change from version to
+// version without notice, or even be removed.
+//
+
+#include <QChar>
+
+/*! \internal */
+enum class QXdgEscapeMode {
+    String,     // \\, \n, \t and \r
+    Exec        // the above, plus the quoting of the Exec key
+};
+
+/*! \internal */
+enum class QXdgUnescapeMode {
+    String,     // \\, \s, \n, \t and \r
+    StringList, // the above, plus \;
+    Exec        // String, then the quoting of the Exec key
+};
+
+// The escape functions go through the input once, using lookup tables built at compile time. Callers check
+// the length first, so input which doesn't need escaping is never copied.
+int qxdgEscapedLength(const QChar *str, int size, QXdgEscapeMode mode);
+void qxdgEscape(const QChar *str, int size, QChar *out, QXdgEscapeMode mode);
+
+// Returns the position of the first backslash, or -1 if there is nothing to unescape.
+int qxdgFindEscape(const QChar *str, int size);
+// Writes at most \a size chars to \a out, which may be \a str itself, and returns how many were written.
+int qxdgUnescape(const QChar *str, int size, QChar *out, QXdgUnescapeMode mode);
+
+#endif // QXDGDESKTOPENTRYESCAPE_P_H
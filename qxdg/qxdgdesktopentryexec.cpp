@@ -0,0 +1,730 @@
+/*
+ * Copyright (C) 2019 Deepin Technology Co., Ltd.
+ *               2019 Gary Wang
+ *
+ * Author:     Gary Wang <wzc782970009@gmail.com>
+ *
+ * Maintainer: Gary Wang <wzc782970009@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "qxdgdesktopentryexec.h"
+#include "qxdgdesktopentry.h"
+
+#include <QDebug>
+#include <QMutex>
+#include <QProcess>
+#include <QUrl>
+#include <QVector>
+
+#include <thread>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <spawn.h>
+#include <string.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+extern char **environ;
+
+namespace {
+
+// A piece of an argument which contains both text and field codes, like --file=%f.
+struct ExecPiece
+{
+    QString text;
+    // the field code letter, or 0 if this is text.
+    char fieldCode;
+};
+
+// An argument of the command line template. Most arguments are plain text or a single field code, only the
+// others need pieces.
+struct ExecArgument
+{
+    QString text;
+    char fieldCode = 0;
+    QVector<ExecPiece> pieces;
+};
+
+} // namespace
+
+Q_DECLARE_TYPEINFO(ExecPiece, Q_MOVABLE_TYPE);
+Q_DECLARE_TYPEINFO(ExecArgument, Q_MOVABLE_TYPE);
+
+/*! \internal */
+class QXdgDesktopEntryExecPrivate : public QSharedData
+{
+public:
+    bool parse(const QString &exec);
+    void appendExpanded(QStringList &argv, const ExecArgument &argument, const QStringList &urls) const;
+    QString expand(char fieldCode, const QStringList &urls) const;
+
+    QVector<ExecArgument> arguments;
+    QString errorString;
+    // %F or %U: all files in a single launch. %f or %u: one launch per file.
+    bool multipleFiles = false;
+    bool singleFile = false;
+    // %u or %U
+    bool urls = false;
+
+    QString iconName;
+    QString name;
+    QString location;
+    QString workingDirectory;
+};
+
+static inline bool isExecSpace(QChar ch)
+{
+    return ch == QLatin1Char(' ') || ch == QLatin1Char('\t') || ch == QLatin1Char('\n');
+}
+
+// The chars which can be escaped with a backslash inside a quoted argument.
+static inline bool isQuotedEscape(QChar ch)
+{
+    return ch == QLatin1Char('"') || ch == QLatin1Char('`') || ch == QLatin1Char('$') || ch == QLatin1Char('\\');
+}
+
+// Parses the Exec value after the string escapes have been resolved, see "The Exec key" in the spec.
+bool QXdgDesktopEntryExecPrivate::parse(const QString &exec)
+{
+    auto fail = [this](const QString &error) {
+        errorString = error;
+        arguments.clear();
+        multipleFiles = singleFile = urls = false;
+        return false;
+    };
+
+    // the argument being read: its text after the last field code, and the pieces before.
+    QString text;
+    QVector<ExecPiece> pieces;
+    // an argument was started, it may still be empty ("").
+    bool inArgument = false;
+    // the argument only consists of deprecated field codes so far, and gets dropped if it stays that way.
+    bool onlyDeprecated = false;
+    bool quoted = false;
+
+    auto appendText = [&](QChar ch) {
+        text.append(ch);
+        inArgument = true;
+        onlyDeprecated = false;
+    };
+    auto appendFieldCode = [&](char fieldCode) {
+        if (!text.isEmpty()) {
+            pieces.append({text, 0});
+            text.clear();
+        }
+        pieces.append({QString(), fieldCode});
+        inArgument = true;
+        onlyDeprecated = false;
+    };
+    auto finishArgument = [&]() {
+        if (inArgument && !onlyDeprecated) {
+            ExecArgument argument;
+            if (pieces.isEmpty()) {
+                argument.text = text;
+            } else if (pieces.count() == 1 && text.isEmpty()) {
+                argument.fieldCode = pieces.first().fieldCode;
+            } else {
+                if (!text.isEmpty()) {
+                    pieces.append({text, 0});
+                }
+                argument.pieces = pieces;
+            }
+            arguments.append(argument);
+        }
+        text.clear();
+        pieces.clear();
+        inArgument = false;
+        onlyDeprecated = false;
+    };
+
+    const int size = exec.size();
+    for (int i = 0; i < size; i++) {
+        const QChar ch = exec.at(i);
+        if (quoted) {
+            if (ch == QLatin1Char('"')) {
+                quoted = false;
+            } else if (ch == QLatin1Char('\\') && i + 1 < size && isQuotedEscape(exec.at(i + 1))) {
+                appendText(exec.at(++i));
+            } else {
+                // field codes aren't allowed in quoted arguments, so a % is just a %.
+                appendText(ch);
+            }
+        } else if (isExecSpace(ch)) {
+            finishArgument();
+        } else if (ch == QLatin1Char('"')) {
+            quoted = true;
+            inArgument = true;
+            onlyDeprecated = false;
+        } else if (ch == QLatin1Char('%')) {
+            if (i + 1 == size) {
+                return fail(QStringLiteral("Incomplete field code at the end of the Exec value"));
+            }
+            const char fieldCode = exec.at(++i).toLatin1();
+            switch (fieldCode) {
+            case '%':
+                appendText(QLatin1Char('%'));
+                break;
+            case 'f':
+            case 'u':
+                singleFile = true;
+                urls = urls || fieldCode == 'u';
+                appendFieldCode(fieldCode);
+                break;
+            case 'F':
+            case 'U':
+                multipleFiles = true;
+                urls = urls || fieldCode == 'U';
+                appendFieldCode(fieldCode);
+                break;
+            case 'i':
+            case 'c':
+            case 'k':
+                appendFieldCode(fieldCode);
+                break;
+            case 'd':
+            case 'D':
+            case 'n':
+            case 'N':
+            case 'v':
+            case 'm':
+                // deprecated, they are removed from the command line.
+                if (!inArgument) {
+                    inArgument = true;
+                    onlyDeprecated = true;
+                }
+                break;
+            default:
+                return fail(QStringLiteral("Unknown field code %%%1 in the Exec value").arg(exec.at(i)));
+            }
+        } else {
+            appendText(ch);
+        }
+    }
+
+    if (quoted) {
+        return fail(QStringLiteral("Unterminated quoted argument in the Exec value"));
+    }
+    finishArgument();
+
+    if (arguments.isEmpty() || arguments.first().text.isEmpty()) {
+        return fail(QStringLiteral("The Exec value doesn't start with a program"));
+    }
+
+    return true;
+}
+
+// Local files are given to %f and %F as paths, other URLs can't be given to them.
+static QString toLocalPath(const QString &url)
+{
+    if (url.startsWith(QLatin1Char('/'))) {
+        return url;
+    }
+    const QUrl parsedUrl(url);
+    return parsedUrl.isLocalFile() ? parsedUrl.toLocalFile() : QString();
+}
+
+static QString toUrl(const QString &url)
+{
+    if (url.startsWith(QLatin1Char('/'))) {
+        return QString::fromUtf8(QUrl::fromLocalFile(url).toEncoded());
+    }
+    return url;
+}
+
+// The value of a field code inside a longer argument, where list codes can only take the first file.
+QString QXdgDesktopEntryExecPrivate::expand(char fieldCode, const QStringList &urls) const
+{
+    switch (fieldCode) {
+    case 'f':
+    case 'F':
+        return urls.isEmpty() ? QString() : toLocalPath(urls.first());
+    case 'u':
+    case 'U':
+        return urls.isEmpty() ? QString() : toUrl(urls.first());
+    case 'i':
+        return iconName;
+    case 'c':
+        return name;
+    case 'k':
+        return location;
+    default:
+        return QString();
+    }
+}
+
+void QXdgDesktopEntryExecPrivate::appendExpanded(QStringList &argv, const ExecArgument &argument,
+                                                 const QStringList &urls) const
+{
+    if (!argument.pieces.isEmpty()) {
+        QString expanded;
+        for (const ExecPiece &piece : argument.pieces) {
+            expanded += piece.fieldCode ? expand(piece.fieldCode, urls) : piece.text;
+        }
+        argv << expanded;
+        return;
+    }
+
+    // an argument which is a single field code disappears if there is nothing to put in.
+    switch (argument.fieldCode) {
+    case 0:
+        argv << argument.text;
+        break;
+    case 'F':
+        for (const QString &url : urls) {
+            const QString path = toLocalPath(url);
+            if (!path.isEmpty()) {
+                argv << path;
+            }
+        }
+        break;
+    case 'U':
+        for (const QString &url : urls) {
+            argv << toUrl(url);
+        }
+        break;
+    case 'i':
+        if (!iconName.isEmpty()) {
+            argv << QStringLiteral("--icon") << iconName;
+        }
+        break;
+    default: {
+        const QString value = expand(argument.fieldCode, urls);
+        if (!value.isEmpty()) {
+            argv << value;
+        }
+        break;
+    }
+    }
+}
+
+/*!
+ * \class QXdgDesktopEntryExec
+ * \brief The command line of an Exec key, ready to be launched with a list of files or URLs.
+ *
+ * The value is split into arguments and its field codes are located once, when it gets constructed.
+ * commandLines() then only fills the files into the template, and startDetached() runs the program with
+ * posix_spawn(), without going through a shell. One thread of the library reaps every launched program, the
+ * SIGCHLD handler of the application is left alone.
+ *
+ * \code
+ * QXdgDesktopEntry entry("/usr/share/applications/org.gnome.eog.desktop");
+ * entry.exec().startDetached({"/tmp/a.png", "/tmp/b.png"});
+ * \endcode
+ *
+ * QXdgDesktopEntry::exec() fills the values of the %i, %c and %k field codes from the entry, and caches the
+ * result.
+ */
+
+/*!
+ * \brief Construct an invalid command line.
+ */
+QXdgDesktopEntryExec::QXdgDesktopEntryExec()
+    : d_ptr(new QXdgDesktopEntryExecPrivate)
+{
+
+}
+
+/*!
+ * \brief Parse the \a exec value, as it is written in the desktop entry file.
+ *
+ * The string escapes are resolved first, then the argument quoting. Check isValid() for errors.
+ */
+QXdgDesktopEntryExec::QXdgDesktopEntryExec(const QString &exec)
+    : d_ptr(new QXdgDesktopEntryExecPrivate)
+{
+    Q_D(QXdgDesktopEntryExec);
+    QString unescaped = exec;
+    d->parse(QXdgDesktopEntry::unescape(unescaped));
+}
+
+QXdgDesktopEntryExec::QXdgDesktopEntryExec(const QXdgDesktopEntryExec &other)
+    : d_ptr(other.d_ptr)
+{
+
+}
+
+QXdgDesktopEntryExec::QXdgDesktopEntryExec(QXdgDesktopEntryExec &&other) noexcept
+    : d_ptr(std::move(other.d_ptr))
+{
+
+}
+
+QXdgDesktopEntryExec::~QXdgDesktopEntryExec()
+{
+
+}
+
+QXdgDesktopEntryExec &QXdgDesktopEntryExec::operator=(const QXdgDesktopEntryExec &other)
+{
+    d_ptr = other.d_ptr;
+    return *this;
+}
+
+QXdgDesktopEntryExec &QXdgDesktopEntryExec::operator=(QXdgDesktopEntryExec &&other) noexcept
+{
+    swap(other);
+    return *this;
+}
+
+QXdgDesktopEntryExecPrivate *QXdgDesktopEntryExec::d_func()
+{
+    return d_ptr.data();
+}
+
+const QXdgDesktopEntryExecPrivate *QXdgDesktopEntryExec::d_func() const
+{
+    return d_ptr.constData();
+}
+
+/*!
+ * \brief Returns true if the value was parsed successfully.
+ */
+bool QXdgDesktopEntryExec::isValid() const
+{
+    Q_D(const QXdgDesktopEntryExec);
+    return !d->arguments.isEmpty();
+}
+
+/*!
+ * \brief Returns why the value couldn't be parsed, or an empty string.
+ */
+QString QXdgDesktopEntryExec::errorString() const
+{
+    Q_D(const QXdgDesktopEntryExec);
+    return d->errorString;
+}
+
+/*!
+ * \brief Returns the program to run, the first argument of the command line.
+ */
+QString QXdgDesktopEntryExec::program() const
+{
+    Q_D(const QXdgDesktopEntryExec);
+    return d->arguments.isEmpty() ? QString() : d->arguments.first().text;
+}
+
+/*!
+ * \brief Returns true if the program takes URLs (%u or %U), and not only local files.
+ */
+bool QXdgDesktopEntryExec::acceptsUrls() const
+{
+    Q_D(const QXdgDesktopEntryExec);
+    return d->urls;
+}
+
+/*!
+ * \brief Returns true if the program takes several files at once (%F or %U).
+ */
+bool QXdgDesktopEntryExec::acceptsMultipleFiles() const
+{
+    Q_D(const QXdgDesktopEntryExec);
+    return d->multipleFiles;
+}
+
+/*!
+ * \brief Returns the icon passed for %i, as "--icon" followed by the icon name.
+ */
+QString QXdgDesktopEntryExec::iconName() const
+{
+    Q_D(const QXdgDesktopEntryExec);
+    return d->iconName;
+}
+
+void QXdgDesktopEntryExec::setIconName(const QString &iconName)
+{
+    Q_D(QXdgDesktopEntryExec);
+    d->iconName = iconName;
+}
+
+/*!
+ * \brief Returns the translated name passed for %c.
+ */
+QString QXdgDesktopEntryExec::name() const
+{
+    Q_D(const QXdgDesktopEntryExec);
+    return d->name;
+}
+
+void QXdgDesktopEntryExec::setName(const QString &name)
+{
+    Q_D(QXdgDesktopEntryExec);
+    d->name = name;
+}
+
+/*!
+ * \brief Returns the location of the desktop entry file passed for %k.
+ */
+QString QXdgDesktopEntryExec::location() const
+{
+    Q_D(const QXdgDesktopEntryExec);
+    return d->location;
+}
+
+void QXdgDesktopEntryExec::setLocation(const QString &location)
+{
+    Q_D(QXdgDesktopEntryExec);
+    d->location = location;
+}
+
+/*!
+ * \brief Returns the directory the program is started in, the Path key of the entry.
+ *
+ * If it's empty, the program inherits the working directory of the calling process.
+ */
+QString QXdgDesktopEntryExec::workingDirectory() const
+{
+    Q_D(const QXdgDesktopEntryExec);
+    return d->workingDirectory;
+}
+
+void QXdgDesktopEntryExec::setWorkingDirectory(const QString &workingDirectory)
+{
+    Q_D(QXdgDesktopEntryExec);
+    d->workingDirectory = workingDirectory;
+}
+
+/*!
+ * \brief Returns the argument lists to launch the program with \a urls, one for each launch.
+ *
+ * \a urls can hold local file paths and URLs. A program taking a single file (%f or %u) is launched once for
+ * each of them, a program without any file field code is launched once and \a urls are ignored. %f and %F
+ * only take local files, other URLs are skipped for them.
+ */
+QList<QStringList> QXdgDesktopEntryExec::commandLines(const QStringList &urls) const
+{
+    Q_D(const QXdgDesktopEntryExec);
+    QList<QStringList> result;
+    if (d->arguments.isEmpty()) {
+        return result;
+    }
+
+    QList<QStringList> launches;
+    if (d->multipleFiles || !d->singleFile || urls.count() <= 1) {
+        launches << urls;
+    } else {
+        for (const QString &url : urls) {
+            if (d->urls || !toLocalPath(url).isEmpty()) {
+                launches << QStringList(url);
+            }
+        }
+    }
+
+    for (const QStringList &launchUrls : launches) {
+        QStringList argv;
+        argv.reserve(d->arguments.count() + launchUrls.count());
+        for (const ExecArgument &argument : d->arguments) {
+            d->appendExpanded(argv, argument, launchUrls);
+        }
+        result << argv;
+    }
+
+    return result;
+}
+
+namespace {
+
+// Reaps the launched programs, so they don't linger as zombies, and we don't need to touch the SIGCHLD handler of
+// the application. One thread serves every launch: it polls a pidfd per running program, or checks them once a
+// second on kernels without pidfd_open().
+class ChildReaper
+{
+public:
+    ChildReaper() {
+        if (pipe2(wakeFds, O_CLOEXEC | O_NONBLOCK) != 0) {
+            wakeFds[0] = wakeFds[1] = -1;
+        }
+        std::thread(&ChildReaper::run, this).detach();
+    }
+
+    void add(pid_t pid) {
+        Child child;
+        child.pid = pid;
+        child.fd = -1;
+#ifdef SYS_pidfd_open
+        child.fd = int(syscall(SYS_pidfd_open, pid, 0));
+#endif
+        {
+            QMutexLocker locker(&mutex);
+            children.append(child);
+        }
+        if (wakeFds[1] != -1) {
+            const char byte = 0;
+            while (write(wakeFds[1], &byte, 1) == -1 && errno == EINTR) {}
+        }
+    }
+
+private:
+    struct Child
+    {
+        pid_t pid;
+        int fd;
+    };
+
+    void run() {
+        QVector<Child> polled;
+        QVector<pollfd> fds;
+        for (;;) {
+            {
+                QMutexLocker locker(&mutex);
+                polled = children;
+            }
+
+            fds.clear();
+            bool canPoll = wakeFds[0] != -1;
+            if (canPoll) {
+                fds.append(pollfd{wakeFds[0], POLLIN, 0});
+            }
+            for (const Child &child : qAsConst(polled)) {
+                canPoll = canPoll && child.fd != -1;
+                fds.append(pollfd{child.fd, POLLIN, 0});
+            }
+            // if poll() itself fails, every program gets checked.
+            const bool checkAll = poll(fds.data(), nfds_t(fds.count()), canPoll ? -1 : 1000) == -1;
+
+            if (wakeFds[0] != -1) {
+                char buffer[64];
+                while (read(wakeFds[0], buffer, sizeof(buffer)) > 0) {}
+            }
+
+            // Without a pidfd, or if another waitpid() of the application was faster, only waitpid() can tell.
+            QVector<pid_t> reaped;
+            const int first = wakeFds[0] != -1 ? 1 : 0;
+            for (int i = 0; i < polled.count(); i++) {
+                const Child &child = polled.at(i);
+                if (child.fd != -1 && !checkAll && fds.at(first + i).revents == 0) continue;
+                if (waitpid(child.pid, nullptr, WNOHANG) != 0) {
+                    reaped << child.pid;
+                }
+            }
+            if (reaped.isEmpty()) continue;
+
+            QMutexLocker locker(&mutex);
+            for (int i = children.count() - 1; i >= 0; i--) {
+                if (!reaped.contains(children.at(i).pid)) continue;
+                if (children.at(i).fd != -1) {
+                    close(children.at(i).fd);
+                }
+                children.remove(i);
+            }
+        }
+    }
+
+    int wakeFds[2];
+    QMutex mutex;
+    QVector<Child> children;
+};
+
+} // namespace
+
+// The reaper thread runs until the process exits, so it's never destroyed.
+static ChildReaper *childReaper()
+{
+    static ChildReaper *reaper = new ChildReaper;
+    return reaper;
+}
+
+// Runs the command line without waiting for it. posix_spawn() doesn't copy the page tables of the caller like
+// fork() does, so a launcher with a large heap stays fast. The program gets reaped by childReaper().
+static bool spawnDetached(const QStringList &argv, const QString &workingDirectory, qint64 *pid)
+{
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 29))
+    const bool canChangeDirectory = true;
+#else
+    const bool canChangeDirectory = false;
+#endif
+    if (!workingDirectory.isEmpty() && !canChangeDirectory) {
+        return QProcess::startDetached(argv.first(), argv.mid(1), workingDirectory, pid);
+    }
+
+    QVector<QByteArray> encoded;
+    encoded.reserve(argv.count());
+    QVector<char *> args;
+    args.reserve(argv.count() + 1);
+    for (const QString &arg : argv) {
+        encoded << arg.toLocal8Bit();
+        args << encoded.last().data();
+    }
+    args << nullptr;
+
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 29))
+    const QByteArray directory = workingDirectory.toLocal8Bit();
+    if (!workingDirectory.isEmpty()) {
+        posix_spawn_file_actions_addchdir_np(&actions, directory.constData());
+    }
+#endif
+
+    // The calling thread may block signals or ignore SIGPIPE, the program shouldn't inherit that.
+    posix_spawnattr_t attributes;
+    posix_spawnattr_init(&attributes);
+    sigset_t signalSet;
+    sigemptyset(&signalSet);
+    posix_spawnattr_setsigmask(&attributes, &signalSet);
+    sigfillset(&signalSet);
+    posix_spawnattr_setsigdefault(&attributes, &signalSet);
+    short flags = POSIX_SPAWN_SETSIGMASK | POSIX_SPAWN_SETSIGDEF;
+#ifdef POSIX_SPAWN_SETSID
+    flags |= POSIX_SPAWN_SETSID;
+#endif
+    posix_spawnattr_setflags(&attributes, flags);
+
+    pid_t childPid = 0;
+    const int error = posix_spawnp(&childPid, args.first(), &actions, &attributes, args.data(), environ);
+    posix_spawnattr_destroy(&attributes);
+    posix_spawn_file_actions_destroy(&actions);
+
+    if (error != 0) {
+        qWarning() << "QXdgDesktopEntryExec: Can't start" << argv.first() << ":" << strerror(error);
+        return false;
+    }
+
+    childReaper()->add(childPid);
+    if (pid) {
+        *pid = childPid;
+    }
+    return true;
+}
+
+/*!
+ * \brief Launch the program with \a urls, see commandLines(), without waiting for it to finish.
+ *
+ * The process IDs of the launched programs are appended to \a pids if it's not null. Returns false if the
+ * command line is invalid or any of the launches failed.
+ */
+bool QXdgDesktopEntryExec::startDetached(const QStringList &urls, QList<qint64> *pids) const
+{
+    Q_D(const QXdgDesktopEntryExec);
+    if (d->arguments.isEmpty()) {
+        return false;
+    }
+
+    bool result = true;
+    for (const QStringList &argv : commandLines(urls)) {
+        qint64 pid = 0;
+        if (!spawnDetached(argv, d->workingDirectory, &pid)) {
+            result = false;
+        } else if (pids) {
+            pids->append(pid);
+        }
+    }
+
+    return result;
+}
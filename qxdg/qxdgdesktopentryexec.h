@@ -0,0 +1,73 @@
+/*
+ * Copyright (C) 2019 Deepin Technology Co., Ltd.
+ *               2019 Gary Wang
+ *
+ * Author:     Gary Wang <wzc782970009@gmail.com>
+ *
+ * Maintainer: Gary Wang <wzc782970009@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QXDGDESKTOPENTRYEXEC_H
+#define QXDGDESKTOPENTRYEXEC_H
+
+#include "qxdg_global.h"
+
+#include <QSharedDataPointer>
+#include <QStringList>
+
+class QXdgDesktopEntryExecPrivate;
+class QXDGSHARED_EXPORT QXdgDesktopEntryExec
+{
+public:
+    QXdgDesktopEntryExec();
+    explicit QXdgDesktopEntryExec(const QString &exec);
+    QXdgDesktopEntryExec(const QXdgDesktopEntryExec &other);
+    QXdgDesktopEntryExec(QXdgDesktopEntryExec &&other) noexcept;
+    ~QXdgDesktopEntryExec();
+
+    QXdgDesktopEntryExec &operator=(const QXdgDesktopEntryExec &other);
+    QXdgDesktopEntryExec &operator=(QXdgDesktopEntryExec &&other) noexcept;
+    void swap(QXdgDesktopEntryExec &other) noexcept { d_ptr.swap(other.d_ptr); }
+
+    bool isValid() const;
+    QString errorString() const;
+    QString program() const;
+    bool acceptsUrls() const;
+    bool acceptsMultipleFiles() const;
+
+    QString iconName() const;
+    void setIconName(const QString &iconName);
+    QString name() const;
+    void setName(const QString &name);
+    QString location() const;
+    void setLocation(const QString &location);
+    QString workingDirectory() const;
+    void setWorkingDirectory(const QString &workingDirectory);
+
+    QList<QStringList> commandLines(const QStringList &urls = QStringList()) const;
+    bool startDetached(const QStringList &urls = QStringList(), QList<qint64> *pids = nullptr) const;
+
+private:
+    // Not Q_DECLARE_PRIVATE, the non-const accessor detaches, and both need the complete private class.
+    QXdgDesktopEntryExecPrivate *d_func();
+    const QXdgDesktopEntryExecPrivate *d_func() const;
+
+    QSharedDataPointer<QXdgDesktopEntryExecPrivate> d_ptr;
+};
+
+Q_DECLARE_SHARED(QXdgDesktopEntryExec)
+
+#endif // QXDGDESKTOPENTRYEXEC_H
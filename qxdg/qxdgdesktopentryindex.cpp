@@ -0,0 +1,184 @@
+/*
+ * Copyright (C) 2019 Deepin Technology Co., Ltd.
+ *               2019 Gary Wang
+ *
+ * Author:     Gary Wang <wzc782970009@gmail.com>
+ *
+ * Maintainer: Gary Wang <wzc782970009@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "qxdgdesktopentryindex.h"
+#include "qxdgdesktopentrycollection.h"
+
+#include <QHash>
+#include <QVector>
+
+/*! \internal */
+class QXdgDesktopEntryIndexPrivate
+{
+public:
+    // value -> positions inside entryIds, in ascending order.
+    typedef QHash<QString, QVector<int>> InvertedIndex;
+
+    QStringList indexedKeys;
+    QVector<InvertedIndex> indexes;
+    QStringList entryIds;
+
+    const InvertedIndex *index(const QString &key) const;
+};
+
+const QXdgDesktopEntryIndexPrivate::InvertedIndex *QXdgDesktopEntryIndexPrivate::index(const QString &key) const
+{
+    const int pos = indexedKeys.indexOf(key);
+    return pos == -1 ? nullptr : &indexes[pos];
+}
+
+/*!
+ * \class QXdgDesktopEntryIndex
+ * \brief Inverted indexes on the list-valued keys of a QXdgDesktopEntryCollection.
+ *
+ * For each indexed key, maps every value found in any entry to the desktop file IDs of the entries which have it,
+ * so questions like "which applications handle image/png" don't need to go through every entry.
+ *
+ * \code
+ * QXdgDesktopEntryCollection collection;
+ * collection.loadApplications();
+ * QXdgDesktopEntryIndex index;
+ * index.build(collection);
+ * QStringList imageViewers = index.lookup("MimeType", "image/png");
+ * \endcode
+ */
+
+/*!
+ * \brief Construct an empty index for the given list-valued \a indexedKeys.
+ */
+QXdgDesktopEntryIndex::QXdgDesktopEntryIndex(const QStringList &indexedKeys)
+    : d_ptr(new QXdgDesktopEntryIndexPrivate)
+{
+    Q_D(QXdgDesktopEntryIndex);
+    d->indexedKeys = indexedKeys;
+    d->indexedKeys.removeDuplicates();
+    d->indexes.resize(d->indexedKeys.count());
+}
+
+QXdgDesktopEntryIndex::~QXdgDesktopEntryIndex()
+{
+
+}
+
+/*!
+ * \brief Returns the keys indexed by default, MimeType and Categories.
+ */
+QStringList QXdgDesktopEntryIndex::defaultIndexedKeys()
+{
+    return { QStringLiteral("MimeType"), QStringLiteral("Categories") };
+}
+
+QStringList QXdgDesktopEntryIndex::indexedKeys() const
+{
+    Q_D(const QXdgDesktopEntryIndex);
+    return d->indexedKeys;
+}
+
+bool QXdgDesktopEntryIndex::isIndexed(const QString &key) const
+{
+    Q_D(const QXdgDesktopEntryIndex);
+    return d->indexedKeys.contains(key);
+}
+
+/*!
+ * \brief Index the values of the indexed keys in \a section of every entry of \a collection.
+ *
+ * This replaces the previous content of the index, and walks the collection once. The index doesn't follow the
+ * changes made to the collection or its entries later, build it again for that.
+ */
+void QXdgDesktopEntryIndex::build(const QXdgDesktopEntryCollection &collection, const QString &section)
+{
+    Q_D(QXdgDesktopEntryIndex);
+
+    clear();
+    d->entryIds = collection.desktopFileIds();
+    const QVector<QXdgDesktopEntry> entries = collection.entries();
+
+    for (int i = 0; i < entries.count(); i++) {
+        for (int k = 0; k < d->indexedKeys.count(); k++) {
+            QStringList values = entries[i].stringListValue(d->indexedKeys[k], section);
+            values.removeDuplicates();
+            for (const QString &value : values) {
+                if (value.isEmpty()) continue;
+                // entries are visited in order, so the positions stay sorted.
+                d->indexes[k][value].append(i);
+            }
+        }
+    }
+}
+
+void QXdgDesktopEntryIndex::clear()
+{
+    Q_D(QXdgDesktopEntryIndex);
+    d->entryIds.clear();
+    for (QXdgDesktopEntryIndexPrivate::InvertedIndex &index : d->indexes) {
+        index.clear();
+    }
+}
+
+/*!
+ * \brief Returns the desktop file IDs of the entries which have \a value in the list of \a key.
+ *
+ * IDs are in the precedence order of the collection the index was built from. The \a key must be one of
+ * indexedKeys(), or the result is always empty.
+ */
+QStringList QXdgDesktopEntryIndex::lookup(const QString &key, const QString &value) const
+{
+    Q_D(const QXdgDesktopEntryIndex);
+
+    QStringList result;
+    const QXdgDesktopEntryIndexPrivate::InvertedIndex *index = d->index(key);
+    if (!index) return result;
+
+    QXdgDesktopEntryIndexPrivate::InvertedIndex::const_iterator it = index->constFind(value);
+    if (it == index->constEnd()) return result;
+
+    result.reserve(it->count());
+    for (int pos : it.value()) {
+        result.append(d->entryIds[pos]);
+    }
+    return result;
+}
+
+/*!
+ * \brief Returns the amount of entries lookup() would return, without building the list.
+ */
+int QXdgDesktopEntryIndex::count(const QString &key, const QString &value) const
+{
+    Q_D(const QXdgDesktopEntryIndex);
+    const QXdgDesktopEntryIndexPrivate::InvertedIndex *index = d->index(key);
+    return index ? index->value(value).count() : 0;
+}
+
+/*!
+ * \brief Returns every distinct value of \a key found in the entries, sorted.
+ */
+QStringList QXdgDesktopEntryIndex::values(const QString &key) const
+{
+    Q_D(const QXdgDesktopEntryIndex);
+    const QXdgDesktopEntryIndexPrivate::InvertedIndex *index = d->index(key);
+    if (!index) return {};
+
+    QStringList result = index->keys();
+    result.sort();
+    return result;
+}
@@ -0,0 +1,57 @@
+/*
+ * Copyright (C) 2019 Deepin Technology Co., Ltd.
+ *               2019 Gary Wang
+ *
+ * Author:     Gary Wang <wzc782970009@gmail.com>
+ *
+ * Maintainer: Gary Wang <wzc782970009@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QXDGDESKTOPENTRYINDEX_H
+#define QXDGDESKTOPENTRYINDEX_H
+
+#include "qxdg_global.h"
+
+#include <QScopedPointer>
+#include <QStringList>
+
+class QXdgDesktopEntryCollection;
+class QXdgDesktopEntryIndexPrivate;
+class QXDGSHARED_EXPORT QXdgDesktopEntryIndex
+{
+public:
+    explicit QXdgDesktopEntryIndex(const QStringList &indexedKeys = defaultIndexedKeys());
+    ~QXdgDesktopEntryIndex();
+
+    static QStringList defaultIndexedKeys();
+    QStringList indexedKeys() const;
+    bool isIndexed(const QString &key) const;
+
+    void build(const QXdgDesktopEntryCollection &collection, const QString &section = "Desktop Entry");
+    void clear();
+
+    QStringList lookup(const QString &key, const QString &value) const;
+    int count(const QString &key, const QString &value) const;
+    QStringList values(const QString &key) const;
+
+private:
+    QScopedPointer<QXdgDesktopEntryIndexPrivate> d_ptr;
+
+    Q_DECLARE_PRIVATE(QXdgDesktopEntryIndex)
+    Q_DISABLE_COPY(QXdgDesktopEntryIndex)
+};
+
+#endif // QXDGDESKTOPENTRYINDEX_H
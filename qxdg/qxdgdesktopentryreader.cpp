@@ -0,0 +1,379 @@
+/*
+ * Copyright (C) 2019 Deepin Technology Co., Ltd.
+ *               2019 Gary Wang
+ *
+ * Author:     Gary Wang <wzc782970009@gmail.com>
+ *
+ * Maintainer: Gary Wang <wzc782970009@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "qxdgdesktopentryreader.h"
+#include "qxdgdesktopentrytokenizer_p.h"
+
+/*! \internal */
+class QXdgDesktopEntryReaderPrivate
+{
+public:
+    void reset();
+    void setToken(QXdgDesktopEntryReader::TokenType tokenType, int start, int length);
+
+    QByteArray data;
+    bool hasCarriageReturn = false;
+    // where readLineOrCommentFromData() continues.
+    int pos = 0;
+    bool afterComment = false;
+    // readNextKeyValue() stopped at a group header which readNextGroup() didn't return yet.
+    bool groupPending = false;
+
+    QXdgDesktopEntryReader::TokenType tokenType = QXdgDesktopEntryReader::NoToken;
+    int tokenStart = 0;
+    int tokenLength = 0;
+    // the group name, or the key of a key-value pair.
+    int nameStart = 0;
+    int nameLength = 0;
+    // the value of a key-value pair, or the text of a comment.
+    int valueStart = 0;
+    int valueLength = 0;
+    // the name of the last group header.
+    int groupStart = 0;
+    int groupLength = 0;
+};
+
+void QXdgDesktopEntryReaderPrivate::reset()
+{
+    hasCarriageReturn = memchr(data.constData(), '\r', size_t(data.size())) != nullptr;
+    pos = 0;
+    afterComment = false;
+    groupPending = false;
+    setToken(QXdgDesktopEntryReader::NoToken, 0, 0);
+    groupStart = 0;
+    groupLength = 0;
+}
+
+void QXdgDesktopEntryReaderPrivate::setToken(QXdgDesktopEntryReader::TokenType type, int start, int length)
+{
+    tokenType = type;
+    tokenStart = start;
+    tokenLength = length;
+    nameStart = valueStart = start;
+    nameLength = valueLength = 0;
+}
+
+/*!
+ * \class QXdgDesktopEntryReader
+ * \brief A fast pull parser for the desktop entry syntax.
+ *
+ * Reads the data one line at a time, using the same rules as QXdgDesktopEntry does. Nothing gets allocated
+ * or unescaped while reading: the token accessors return views on the data given to the reader, so this is
+ * the cheapest way to peek at a few keys of many files, or to look at the comments and the line layout
+ * which QXdgDesktopEntry drops.
+ *
+ * \code
+ * QXdgDesktopEntryReader reader(data);
+ * while (reader.readNextGroup()) {
+ *     if (reader.groupName() != "Desktop Entry") continue;
+ *     while (reader.readNextKeyValue()) {
+ *         if (reader.key() == "Exec") return reader.value().toString();
+ *     }
+ * }
+ * \endcode
+ *
+ * Values are returned raw, with their escape sequences. The views stay valid as long as the reader keeps
+ * the same data.
+ */
+
+/*!
+ * \brief Construct a reader without any data, readNext() returns EndDocument right away.
+ */
+QXdgDesktopEntryReader::QXdgDesktopEntryReader()
+    : d_ptr(new QXdgDesktopEntryReaderPrivate)
+{
+}
+
+/*!
+ * \brief Construct a reader on \a data. The data is shared, not copied.
+ */
+QXdgDesktopEntryReader::QXdgDesktopEntryReader(const QByteArray &data)
+    : d_ptr(new QXdgDesktopEntryReaderPrivate)
+{
+    setData(data);
+}
+
+QXdgDesktopEntryReader::~QXdgDesktopEntryReader()
+{
+
+}
+
+/*!
+ * \brief Start reading \a data from the beginning.
+ */
+void QXdgDesktopEntryReader::setData(const QByteArray &data)
+{
+    Q_D(QXdgDesktopEntryReader);
+    d->data = data;
+    d->reset();
+}
+
+/*!
+ * \brief Returns the data this reader reads.
+ */
+QByteArray QXdgDesktopEntryReader::data() const
+{
+    Q_D(const QXdgDesktopEntryReader);
+    return d->data;
+}
+
+/*!
+ * \brief Reads the next line and returns its type.
+ *
+ * Empty lines are skipped, and lines which neither start a group nor have an equal sign are InvalidLine.
+ * Like in QXdgDesktopEntry, a group header without the closing bracket still starts a group, named after
+ * the rest of its line.
+ */
+QXdgDesktopEntryReader::TokenType QXdgDesktopEntryReader::readNext()
+{
+    Q_D(QXdgDesktopEntryReader);
+    d->groupPending = false;
+    if (d->tokenType == EndDocument) {
+        return EndDocument;
+    }
+
+    const char *data = d->data.constData();
+    const int dataLen = d->data.size();
+    int lineStart;
+    int lineLen;
+    int equalsPos;
+
+    if (!readLineOrCommentFromData(data, dataLen, d->pos, lineStart, lineLen, equalsPos, d->afterComment)) {
+        d->setToken(EndDocument, dataLen, 0);
+        return EndDocument;
+    }
+
+    if (d->afterComment) {
+        d->setToken(Comment, lineStart, lineLen);
+        d->valueStart = lineStart + 1;
+        d->valueLength = lineLen - 1;
+    } else if (data[lineStart] == '[') {
+        const char *closeBracket = static_cast<const char *>(memchr(data + lineStart, ']', size_t(lineLen)));
+        d->setToken(GroupStart, lineStart, lineLen);
+        d->nameStart = lineStart + 1;
+        d->nameLength = closeBracket ? int(closeBracket - data) - d->nameStart : lineLen - 1;
+        trimRange(data, d->nameStart, d->nameLength);
+        d->groupStart = d->nameStart;
+        d->groupLength = d->nameLength;
+    } else if (equalsPos != -1) {
+        d->setToken(KeyValue, lineStart, lineLen);
+        d->nameLength = equalsPos - lineStart;
+        trimRange(data, d->nameStart, d->nameLength);
+        d->valueStart = equalsPos + 1;
+        d->valueLength = lineStart + lineLen - equalsPos - 1;
+        trimRange(data, d->valueStart, d->valueLength);
+    } else {
+        d->setToken(InvalidLine, lineStart, lineLen);
+    }
+
+    return d->tokenType;
+}
+
+/*!
+ * \brief Skips the rest of the current group and reads the next group header.
+ *
+ * Returns false if there are no more groups. The skipped lines aren't tokenized, only their starts get
+ * looked at, so this is a lot faster than calling readNext() until it returns GroupStart.
+ */
+bool QXdgDesktopEntryReader::readNextGroup()
+{
+    Q_D(QXdgDesktopEntryReader);
+    if (d->groupPending) {
+        d->groupPending = false;
+        return true;
+    }
+
+    for (;;) {
+        // the line right after a comment starts differently, let readNext() deal with that one.
+        if (!d->afterComment && d->tokenType != EndDocument) {
+            d->pos = findGroupHeaderInData(d->data.constData(), d->data.size(), d->pos, d->hasCarriageReturn);
+        }
+        switch (readNext()) {
+        case GroupStart:
+            return true;
+        case EndDocument:
+            return false;
+        default:
+            break;
+        }
+    }
+}
+
+/*!
+ * \brief Reads until the next key-value pair of the current group.
+ *
+ * Returns false once the group ends, or there is nothing left to read. When it stops at the header of the
+ * next group, the following readNextGroup() call returns that group.
+ */
+bool QXdgDesktopEntryReader::readNextKeyValue()
+{
+    Q_D(QXdgDesktopEntryReader);
+    if (d->groupPending) {
+        return false;
+    }
+
+    for (;;) {
+        switch (readNext()) {
+        case KeyValue:
+            return true;
+        case GroupStart:
+            d->groupPending = true;
+            return false;
+        case EndDocument:
+            return false;
+        default:
+            break;
+        }
+    }
+}
+
+/*!
+ * \brief Returns the type of the current token.
+ */
+QXdgDesktopEntryReader::TokenType QXdgDesktopEntryReader::tokenType() const
+{
+    Q_D(const QXdgDesktopEntryReader);
+    return d->tokenType;
+}
+
+/*!
+ * \brief Returns true if the reader reached the end of its data.
+ */
+bool QXdgDesktopEntryReader::atEnd() const
+{
+    Q_D(const QXdgDesktopEntryReader);
+    return d->tokenType == EndDocument;
+}
+
+/*!
+ * \brief Returns the position of the current token in the data, in bytes.
+ *
+ * Leading white spaces of the line aren't part of the token.
+ */
+int QXdgDesktopEntryReader::tokenOffset() const
+{
+    Q_D(const QXdgDesktopEntryReader);
+    return d->tokenStart;
+}
+
+/*!
+ * \brief Returns the length of the current token in bytes, without the line terminator.
+ *
+ * A value can span several lines if its line terminators are escaped.
+ */
+int QXdgDesktopEntryReader::tokenLength() const
+{
+    Q_D(const QXdgDesktopEntryReader);
+    return d->tokenLength;
+}
+
+/*!
+ * \brief Returns the whole line of the current token.
+ */
+QXdgByteArrayView QXdgDesktopEntryReader::rawToken() const
+{
+    Q_D(const QXdgDesktopEntryReader);
+    return QXdgByteArrayView(d->data.constData() + d->tokenStart, d->tokenLength);
+}
+
+/*!
+ * \brief Returns the name of the group the current token belongs to.
+ *
+ * For a GroupStart token, that's the group it starts. Empty before the first group header.
+ */
+QXdgByteArrayView QXdgDesktopEntryReader::groupName() const
+{
+    Q_D(const QXdgDesktopEntryReader);
+    return QXdgByteArrayView(d->data.constData() + d->groupStart, d->groupLength);
+}
+
+/*!
+ * \brief Returns the key of a KeyValue token, including the locale, e.g. "Name[de]".
+ */
+QXdgByteArrayView QXdgDesktopEntryReader::key() const
+{
+    Q_D(const QXdgDesktopEntryReader);
+    if (d->tokenType != KeyValue) {
+        return QXdgByteArrayView();
+    }
+    return QXdgByteArrayView(d->data.constData() + d->nameStart, d->nameLength);
+}
+
+// Returns the position of the '[' which starts the locale of a localized key, or -1.
+static int localeBracket(QXdgByteArrayView key)
+{
+    if (key.size() < 3 || key.data()[key.size() - 1] != ']') {
+        return -1;
+    }
+    const char *openBracket = static_cast<const char *>(memchr(key.data(), '[', size_t(key.size())));
+    if (!openBracket || openBracket == key.data()) {
+        return -1;
+    }
+    return int(openBracket - key.data());
+}
+
+/*!
+ * \brief Returns the key of a KeyValue token without the locale, e.g. "Name" for "Name[de]".
+ */
+QXdgByteArrayView QXdgDesktopEntryReader::baseKey() const
+{
+    const QXdgByteArrayView fullKey = key();
+    const int bracket = localeBracket(fullKey);
+    return bracket == -1 ? fullKey : QXdgByteArrayView(fullKey.data(), bracket);
+}
+
+/*!
+ * \brief Returns the locale of a localized KeyValue token, e.g. "de" for "Name[de]", or an empty view.
+ */
+QXdgByteArrayView QXdgDesktopEntryReader::locale() const
+{
+    const QXdgByteArrayView fullKey = key();
+    const int bracket = localeBracket(fullKey);
+    if (bracket == -1) {
+        return QXdgByteArrayView();
+    }
+    return QXdgByteArrayView(fullKey.data() + bracket + 1, fullKey.size() - bracket - 2);
+}
+
+/*!
+ * \brief Returns the raw value of a KeyValue token, escape sequences are not resolved.
+ */
+QXdgByteArrayView QXdgDesktopEntryReader::value() const
+{
+    Q_D(const QXdgDesktopEntryReader);
+    if (d->tokenType != KeyValue) {
+        return QXdgByteArrayView();
+    }
+    return QXdgByteArrayView(d->data.constData() + d->valueStart, d->valueLength);
+}
+
+/*!
+ * \brief Returns the text of a Comment token, after the '#'.
+ */
+QXdgByteArrayView QXdgDesktopEntryReader::comment() const
+{
+    Q_D(const QXdgDesktopEntryReader);
+    if (d->tokenType != Comment) {
+        return QXdgByteArrayView();
+    }
+    return QXdgByteArrayView(d->data.constData() + d->valueStart, d->valueLength);
+}
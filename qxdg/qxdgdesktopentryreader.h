@@ -0,0 +1,112 @@
+/*
+ * Copyright (C) 2019 Deepin Technology Co., Ltd.
+ *               2019 Gary Wang
+ *
+ * Author:     Gary Wang <wzc782970009@gmail.com>
+ *
+ * Maintainer: Gary Wang <wzc782970009@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QXDGDESKTOPENTRYREADER_H
+#define QXDGDESKTOPENTRYREADER_H
+
+#include "qxdg_global.h"
+
+#include <QByteArray>
+#include <QScopedPointer>
+#include <QString>
+
+#include <string.h>
+
+/*!
+ * \brief A read-only view on a range of bytes owned by someone else, e.g. a QXdgDesktopEntryReader.
+ *
+ * Nothing gets copied until toByteArray() or toString() is called.
+ */
+class QXdgByteArrayView
+{
+public:
+    Q_DECL_CONSTEXPR QXdgByteArrayView() Q_DECL_NOTHROW : m_data(nullptr), m_size(0) {}
+    Q_DECL_CONSTEXPR QXdgByteArrayView(const char *data, int size) Q_DECL_NOTHROW : m_data(data), m_size(size) {}
+
+    Q_DECL_CONSTEXPR const char *data() const Q_DECL_NOTHROW { return m_data; }
+    Q_DECL_CONSTEXPR int size() const Q_DECL_NOTHROW { return m_size; }
+    Q_DECL_CONSTEXPR bool isEmpty() const Q_DECL_NOTHROW { return m_size == 0; }
+
+    QByteArray toByteArray() const { return QByteArray(m_data, m_size); }
+    QString toString() const { return QString::fromUtf8(m_data, m_size); }
+
+    friend bool operator==(QXdgByteArrayView lhs, QXdgByteArrayView rhs) Q_DECL_NOTHROW {
+        return lhs.m_size == rhs.m_size && (lhs.m_size == 0 || memcmp(lhs.m_data, rhs.m_data, size_t(lhs.m_size)) == 0);
+    }
+    friend bool operator!=(QXdgByteArrayView lhs, QXdgByteArrayView rhs) Q_DECL_NOTHROW { return !(lhs == rhs); }
+    friend bool operator==(QXdgByteArrayView lhs, const char *rhs) Q_DECL_NOTHROW {
+        return lhs == QXdgByteArrayView(rhs, int(strlen(rhs)));
+    }
+    friend bool operator!=(QXdgByteArrayView lhs, const char *rhs) Q_DECL_NOTHROW { return !(lhs == rhs); }
+
+private:
+    const char *m_data;
+    int m_size;
+};
+
+Q_DECLARE_TYPEINFO(QXdgByteArrayView, Q_PRIMITIVE_TYPE);
+
+class QXdgDesktopEntryReaderPrivate;
+class QXDGSHARED_EXPORT QXdgDesktopEntryReader
+{
+public:
+    enum TokenType {
+        NoToken = 0,    //!< readNext() wasn't called yet.
+        GroupStart,     //!< A group header, see groupName().
+        KeyValue,       //!< A key-value pair, see key() and value().
+        Comment,        //!< A comment line, see comment().
+        InvalidLine,    //!< A line which is none of the above, QXdgDesktopEntry ignores these.
+        EndDocument     //!< There is nothing left to read.
+    };
+
+    QXdgDesktopEntryReader();
+    explicit QXdgDesktopEntryReader(const QByteArray &data);
+    ~QXdgDesktopEntryReader();
+
+    void setData(const QByteArray &data);
+    QByteArray data() const;
+
+    TokenType readNext();
+    bool readNextGroup();
+    bool readNextKeyValue();
+
+    TokenType tokenType() const;
+    bool atEnd() const;
+    int tokenOffset() const;
+    int tokenLength() const;
+    QXdgByteArrayView rawToken() const;
+
+    QXdgByteArrayView groupName() const;
+    QXdgByteArrayView key() const;
+    QXdgByteArrayView baseKey() const;
+    QXdgByteArrayView locale() const;
+    QXdgByteArrayView value() const;
+    QXdgByteArrayView comment() const;
+
+private:
+    QScopedPointer<QXdgDesktopEntryReaderPrivate> d_ptr;
+
+    Q_DECLARE_PRIVATE(QXdgDesktopEntryReader)
+    Q_DISABLE_COPY(QXdgDesktopEntryReader)
+};
+
+#endif // QXDGDESKTOPENTRYREADER_H
@@ -0,0 +1,386 @@
+/*
+ * Copyright (C) 2019 Deepin Technology Co., Ltd.
+ *               2019 Gary Wang
+ *
+ * Author:     Gary Wang <wzc782970009@gmail.com>
+ *
+ * Maintainer: Gary Wang <wzc782970009@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "qxdgdesktopentrytokenizer_p.h"
+
+#include <string.h>
+
+enum { Space = 0x1, Special = 0x2 };
+
+static const char charTraits[256] = {
+    // Space: '\t', '\n', '\r', ' '
+    // Special: '\n', '\r', ';', '=', '\\', '#'
+    // Please note that '"' is NOT a special character
+
+    0, 0, 0, 0, 0, 0, 0, 0, 0, Space, Space | Special, 0, 0, Space | Special, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    Space, 0, 0, Special, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, Special, 0, Special, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, Special, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+};
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define QXDG_TOKENIZER_X86
+#include <immintrin.h>
+#endif
+
+typedef const char *(*FindCharFunction)(const char *begin, const char *end);
+
+// Find the first character which could change the state of readLineFromData(). ';' is flagged as Special
+// but never changes anything, so the vectorized variants don't look for it.
+static const char *findSpecialScalar(const char *begin, const char *end)
+{
+    while (begin < end && !(charTraits[uint(uchar(*begin))] & Special))
+        ++begin;
+    return begin;
+}
+
+static const char *findLineBreakScalar(const char *begin, const char *end)
+{
+    while (begin < end && *begin != '\n' && *begin != '\r')
+        ++begin;
+    return begin;
+}
+
+#ifdef QXDG_TOKENIZER_X86
+__attribute__((target("sse2")))
+static const char *findSpecialSse2(const char *begin, const char *end)
+{
+    const __m128i lf = _mm_set1_epi8('\n');
+    const __m128i cr = _mm_set1_epi8('\r');
+    const __m128i equals = _mm_set1_epi8('=');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i hash = _mm_set1_epi8('#');
+
+    while (end - begin >= 16) {
+        const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(begin));
+        const __m128i matches = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, lf), _mm_cmpeq_epi8(chunk, cr)),
+                                             _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, equals),
+                                                                       _mm_cmpeq_epi8(chunk, backslash)),
+                                                          _mm_cmpeq_epi8(chunk, hash)));
+        const uint mask = uint(_mm_movemask_epi8(matches));
+        if (mask) {
+            return begin + __builtin_ctz(mask);
+        }
+        begin += 16;
+    }
+
+    return findSpecialScalar(begin, end);
+}
+
+__attribute__((target("sse2")))
+static const char *findLineBreakSse2(const char *begin, const char *end)
+{
+    const __m128i lf = _mm_set1_epi8('\n');
+    const __m128i cr = _mm_set1_epi8('\r');
+
+    while (end - begin >= 16) {
+        const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(begin));
+        const uint mask = uint(_mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(chunk, lf), _mm_cmpeq_epi8(chunk, cr))));
+        if (mask) {
+            return begin + __builtin_ctz(mask);
+        }
+        begin += 16;
+    }
+
+    return findLineBreakScalar(begin, end);
+}
+
+__attribute__((target("avx2")))
+static const char *findSpecialAvx2(const char *begin, const char *end)
+{
+    const __m256i lf = _mm256_set1_epi8('\n');
+    const __m256i cr = _mm256_set1_epi8('\r');
+    const __m256i equals = _mm256_set1_epi8('=');
+    const __m256i backslash = _mm256_set1_epi8('\\');
+    const __m256i hash = _mm256_set1_epi8('#');
+
+    while (end - begin >= 32) {
+        const __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(begin));
+        const __m256i matches = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(chunk, lf), _mm256_cmpeq_epi8(chunk, cr)),
+                                                _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(chunk, equals),
+                                                                                _mm256_cmpeq_epi8(chunk, backslash)),
+                                                                _mm256_cmpeq_epi8(chunk, hash)));
+        const uint mask = uint(_mm256_movemask_epi8(matches));
+        if (mask) {
+            return begin + __builtin_ctz(mask);
+        }
+        begin += 32;
+    }
+
+    return findSpecialSse2(begin, end);
+}
+
+__attribute__((target("avx2")))
+static const char *findLineBreakAvx2(const char *begin, const char *end)
+{
+    const __m256i lf = _mm256_set1_epi8('\n');
+    const __m256i cr = _mm256_set1_epi8('\r');
+
+    while (end - begin >= 32) {
+        const __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(begin));
+        const uint mask = uint(_mm256_movemask_epi8(_mm256_or_si256(_mm256_cmpeq_epi8(chunk, lf),
+                                                                    _mm256_cmpeq_epi8(chunk, cr))));
+        if (mask) {
+            return begin + __builtin_ctz(mask);
+        }
+        begin += 32;
+    }
+
+    return findLineBreakSse2(begin, end);
+}
+#endif // QXDG_TOKENIZER_X86
+
+static QXdgSimdLevel currentSimdLevel = QXdgSimdLevel::Scalar;
+static FindCharFunction findSpecial = findSpecialScalar;
+static FindCharFunction findLineBreak = findLineBreakScalar;
+
+/*!
+ * \internal
+ * \brief Returns the best tokenizer implementation supported by the running CPU.
+ */
+QXdgSimdLevel qxdgBestTokenizerSimdLevel()
+{
+#ifdef QXDG_TOKENIZER_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return QXdgSimdLevel::Avx2;
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        return QXdgSimdLevel::Sse2;
+    }
+#endif // QXDG_TOKENIZER_X86
+    return QXdgSimdLevel::Scalar;
+}
+
+/*! \internal */
+QXdgSimdLevel qxdgTokenizerSimdLevel()
+{
+    return currentSimdLevel;
+}
+
+/*! \internal */
+bool qxdgSetTokenizerSimdLevel(QXdgSimdLevel level)
+{
+    if (level > qxdgBestTokenizerSimdLevel()) {
+        return false;
+    }
+
+    switch (level) {
+#ifdef QXDG_TOKENIZER_X86
+    case QXdgSimdLevel::Avx2:
+        findSpecial = findSpecialAvx2;
+        findLineBreak = findLineBreakAvx2;
+        break;
+    case QXdgSimdLevel::Sse2:
+        findSpecial = findSpecialSse2;
+        findLineBreak = findLineBreakSse2;
+        break;
+#endif // QXDG_TOKENIZER_X86
+    default:
+        findSpecial = findSpecialScalar;
+        findLineBreak = findLineBreakScalar;
+        break;
+    }
+
+    currentSimdLevel = level;
+    return true;
+}
+
+// Select the implementation once at startup.
+static const bool simdLevelInitialized = qxdgSetTokenizerSimdLevel(qxdgBestTokenizerSimdLevel());
+
+// With StopAtComments, a comment line is returned like any other line and \a isComment gets set, instead of
+// being skipped. After a comment readLineFromData() goes on with the next line in the same run, which only
+// skips line terminators, so \a skipSpaces must be false for the line following a comment to match it.
+template <bool StopAtComments>
+static inline bool readLine(const char *data, int dataLen, int &dataPos, int &lineStart, int &lineLen, int &equalsPos,
+                            bool skipSpaces, bool *isComment)
+{
+    equalsPos = -1;
+
+    lineStart = dataPos;
+    while (skipSpaces && lineStart < dataLen && (charTraits[uint(uchar(data[lineStart]))] & Space))
+        ++lineStart;
+
+    int i = lineStart;
+    while (i < dataLen) {
+        i = int(findSpecial(data + i, data + dataLen) - data);
+        if (i == dataLen)
+            break;
+
+        char ch = data[i++];
+        if (ch == '=') {
+            if (equalsPos == -1)
+                equalsPos = i - 1;
+        } else if (ch == '\n' || ch == '\r') {
+            if (i == lineStart + 1) {
+                ++lineStart;
+            } else {
+                --i;
+                break;
+            }
+        } else if (ch == '\\') {
+            if (i < dataLen) {
+                char ch = data[i++];
+                if (i < dataLen) {
+                    char ch2 = data[i];
+                    // \n, \r, \r\n, and \n\r are legitimate line terminators in INI files
+                    if ((ch == '\n' && ch2 == '\r') || (ch == '\r' && ch2 == '\n'))
+                        ++i;
+                }
+            }
+        } else if (ch == ';') {
+            // The multiple values should be separated by a semicolon and the value of the key
+            // may be optionally terminated by a semicolon. Trailing empty strings must always
+            // be terminated with a semicolon. Semicolons in these values need to be escaped
+            // using \; .
+            // Don't need to do anything here.
+        } else {
+            Q_ASSERT(ch == '#');
+
+            if (i == lineStart + 1) {
+                i = int(findLineBreak(data + i, data + dataLen) - data);
+                if (StopAtComments) {
+                    *isComment = true;
+                    break;
+                }
+                lineStart = i;
+            }
+        }
+    }
+
+    dataPos = i;
+    lineLen = i - lineStart;
+    return lineLen > 0;
+}
+
+bool readLineFromData(const char *data, int dataLen, int &dataPos, int &lineStart, int &lineLen, int &equalsPos)
+{
+    return readLine<false>(data, dataLen, dataPos, lineStart, lineLen, equalsPos, true, nullptr);
+}
+
+// Same as readLineFromData(), but comment lines are returned too, with \a isComment set. Pass the \a isComment
+// of the previous line back in, it decides where the next line starts.
+bool readLineOrCommentFromData(const char *data, int dataLen, int &dataPos, int &lineStart, int &lineLen,
+                               int &equalsPos, bool &isComment)
+{
+    const bool afterComment = isComment;
+    isComment = false;
+    return readLine<true>(data, dataLen, dataPos, lineStart, lineLen, equalsPos, !afterComment, &isComment);
+}
+
+// Returns the position of the line terminator that ends the line starting at \a from, or \a dataLen if the
+// line ends with the data. Follows the same rules as readLineFromData(): a terminator escaped by a backslash
+// (including the \r\n and \n\r pairs) doesn't end the line.
+static int findLineEnd(const char *data, int dataLen, int from, bool hasCarriageReturn)
+{
+    const char *end = data + dataLen;
+    const char *p = data + from;
+
+    while (p < end) {
+        const char *terminator;
+        if (hasCarriageReturn) {
+            terminator = findLineBreak(p, end);
+        } else {
+            terminator = static_cast<const char *>(memchr(p, '\n', size_t(end - p)));
+            if (!terminator)
+                terminator = end;
+        }
+
+        if (terminator == end)
+            break;
+
+        // Escapes are paired from the start of a backslash run, so only an odd run escapes the terminator.
+        const char *run = terminator;
+        while (run > p && run[-1] == '\\')
+            --run;
+        if ((terminator - run) % 2 == 0)
+            return int(terminator - data);
+
+        p = terminator + 1;
+        if (p < end && ((*terminator == '\n' && *p == '\r') || (*terminator == '\r' && *p == '\n')))
+            ++p;
+    }
+
+    return dataLen;
+}
+
+// Returns the start of the first group header line at or after \a pos, or \a dataLen if there is none. \a pos
+// must be where readLineFromData() would start reading the next line. Only the line starts are inspected, the
+// rest of each line gets skipped with memchr() or the vectorized finders.
+int findGroupHeaderInData(const char *data, int dataLen, int pos, bool hasCarriageReturn)
+{
+    while (pos < dataLen) {
+        while (pos < dataLen && (charTraits[uint(uchar(data[pos]))] & Space))
+            ++pos;
+
+        // A comment line only ends at its line terminator, and readLineFromData() continues with the next
+        // line right away, skipping line terminators but NOT other white spaces.
+        while (pos < dataLen && data[pos] == '#') {
+            pos = int(findLineBreak(data + pos, data + dataLen) - data);
+            while (pos < dataLen && (data[pos] == '\n' || data[pos] == '\r'))
+                ++pos;
+        }
+
+        if (pos >= dataLen)
+            break;
+
+        if (data[pos] == '[')
+            return pos;
+        pos = findLineEnd(data, dataLen, pos, hasCarriageReturn);
+    }
+
+    return dataLen;
+}
+
+// Collect the group header lines of \a data. This gives the same result as checking every line read by
+// readLineFromData() for a leading '[', but a lot faster, see findGroupHeaderInData(). Stops once
+// \a maxHeaders headers are found, if it's not -1.
+QVector<QXdgDesktopEntryGroupHeader> readGroupHeadersFromData(const char *data, int dataLen, int maxHeaders)
+{
+    QVector<QXdgDesktopEntryGroupHeader> headers;
+    const bool hasCarriageReturn = memchr(data, '\r', size_t(dataLen)) != nullptr;
+    int pos = 0;
+
+    while ((pos = findGroupHeaderInData(data, dataLen, pos, hasCarriageReturn)) < dataLen) {
+        const int lineEnd = findLineEnd(data, dataLen, pos, hasCarriageReturn);
+        headers.append({pos, lineEnd - pos});
+        if (headers.count() == maxHeaders)
+            break;
+        pos = lineEnd;
+    }
+
+    return headers;
+}
@@ -0,0 +1,76 @@
+/*
+ * Copyright (C) 2019 Deepin Technology Co., Ltd.
+ *               2019 Gary Wang
+ *
+ * Author:     Gary Wang <wzc782970009@gmail.com>
+ *
+ * Maintainer: Gary Wang <wzc782970009@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QXDGDESKTOPENTRYTOKENIZER_P_H
+#define QXDGDESKTOPENTRYTOKENIZER_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the QXdg API. It exists purely as an
+// implementation detail. This header file may change from version to
+// version without notice, or even be removed.
+//
+
+#include <QVector>
+
+/*! \internal */
+struct QXdgDesktopEntryGroupHeader
+{
+    int lineStart;
+    int lineLen;
+};
+
+/*! \internal */
+enum class QXdgSimdLevel {
+    Scalar,
+    Sse2,
+    Avx2
+};
+
+bool readLineFromData(const char *data, int dataLen, int &dataPos, int &lineStart, int &lineLen, int &equalsPos);
+bool readLineOrCommentFromData(const char *data, int dataLen, int &dataPos, int &lineStart, int &lineLen,
+                               int &equalsPos, bool &isComment);
+int findGroupHeaderInData(const char *data, int dataLen, int pos, bool hasCarriageReturn);
+QVector<QXdgDesktopEntryGroupHeader> readGroupHeadersFromData(const char *data, int dataLen, int maxHeaders = -1);
+
+// The tokenizer picks the best implementation the CPU supports at startup, the setter is only meant to be
+// used for testing. Returns false if the CPU doesn't support the given level.
+QXdgSimdLevel qxdgTokenizerSimdLevel();
+bool qxdgSetTokenizerSimdLevel(QXdgSimdLevel level);
+QXdgSimdLevel qxdgBestTokenizerSimdLevel();
+
+// Same white space set as QByteArray::trimmed(), but works on a range so we don't need to copy the bytes.
+static inline void trimRange(const char *data, int &start, int &length)
+{
+    auto isSpace = [](char ch) { return ch == ' ' || (ch >= '\t' && ch <= '\r'); };
+
+    while (length > 0 && isSpace(data[start])) {
+        ++start;
+        --length;
+    }
+    while (length > 0 && isSpace(data[start + length - 1]))
+        --length;
+}
+
+#endif // QXDGDESKTOPENTRYTOKENIZER_P_H
@@ -0,0 +1,361 @@
+/*
+ * Copyright (C) 2019 Deepin Technology Co., Ltd.
+ *               2019 Gary Wang
+ *
+ * Author:     Gary Wang <wzc782970009@gmail.com>
+ *
+ * Maintainer: Gary Wang <wzc782970009@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "qxdgdesktopentrytransaction.h"
+#include "qxdgdesktopentry_p.h"
+
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QSet>
+#include <QTemporaryFile>
+#include <QVector>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+struct StagedFile
+{
+    // The entry is kept alive by QXdgDesktopEntryTransactionPrivate::entries.
+    const QXdgDesktopEntryPrivate *entry = nullptr;
+    QString filePath;
+    QString tempPath;
+    // Hard link to the file which gets replaced, empty if there was none.
+    QString backupPath;
+    bool replaced = false;
+    // The backup couldn't be renamed back, it's the only copy of the old content now.
+    bool backupKept = false;
+};
+
+} // namespace
+
+/*! \internal */
+class QXdgDesktopEntryTransactionPrivate
+{
+public:
+    bool fail(const QString &error, const QString &filePath) {
+        errorString = filePath.isEmpty() ? error : QStringLiteral("%1: %2").arg(filePath, error);
+        return false;
+    }
+    bool failWithErrno(const QString &filePath) {
+        return fail(QString::fromLocal8Bit(strerror(errno)), filePath);
+    }
+
+    bool writeTemporaryFile(StagedFile &file);
+    bool syncFileSystems(const QSet<QString> &directories);
+    bool syncDirectories(const QSet<QString> &directories);
+    void rollback(QVector<StagedFile> &files);
+    void removeLeftovers(const QVector<StagedFile> &files);
+
+    QVector<QXdgDesktopEntry> entries;
+    QString errorString;
+};
+
+// Writes the new content next to the file it will replace, so renaming it over the file is atomic.
+bool QXdgDesktopEntryTransactionPrivate::writeTemporaryFile(StagedFile &file)
+{
+    const QFileInfo fileInfo(file.filePath);
+    if (!QDir().mkpath(fileInfo.absolutePath())) {
+        return fail(QStringLiteral("Can't create the directory"), file.filePath);
+    }
+
+    QTemporaryFile temp(fileInfo.absolutePath() + QLatin1String("/.") + fileInfo.fileName() + QLatin1String(".XXXXXX"));
+    temp.setAutoRemove(false);
+    if (!temp.open()) {
+        return fail(temp.errorString(), file.filePath);
+    }
+    file.tempPath = temp.fileName();
+
+    QFile::Permissions permissions = QFile::ReadOwner | QFile::WriteOwner | QFile::ReadGroup | QFile::ReadOther;
+    if (fileInfo.exists()) {
+        permissions = fileInfo.permissions();
+    }
+    const QByteArray content = file.entry->serialize();
+    if (!temp.setPermissions(permissions) || temp.write(content) != content.size() || !temp.flush()) {
+        return fail(temp.errorString(), file.filePath);
+    }
+
+#ifndef Q_OS_LINUX
+    // there's no syncfs(), see syncFileSystems().
+    if (fsync(temp.handle()) != 0) {
+        return failWithErrno(file.filePath);
+    }
+#endif
+
+    return true;
+}
+
+// Makes the content of the written files durable. One syncfs() per file system is much cheaper than an fsync()
+// per file when there are lots of them.
+bool QXdgDesktopEntryTransactionPrivate::syncFileSystems(const QSet<QString> &directories)
+{
+#ifdef Q_OS_LINUX
+    QSet<dev_t> synced;
+    for (const QString &directory : directories) {
+        const int fd = open(QFile::encodeName(directory).constData(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (fd == -1) {
+            return failWithErrno(directory);
+        }
+
+        struct stat status;
+        bool ok = fstat(fd, &status) == 0;
+        if (ok && !synced.contains(status.st_dev)) {
+            ok = syncfs(fd) == 0;
+            synced.insert(status.st_dev);
+        }
+        const int error = errno;
+        close(fd);
+        if (!ok) {
+            errno = error;
+            return failWithErrno(directory);
+        }
+    }
+#else
+    Q_UNUSED(directories)
+#endif
+    return true;
+}
+
+// Makes the renames durable, with one fsync() per directory.
+bool QXdgDesktopEntryTransactionPrivate::syncDirectories(const QSet<QString> &directories)
+{
+    for (const QString &directory : directories) {
+        const int fd = open(QFile::encodeName(directory).constData(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (fd == -1) {
+            return failWithErrno(directory);
+        }
+        const bool ok = fsync(fd) == 0;
+        const int error = errno;
+        close(fd);
+        if (!ok) {
+            errno = error;
+            return failWithErrno(directory);
+        }
+    }
+    return true;
+}
+
+// Puts back the files which were already replaced, and removes the ones which didn't exist before. A backup
+// which can't be put back stays on disk, and errorString tells where it is.
+void QXdgDesktopEntryTransactionPrivate::rollback(QVector<StagedFile> &files)
+{
+    for (int i = files.count() - 1; i >= 0; i--) {
+        StagedFile &file = files[i];
+        if (!file.replaced) continue;
+
+        const QByteArray filePath = QFile::encodeName(file.filePath);
+        if (file.backupPath.isEmpty()) {
+            unlink(filePath.constData());
+        } else if (rename(QFile::encodeName(file.backupPath).constData(), filePath.constData()) == 0) {
+            file.backupPath.clear();
+        } else {
+            file.backupKept = true;
+            errorString += QStringLiteral("; can't restore %1 (%2), its previous content is kept in %3")
+                    .arg(file.filePath, QString::fromLocal8Bit(strerror(errno)), file.backupPath);
+        }
+        file.replaced = false;
+    }
+}
+
+void QXdgDesktopEntryTransactionPrivate::removeLeftovers(const QVector<StagedFile> &files)
+{
+    for (const StagedFile &file : files) {
+        if (!file.replaced && !file.tempPath.isEmpty()) {
+            unlink(QFile::encodeName(file.tempPath).constData());
+        }
+        if (!file.backupPath.isEmpty() && !file.backupKept) {
+            unlink(QFile::encodeName(file.backupPath).constData());
+        }
+    }
+}
+
+/*!
+ * \class QXdgDesktopEntryTransaction
+ * \brief Saves lots of desktop entries at once, either all of them or none.
+ *
+ * Saving every entry with QXdgDesktopEntry::save() syncs and renames the files one by one, and a failure in the
+ * middle leaves some of them changed. A transaction writes all the new files first, syncs them once per file
+ * system, and then renames them over the old ones. If any step fails, the files which were already replaced
+ * are restored, so either all entries are saved, or none is.
+ *
+ * \code
+ * QXdgDesktopEntryTransaction transaction;
+ * for (QXdgDesktopEntry &entry : entries) {
+ *     entry.setRawValue("true", "NoDisplay");
+ *     transaction.add(entry);
+ * }
+ * if (!transaction.commit()) {
+ *     qWarning() << transaction.errorString();
+ * }
+ * \endcode
+ *
+ * The old files are kept as hard links until the end, so the file system must support them.
+ */
+
+QXdgDesktopEntryTransaction::QXdgDesktopEntryTransaction()
+    : d_ptr(new QXdgDesktopEntryTransactionPrivate)
+{
+
+}
+
+QXdgDesktopEntryTransaction::~QXdgDesktopEntryTransaction()
+{
+
+}
+
+/*!
+ * \brief Adds \a entry to the entries which get saved by commit().
+ *
+ * The entry is implicitly shared, modifying it after adding it doesn't change what gets saved. Adding another
+ * entry of the same file replaces the one added before.
+ */
+void QXdgDesktopEntryTransaction::add(const QXdgDesktopEntry &entry)
+{
+    Q_D(QXdgDesktopEntryTransaction);
+    const QString filePath = entry.d_func()->filePath;
+    for (int i = 0; !filePath.isEmpty() && i < d->entries.count(); i++) {
+        if (d->entries.at(i).d_func()->filePath == filePath) {
+            d->entries[i] = entry;
+            return;
+        }
+    }
+    d->entries.append(entry);
+}
+
+/*!
+ * \brief Returns the number of entries which were added and not committed yet.
+ */
+int QXdgDesktopEntryTransaction::count() const
+{
+    Q_D(const QXdgDesktopEntryTransaction);
+    return d->entries.count();
+}
+
+/*!
+ * \brief Forgets all entries which were added, without saving them.
+ */
+void QXdgDesktopEntryTransaction::clear()
+{
+    Q_D(QXdgDesktopEntryTransaction);
+    d->entries.clear();
+}
+
+/*!
+ * \brief Saves every added entry which was modified, then forgets them.
+ *
+ * Returns false if any of them couldn't be saved, and the entries stay added. The files are put back as they
+ * were then, see errorString() for what went wrong. A file which couldn't be put back keeps the new content,
+ * its previous content is kept in a backup file next to it, and errorString() has the path of the backup.
+ * Entries which were only partially loaded, or which are not associated with a file, make the whole transaction
+ * fail before anything is written.
+ */
+bool QXdgDesktopEntryTransaction::commit()
+{
+    Q_D(QXdgDesktopEntryTransaction);
+    d->errorString.clear();
+
+    QVector<StagedFile> files;
+    QSet<QString> directories;
+    for (const QXdgDesktopEntry &entry : qAsConst(d->entries)) {
+        const QXdgDesktopEntryPrivate *entryPrivate = entry.d_func();
+        if (entryPrivate->filePath.isEmpty()) {
+            return d->fail(QStringLiteral("The entry is not associated with a file"), QString());
+        }
+        if (entryPrivate->partial) {
+            return d->fail(QStringLiteral("The entry was only partially loaded"), entryPrivate->filePath);
+        }
+        if (!entryPrivate->isModified()) continue;
+
+        StagedFile file;
+        file.entry = entryPrivate;
+        file.filePath = QFileInfo(entryPrivate->filePath).absoluteFilePath();
+        directories.insert(QFileInfo(file.filePath).absolutePath());
+        files.append(file);
+    }
+
+    QElapsedTimer timer;
+    if (QXdgStatsPrivate::isEnabled() && !files.isEmpty()) {
+        timer.start();
+    }
+
+    bool ok = true;
+    for (int i = 0; ok && i < files.count(); i++) {
+        ok = d->writeTemporaryFile(files[i]);
+    }
+    ok = ok && d->syncFileSystems(directories);
+
+    // Keep the files which get replaced, until every rename is done.
+    for (int i = 0; ok && i < files.count(); i++) {
+        StagedFile &file = files[i];
+        if (!QFileInfo::exists(file.filePath)) continue;
+        file.backupPath = file.tempPath + QLatin1String(".orig");
+        if (link(QFile::encodeName(file.filePath).constData(), QFile::encodeName(file.backupPath).constData()) != 0) {
+            file.backupPath.clear();
+            ok = d->failWithErrno(file.filePath);
+        }
+    }
+
+    for (int i = 0; ok && i < files.count(); i++) {
+        StagedFile &file = files[i];
+        if (rename(QFile::encodeName(file.tempPath).constData(), QFile::encodeName(file.filePath).constData()) != 0) {
+            ok = d->failWithErrno(file.filePath);
+        } else {
+            file.replaced = true;
+        }
+    }
+
+    if (!ok) {
+        d->rollback(files);
+        d->removeLeftovers(files);
+        return false;
+    }
+
+    d->removeLeftovers(files);
+    // The renames are done, failing to sync them doesn't make the transaction fail anymore.
+    d->syncDirectories(directories);
+
+    for (const StagedFile &file : qAsConst(files)) {
+        file.entry->markSaved();
+    }
+    d->entries.clear();
+    // one save for the whole transaction, it's what the caller waited for.
+    if (timer.isValid()) {
+        QXdgStatsPrivate::recordSave(quint64(timer.nsecsElapsed()));
+    }
+    return true;
+}
+
+/*!
+ * \brief Returns a description of why the last commit() failed.
+ */
+QString QXdgDesktopEntryTransaction::errorString() const
+{
+    Q_D(const QXdgDesktopEntryTransaction);
+    return d->errorString;
+}
@@ -0,0 +1,52 @@
+/*
+ * Copyright (C) 2019 Deepin Technology Co., Ltd.
+ *               2019 Gary Wang
+ *
+ * Author:     Gary Wang <wzc782970009@gmail.com>
+ *
+ * Maintainer: Gary Wang <wzc782970009@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QXDGDESKTOPENTRYTRANSACTION_H
+#define QXDGDESKTOPENTRYTRANSACTION_H
+
+#include "qxdg_global.h"
+#include "qxdgdesktopentry.h"
+
+#include <QScopedPointer>
+
+class QXdgDesktopEntryTransactionPrivate;
+class QXDGSHARED_EXPORT QXdgDesktopEntryTransaction
+{
+public:
+    QXdgDesktopEntryTransaction();
+    ~QXdgDesktopEntryTransaction();
+
+    void add(const QXdgDesktopEntry &entry);
+    int count() const;
+    void clear();
+
+    bool commit();
+    QString errorString() const;
+
+private:
+    QScopedPointer<QXdgDesktopEntryTransactionPrivate> d_ptr;
+
+    Q_DECLARE_PRIVATE(QXdgDesktopEntryTransaction)
+    Q_DISABLE_COPY(QXdgDesktopEntryTransaction)
+};
+
+#endif // QXDGDESKTOPENTRYTRANSACTION_H
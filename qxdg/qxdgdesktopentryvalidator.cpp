@@ -0,0 +1,606 @@
+/*
+ * Copyright (C) 2019 Deepin Technology Co., Ltd.
+ *               2019 Gary Wang
+ *
+ * Author:     Gary Wang <wzc782970009@gmail.com>
+ *
+ * Maintainer: Gary Wang <wzc782970009@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "qxdgdesktopentryvalidator.h"
+#include "qxdgdesktopentry_p.h"
+#include "qxdgdesktopentryexec.h"
+#include "qxdgdesktopentryreader.h"
+
+#include <QAtomicInt>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QRunnable>
+#include <QThread>
+#include <QThreadPool>
+
+#include <algorithm>
+
+/*! \internal */
+class QXdgDesktopEntryValidatorPrivate
+{
+public:
+    int maxThreadCount = QThread::idealThreadCount();
+};
+
+namespace {
+
+typedef QXdgDesktopEntryDiagnostic Diagnostic;
+
+// Keys which are still found in old files, the spec deprecated them.
+static const char * const deprecatedKeys[] = {
+    "Encoding", "MiniIcon", "TerminalOptions", "Protocols", "Extensions", "BinaryPattern", "MapNotify",
+    "SwallowTitle", "SwallowExec", "SortOrder", "FilePattern"
+};
+
+static bool isDeprecatedKey(QXdgByteArrayView key)
+{
+    for (const char *deprecatedKey : deprecatedKeys) {
+        if (key == deprecatedKey) return true;
+    }
+    return false;
+}
+
+static bool startsWith(QXdgByteArrayView view, const char *prefix)
+{
+    const int length = int(strlen(prefix));
+    return view.size() >= length && memcmp(view.data(), prefix, size_t(length)) == 0;
+}
+
+static bool isValidKeyName(QXdgByteArrayView key)
+{
+    if (key.isEmpty()) return false;
+    for (int i = 0; i < key.size(); i++) {
+        const char ch = key.data()[i];
+        if (!((ch >= 'A' && ch <= 'Z') || (ch >= 'a' && ch <= 'z') || (ch >= '0' && ch <= '9') || ch == '-')) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// lang_COUNTRY.ENCODING@MODIFIER
+static bool isValidLocale(QXdgByteArrayView locale)
+{
+    if (locale.isEmpty()) return false;
+    for (int i = 0; i < locale.size(); i++) {
+        const char ch = locale.data()[i];
+        if (!((ch >= 'A' && ch <= 'Z') || (ch >= 'a' && ch <= 'z') || (ch >= '0' && ch <= '9')
+              || ch == '_' || ch == '.' || ch == '@' || ch == '-')) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Returns the length of the valid UTF-8 sequence at \a pos, or 0 if it isn't valid.
+static int utf8SequenceLength(const uchar *data, int pos, int length)
+{
+    const uchar lead = data[pos];
+    if (lead < 0x80) return 1;
+
+    const int extra = lead >= 0xf0 ? 3 : lead >= 0xe0 ? 2 : lead >= 0xc0 ? 1 : -1;
+    if (extra <= 0 || lead >= 0xf5 || length - pos <= extra) return 0;
+
+    uint ucs = extra == 3 ? lead & 0x07 : extra == 2 ? lead & 0x0f : lead & 0x1f;
+    for (int i = 1; i <= extra; i++) {
+        if ((data[pos + i] & 0xc0) != 0x80) return 0;
+        ucs = (ucs << 6) | (data[pos + i] & 0x3f);
+    }
+    // overlong forms, surrogates and code points out of range.
+    static const uint minimum[4] = { 0, 0x80, 0x800, 0x10000 };
+    if (ucs < minimum[extra] || ucs > 0x10ffff || (ucs >= 0xd800 && ucs <= 0xdfff)) return 0;
+    return extra + 1;
+}
+
+// Checks a single file, everything is reported at the position of the token it is about.
+class Validator
+{
+public:
+    Validator(const QByteArray &data, const QString &filePath, QVector<Diagnostic> *diagnostics);
+    void run();
+
+private:
+    enum GroupKind {
+        NoGroup,
+        DesktopEntryGroup,
+        ActionGroup,
+        ExtensionGroup,
+        UnknownGroup
+    };
+
+    int offsetOf(QXdgByteArrayView view) const {
+        return int(view.data() - data.constData());
+    }
+    void report(int offset, Diagnostic::Severity severity, const QString &message);
+    void checkUtf8();
+    void checkGroupHeader(const QXdgDesktopEntryReader &reader);
+    void checkKeyValue(const QXdgDesktopEntryReader &reader);
+    void checkValue(QXdgByteArrayView key, QXdgDesktopEntry::ValueType type, QXdgByteArrayView value);
+    void checkDesktopEntry();
+
+    const QByteArray &data;
+    const QString filePath;
+    QVector<Diagnostic> *diagnostics;
+    QVector<int> lineStarts;
+
+    // offsets of the group headers, by name.
+    QHash<QByteArray, int> groups;
+    GroupKind groupKind = NoGroup;
+    // offsets of the keys of the current group, by key.
+    QHash<QByteArray, int> keys;
+    // what the final checks need from the [Desktop Entry] group.
+    int desktopEntryOffset = -1;
+    QHash<QByteArray, QXdgByteArrayView> desktopEntryValues;
+};
+
+Validator::Validator(const QByteArray &data, const QString &filePath, QVector<Diagnostic> *diagnostics)
+    : data(data), filePath(filePath), diagnostics(diagnostics)
+{
+    lineStarts.append(0);
+    const char *begin = data.constData();
+    const char *end = begin + data.size();
+    for (const char *p = begin; (p = static_cast<const char *>(memchr(p, '\n', size_t(end - p)))); p++) {
+        lineStarts.append(int(p - begin) + 1);
+    }
+}
+
+void Validator::report(int offset, Diagnostic::Severity severity, const QString &message)
+{
+    Diagnostic diagnostic;
+    diagnostic.filePath = filePath;
+    if (offset >= 0) {
+        const int line = int(std::upper_bound(lineStarts.constBegin(), lineStarts.constEnd(), offset) - lineStarts.constBegin());
+        diagnostic.line = line;
+        diagnostic.column = offset - lineStarts[line - 1] + 1;
+    }
+    diagnostic.severity = severity;
+    diagnostic.message = message;
+    diagnostics->append(diagnostic);
+}
+
+void Validator::run()
+{
+    const int firstDiagnostic = diagnostics->count();
+    checkUtf8();
+
+    QXdgDesktopEntryReader reader(data);
+    for (;;) {
+        const QXdgDesktopEntryReader::TokenType tokenType = reader.readNext();
+        if (tokenType == QXdgDesktopEntryReader::EndDocument) break;
+
+        switch (tokenType) {
+        case QXdgDesktopEntryReader::GroupStart:
+            checkGroupHeader(reader);
+            break;
+        case QXdgDesktopEntryReader::KeyValue:
+            checkKeyValue(reader);
+            break;
+        case QXdgDesktopEntryReader::InvalidLine:
+            report(reader.tokenOffset(), Diagnostic::Error,
+                   QStringLiteral("Invalid line, expected a group header, a key-value pair or a comment"));
+            break;
+        default:
+            break;
+        }
+    }
+
+    checkDesktopEntry();
+
+    // the UTF-8 problems were found first.
+    std::stable_sort(diagnostics->begin() + firstDiagnostic, diagnostics->end(), [](const Diagnostic &a, const Diagnostic &b) {
+        return a.line != b.line ? a.line < b.line : a.column < b.column;
+    });
+}
+
+// One problem per line is enough, a broken encoding tends to break everything after it.
+void Validator::checkUtf8()
+{
+    const uchar *bytes = reinterpret_cast<const uchar *>(data.constData());
+    const int length = data.size();
+    for (int pos = 0; pos < length;) {
+        const int sequenceLength = utf8SequenceLength(bytes, pos, length);
+        if (sequenceLength) {
+            pos += sequenceLength;
+            continue;
+        }
+
+        report(pos, Diagnostic::Error, QStringLiteral("Invalid UTF-8 sequence"));
+        const void *lineBreak = memchr(bytes + pos, '\n', size_t(length - pos));
+        pos = lineBreak ? int(static_cast<const uchar *>(lineBreak) - bytes) + 1 : length;
+    }
+}
+
+void Validator::checkGroupHeader(const QXdgDesktopEntryReader &reader)
+{
+    const int offset = reader.tokenOffset();
+    const QXdgByteArrayView raw = reader.rawToken();
+    const QXdgByteArrayView name = reader.groupName();
+    const QByteArray groupName = name.toByteArray();
+    keys.clear();
+
+    const char *closeBracket = static_cast<const char *>(memchr(raw.data(), ']', size_t(raw.size())));
+    if (!closeBracket) {
+        report(offset + raw.size(), Diagnostic::Error, QStringLiteral("The group header is missing its ']'"));
+    } else {
+        for (const char *p = closeBracket + 1; p < raw.data() + raw.size(); p++) {
+            if (*p != ' ' && *p != '\t' && *p != '\r') {
+                report(offsetOf(QXdgByteArrayView(p, 0)), Diagnostic::Error,
+                       QStringLiteral("Unexpected text after the group header"));
+                break;
+            }
+        }
+    }
+
+    groupKind = UnknownGroup;
+    if (name.isEmpty()) {
+        report(offset, Diagnostic::Error, QStringLiteral("Empty group name"));
+    } else {
+        for (int i = 0; i < name.size(); i++) {
+            const uchar ch = uchar(name.data()[i]);
+            if (ch < 0x20 || ch == 0x7f || ch == '[' || ch == ']') {
+                report(offsetOf(name) + i, Diagnostic::Error, QStringLiteral("Invalid character in the group name"));
+                break;
+            }
+        }
+
+        if (name == "Desktop Entry") {
+            groupKind = DesktopEntryGroup;
+        } else if (startsWith(name, "Desktop Action ") && name.size() > 15) {
+            groupKind = ActionGroup;
+        } else if (startsWith(name, "X-")) {
+            groupKind = ExtensionGroup;
+        } else {
+            report(offset, Diagnostic::Error,
+                   QStringLiteral("Unknown group [%1], groups extending the format must start with X-").arg(name.toString()));
+        }
+    }
+
+    if (groups.isEmpty() && groupKind != DesktopEntryGroup) {
+        report(offset, Diagnostic::Error, QStringLiteral("The first group must be [Desktop Entry]"));
+    }
+
+    const QHash<QByteArray, int>::const_iterator it = groups.constFind(groupName);
+    if (it != groups.constEnd()) {
+        report(offset, Diagnostic::Error, QStringLiteral("Duplicate group [%1], the first one is at line %2")
+               .arg(name.toString()).arg(std::upper_bound(lineStarts.constBegin(), lineStarts.constEnd(), it.value())
+                                          - lineStarts.constBegin()));
+        // its keys are not the ones of the first group, don't let them count for the final checks.
+        if (groupKind == DesktopEntryGroup) {
+            groupKind = ExtensionGroup;
+        }
+        return;
+    }
+
+    groups.insert(groupName, offset);
+    if (groupKind == DesktopEntryGroup) {
+        desktopEntryOffset = offset;
+    }
+}
+
+void Validator::checkKeyValue(const QXdgDesktopEntryReader &reader)
+{
+    const QXdgByteArrayView key = reader.key();
+    const QXdgByteArrayView baseKey = reader.baseKey();
+    const QXdgByteArrayView locale = reader.locale();
+    const QXdgByteArrayView value = reader.value();
+    const int offset = offsetOf(key);
+
+    if (groupKind == NoGroup) {
+        report(offset, Diagnostic::Error, QStringLiteral("Key-value pair outside of any group"));
+        return;
+    }
+
+    if (!isValidKeyName(baseKey)) {
+        report(offset, Diagnostic::Error, QStringLiteral("Invalid key name %1, only A-Za-z0-9- may be used")
+               .arg(key.toString()));
+        return;
+    }
+    if (baseKey.size() != key.size() && !isValidLocale(locale)) {
+        report(offsetOf(locale), Diagnostic::Error, QStringLiteral("Invalid locale %1").arg(locale.toString()));
+    }
+
+    const QByteArray keyName = key.toByteArray();
+    const QHash<QByteArray, int>::const_iterator it = keys.constFind(keyName);
+    if (it != keys.constEnd()) {
+        report(offset, Diagnostic::Error, QStringLiteral("Duplicate key %1, the first one is at line %2")
+               .arg(key.toString()).arg(std::upper_bound(lineStarts.constBegin(), lineStarts.constEnd(), it.value())
+                                        - lineStarts.constBegin()));
+        return;
+    }
+    keys.insert(keyName, offset);
+
+    // extension groups and keys are free-form.
+    if (groupKind == ExtensionGroup || groupKind == UnknownGroup || startsWith(baseKey, "X-")) {
+        return;
+    }
+
+    if (groupKind == DesktopEntryGroup) {
+        desktopEntryValues.insert(keyName, value);
+    }
+
+    const QXdgKeyAtom atom = QXdgKeyAtomTable::find(baseKey.data(), baseKey.size());
+    const QXdgDesktopEntry::ValueType type = qxdgWellKnownKeyType(atom);
+    const bool knownInGroup = groupKind == DesktopEntryGroup
+            ? type != QXdgDesktopEntry::NotExisted
+            : atom == QXdgKeyAtomTable::Name || atom == QXdgKeyAtomTable::Icon || atom == QXdgKeyAtomTable::Exec;
+    if (!knownInGroup) {
+        if (groupKind == DesktopEntryGroup && isDeprecatedKey(baseKey)) {
+            report(offset, Diagnostic::Warning, QStringLiteral("The key %1 is deprecated").arg(baseKey.toString()));
+        } else {
+            report(offset, Diagnostic::Error, QStringLiteral("Unknown key %1, keys extending the format must start with X-")
+                   .arg(baseKey.toString()));
+        }
+        return;
+    }
+
+    if (baseKey.size() != key.size() && atom != QXdgKeyAtomTable::Name && atom != QXdgKeyAtomTable::GenericName
+            && atom != QXdgKeyAtomTable::Comment && atom != QXdgKeyAtomTable::Keywords && atom != QXdgKeyAtomTable::Icon) {
+        report(offset, Diagnostic::Warning, QStringLiteral("The key %1 can't be localized").arg(baseKey.toString()));
+    }
+
+    checkValue(baseKey, type, value);
+}
+
+void Validator::checkValue(QXdgByteArrayView key, QXdgDesktopEntry::ValueType type, QXdgByteArrayView value)
+{
+    const int offset = offsetOf(value);
+
+    if (type == QXdgDesktopEntry::Boolean) {
+        if (value == "0" || value == "1") {
+            report(offset, Diagnostic::Warning, QStringLiteral("Boolean value of %1 should be true or false, not %2")
+                   .arg(key.toString(), value.toString()));
+        } else if (value != "true" && value != "false") {
+            report(offset, Diagnostic::Error, QStringLiteral("Invalid boolean value %1 for %2, must be true or false")
+                   .arg(value.toString(), key.toString()));
+        }
+    } else if (key == "Type" && groupKind == DesktopEntryGroup) {
+        if (value == "ServiceType" || value == "Service" || value == "FSDevice") {
+            report(offset, Diagnostic::Warning, QStringLiteral("The Type %1 is KDE specific").arg(value.toString()));
+        } else if (value != "Application" && value != "Link" && value != "Directory") {
+            report(offset, Diagnostic::Error, QStringLiteral("Unknown Type %1, must be Application, Link or Directory")
+                   .arg(value.toString()));
+        }
+    } else if (key == "Exec") {
+        const QXdgDesktopEntryExec exec(value.toString());
+        if (!exec.isValid()) {
+            report(offset, Diagnostic::Error, exec.errorString());
+        }
+    }
+}
+
+// What can only be checked once the whole file was read.
+void Validator::checkDesktopEntry()
+{
+    if (desktopEntryOffset == -1) {
+        report(-1, Diagnostic::Error, QStringLiteral("The file has no [Desktop Entry] group"));
+        return;
+    }
+
+    const QXdgByteArrayView type = desktopEntryValues.value("Type");
+    if (!desktopEntryValues.contains("Type")) {
+        report(desktopEntryOffset, Diagnostic::Error, QStringLiteral("The required key Type is missing"));
+    }
+    if (!desktopEntryValues.contains("Name")) {
+        report(desktopEntryOffset, Diagnostic::Error, QStringLiteral("The required key Name is missing"));
+    }
+    if (type == "Application" && !desktopEntryValues.contains("Exec")
+            && desktopEntryValues.value("DBusActivatable") != "true") {
+        report(desktopEntryOffset, Diagnostic::Error,
+               QStringLiteral("Applications need an Exec key, unless they are DBusActivatable"));
+    }
+    if (type == "Link" && !desktopEntryValues.contains("URL")) {
+        report(desktopEntryOffset, Diagnostic::Error, QStringLiteral("Links need an URL key"));
+    }
+
+    // every action needs its group, and groups of actions which are not listed are useless.
+    QHash<QByteArray, int> actionGroups;
+    for (QHash<QByteArray, int>::const_iterator it = groups.constBegin(); it != groups.constEnd(); ++it) {
+        if (it.key().startsWith("Desktop Action ")) {
+            actionGroups.insert(it.key().mid(15), it.value());
+        }
+    }
+    const QXdgByteArrayView actions = desktopEntryValues.value("Actions");
+    int itemStart = 0;
+    for (int i = 0; i <= actions.size(); i++) {
+        if (i < actions.size() && actions.data()[i] != ';') continue;
+        const QByteArray action(actions.data() + itemStart, i - itemStart);
+        if (!action.isEmpty() && !actionGroups.remove(action)) {
+            report(offsetOf(actions) + itemStart, Diagnostic::Error,
+                   QStringLiteral("The action %1 has no [Desktop Action %1] group").arg(QString::fromUtf8(action)));
+        }
+        itemStart = i + 1;
+    }
+    for (QHash<QByteArray, int>::const_iterator it = actionGroups.constBegin(); it != actionGroups.constEnd(); ++it) {
+        report(it.value(), Diagnostic::Warning,
+               QStringLiteral("The action %1 is not listed in the Actions key").arg(QString::fromUtf8(it.key())));
+    }
+}
+
+// Workers claim small chunks of the file list until it runs out, like the ones of QXdgDesktopEntryCollection.
+class ValidateTask : public QRunnable
+{
+public:
+    enum { ChunkSize = 16 };
+
+    ValidateTask(const QStringList &filePaths, QVector<Diagnostic> *results, QAtomicInt *nextIndex)
+        : filePaths(filePaths), results(results), nextIndex(nextIndex) {}
+
+    void run() override {
+        for (;;) {
+            const int begin = nextIndex->fetchAndAddRelaxed(ChunkSize);
+            if (begin >= filePaths.count()) return;
+
+            const int end = qMin(begin + int(ChunkSize), filePaths.count());
+            for (int i = begin; i < end; i++) {
+                results[i] = QXdgDesktopEntryValidator::validateFile(filePaths[i]);
+            }
+        }
+    }
+
+private:
+    const QStringList &filePaths;
+    QVector<Diagnostic> *results;
+    QAtomicInt *nextIndex;
+};
+
+} // namespace
+
+/*!
+ * \brief Returns the diagnostic formatted like a compiler does, "file:line:column: error: message".
+ */
+QString QXdgDesktopEntryDiagnostic::toString() const
+{
+    const QString severityName = severity == Error ? QStringLiteral("error") : QStringLiteral("warning");
+    if (line == 0) {
+        return QStringLiteral("%1: %2: %3").arg(filePath, severityName, message);
+    }
+    return QStringLiteral("%1:%2:%3: %4: %5").arg(filePath).arg(line).arg(column).arg(severityName, message);
+}
+
+/*!
+ * \class QXdgDesktopEntryValidator
+ * \brief Checks desktop entry files against the spec, similar to desktop-file-validate.
+ *
+ * Unlike QXdgDesktopEntry::status(), which only knows that something went wrong, the validator reports every
+ * problem it finds with its line and column: broken group headers, duplicate groups and keys, invalid UTF-8,
+ * invalid key names and locales, unknown keys and Type values, bad booleans, malformed Exec values, missing
+ * required keys and actions without their group.
+ *
+ * \code
+ * QXdgDesktopEntryValidator validator;
+ * const QStringList files = QXdgDesktopEntryValidator::findDesktopFiles({ "/usr/share/applications" });
+ * for (const QXdgDesktopEntryDiagnostic &diagnostic : validator.validateFiles(files)) {
+ *     qWarning() << diagnostic.toString();
+ * }
+ * \endcode
+ */
+
+QXdgDesktopEntryValidator::QXdgDesktopEntryValidator()
+    : d_ptr(new QXdgDesktopEntryValidatorPrivate)
+{
+
+}
+
+QXdgDesktopEntryValidator::~QXdgDesktopEntryValidator()
+{
+
+}
+
+/*!
+ * \brief Returns the maximum amount of threads used by validateFiles(), QThread::idealThreadCount() by default.
+ */
+int QXdgDesktopEntryValidator::maxThreadCount() const
+{
+    Q_D(const QXdgDesktopEntryValidator);
+    return d->maxThreadCount;
+}
+
+void QXdgDesktopEntryValidator::setMaxThreadCount(int maxThreadCount)
+{
+    Q_D(QXdgDesktopEntryValidator);
+    d->maxThreadCount = maxThreadCount;
+}
+
+/*!
+ * \brief Checks the content of a desktop entry file, \a filePath is only used in the diagnostics.
+ *
+ * The diagnostics are sorted by their position.
+ */
+QVector<QXdgDesktopEntryDiagnostic> QXdgDesktopEntryValidator::validateData(const QByteArray &data, const QString &filePath)
+{
+    QVector<QXdgDesktopEntryDiagnostic> diagnostics;
+    Validator(data, filePath, &diagnostics).run();
+    return diagnostics;
+}
+
+/*!
+ * \brief Checks the desktop entry file at \a filePath.
+ */
+QVector<QXdgDesktopEntryDiagnostic> QXdgDesktopEntryValidator::validateFile(const QString &filePath)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        QXdgDesktopEntryDiagnostic diagnostic;
+        diagnostic.filePath = filePath;
+        diagnostic.message = QStringLiteral("Can't read the file: %1").arg(file.errorString());
+        return { diagnostic };
+    }
+    const QByteArray data = file.readAll();
+    QXdgStatsPrivate::add(QXdgStatsPrivate::FilesRead);
+    QXdgStatsPrivate::add(QXdgStatsPrivate::BytesRead, quint64(data.size()));
+    return validateData(data, filePath);
+}
+
+/*!
+ * \brief Checks all the given files in parallel, using up to maxThreadCount() threads.
+ *
+ * The diagnostics are in the order of \a filePaths, and sorted by their position inside each file.
+ *
+ * \sa findDesktopFiles()
+ */
+QVector<QXdgDesktopEntryDiagnostic> QXdgDesktopEntryValidator::validateFiles(const QStringList &filePaths) const
+{
+    Q_D(const QXdgDesktopEntryValidator);
+
+    QVector<QVector<Diagnostic>> results(filePaths.count());
+    QThreadPool pool;
+    pool.setMaxThreadCount(qMax(1, d->maxThreadCount));
+    QAtomicInt nextIndex(0);
+    const int workerCount = qMin(pool.maxThreadCount(), (filePaths.count() + ValidateTask::ChunkSize - 1) / ValidateTask::ChunkSize);
+    for (int i = 0; i < workerCount; i++) {
+        pool.start(new ValidateTask(filePaths, results.data(), &nextIndex));
+    }
+    pool.waitForDone();
+
+    QVector<Diagnostic> diagnostics;
+    for (const QVector<Diagnostic> &result : qAsConst(results)) {
+        diagnostics += result;
+    }
+    return diagnostics;
+}
+
+/*!
+ * \brief Returns the desktop files in \a paths, sorted.
+ *
+ * Files are taken as they are, directories are searched recursively for .desktop files.
+ */
+QStringList QXdgDesktopEntryValidator::findDesktopFiles(const QStringList &paths)
+{
+    QStringList filePaths;
+    for (const QString &path : paths) {
+        if (!QFileInfo(path).isDir()) {
+            filePaths << path;
+            continue;
+        }
+
+        QDirIterator it(path, { QStringLiteral("*.desktop") }, QDir::Files, QDirIterator::Subdirectories);
+        while (it.hasNext()) {
+            filePaths << it.next();
+        }
+    }
+
+    filePaths.sort();
+    filePaths.removeDuplicates();
+    return filePaths;
+}
@@ -0,0 +1,76 @@
+/*
+ * Copyright (C) 2019 Deepin Technology Co., Ltd.
+ *               2019 Gary Wang
+ *
+ * Author:     Gary Wang <wzc782970009@gmail.com>
+ *
+ * Maintainer: Gary Wang <wzc782970009@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QXDGDESKTOPENTRYVALIDATOR_H
+#define QXDGDESKTOPENTRYVALIDATOR_H
+
+#include "qxdg_global.h"
+
+#include <QScopedPointer>
+#include <QStringList>
+#include <QVector>
+
+/*!
+ * \brief A problem found by QXdgDesktopEntryValidator.
+ */
+struct QXDGSHARED_EXPORT QXdgDesktopEntryDiagnostic
+{
+    enum Severity {
+        Error = 0, //!< The file violates the spec.
+        Warning    //!< The file is valid, but uses something deprecated or unusual.
+    };
+
+    QString filePath;
+    int line = 0;   //!< Starts at 1, 0 if the problem is about the whole file.
+    int column = 0; //!< Starts at 1, counted in bytes. 0 if the problem is about the whole file.
+    Severity severity = Error;
+    QString message;
+
+    QString toString() const;
+};
+
+Q_DECLARE_TYPEINFO(QXdgDesktopEntryDiagnostic, Q_MOVABLE_TYPE);
+
+class QXdgDesktopEntryValidatorPrivate;
+class QXDGSHARED_EXPORT QXdgDesktopEntryValidator
+{
+public:
+    QXdgDesktopEntryValidator();
+    ~QXdgDesktopEntryValidator();
+
+    int maxThreadCount() const;
+    void setMaxThreadCount(int maxThreadCount);
+
+    static QVector<QXdgDesktopEntryDiagnostic> validateData(const QByteArray &data, const QString &filePath = QString());
+    static QVector<QXdgDesktopEntryDiagnostic> validateFile(const QString &filePath);
+    QVector<QXdgDesktopEntryDiagnostic> validateFiles(const QStringList &filePaths) const;
+
+    static QStringList findDesktopFiles(const QStringList &paths);
+
+private:
+    QScopedPointer<QXdgDesktopEntryValidatorPrivate> d_ptr;
+
+    Q_DECLARE_PRIVATE(QXdgDesktopEntryValidator)
+    Q_DISABLE_COPY(QXdgDesktopEntryValidator)
+};
+
+#endif // QXDGDESKTOPENTRYVALIDATOR_H
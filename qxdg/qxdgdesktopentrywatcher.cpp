@@ -0,0 +1,368 @@
+/*
+ * Copyright (C) 2019 Deepin Technology Co., Ltd.
+ *               2019 Gary Wang
+ *
+ * Author:     Gary Wang <wzc782970009@gmail.com>
+ *
+ * Maintainer: Gary Wang <wzc782970009@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "qxdgdesktopentrywatcher.h"
+#include "qxdgdesktopentrycollection_p.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QMultiHash>
+#include <QPair>
+#include <QSet>
+#include <QSocketNotifier>
+
+#include <algorithm>
+
+#ifdef Q_OS_LINUX
+#include <errno.h>
+#include <string.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+/*! \internal */
+class QXdgDesktopEntryWatcherPrivate
+{
+public:
+    // A file or directory, as root directory index and path relative to it.
+    typedef QPair<int, QString> RelativePath;
+
+    struct WatchedDir {
+        int rootIndex;
+        QString relativeDir;
+        // The parent of a root directory which doesn't exist (yet).
+        bool isRootParent;
+    };
+
+    QXdgDesktopEntryWatcherPrivate(QXdgDesktopEntryWatcher *qq, QXdgDesktopEntryCollection *collection);
+    ~QXdgDesktopEntryWatcherPrivate();
+
+    void watchRoot(int rootIndex, QVector<RelativePath> *files);
+    void watchDirectory(int rootIndex, const QString &relativeDir, QVector<RelativePath> *files);
+    void _q_readEvents();
+    void applyChanges(QVector<RelativePath> files);
+
+    QXdgDesktopEntryCollectionPrivate *collection;
+    int inotifyFd = -1;
+    QSocketNotifier *notifier = nullptr;
+    QMultiHash<int, WatchedDir> watches;
+
+private:
+    QXdgDesktopEntryWatcher *q_ptr;
+
+    Q_DECLARE_PUBLIC(QXdgDesktopEntryWatcher)
+};
+
+#ifdef Q_OS_LINUX
+static const uint32_t directoryMask = IN_CREATE | IN_DELETE | IN_CLOSE_WRITE | IN_MOVED_FROM | IN_MOVED_TO
+                                      | IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR;
+static const uint32_t rootParentMask = IN_CREATE | IN_MOVED_TO | IN_ONLYDIR;
+#endif
+
+static inline bool isDesktopFile(const QString &fileName)
+{
+    return fileName.endsWith(QLatin1String(".desktop"));
+}
+
+QXdgDesktopEntryWatcherPrivate::QXdgDesktopEntryWatcherPrivate(QXdgDesktopEntryWatcher *qq,
+                                                               QXdgDesktopEntryCollection *collection)
+    : collection(collection->d_func()), q_ptr(qq)
+{
+#ifdef Q_OS_LINUX
+    inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotifyFd == -1) {
+        qWarning("QXdgDesktopEntryWatcher: inotify_init1 failed: %s", strerror(errno));
+        return;
+    }
+
+    for (int i = 0; i < this->collection->roots.count(); i++) {
+        watchRoot(i, nullptr);
+    }
+
+    notifier = new QSocketNotifier(inotifyFd, QSocketNotifier::Read, qq);
+    QObject::connect(notifier, SIGNAL(activated(int)), qq, SLOT(_q_readEvents()));
+#endif
+}
+
+QXdgDesktopEntryWatcherPrivate::~QXdgDesktopEntryWatcherPrivate()
+{
+#ifdef Q_OS_LINUX
+    if (inotifyFd != -1) {
+        ::close(inotifyFd);
+    }
+#endif
+}
+
+// Watch the root directory, or its parent until the root directory gets created.
+void QXdgDesktopEntryWatcherPrivate::watchRoot(int rootIndex, QVector<RelativePath> *files)
+{
+#ifdef Q_OS_LINUX
+    const QString &root = collection->roots[rootIndex];
+    if (QFileInfo(root).isDir()) {
+        watchDirectory(rootIndex, QString(), files);
+        return;
+    }
+
+    const QByteArray parentPath = QFile::encodeName(QFileInfo(root).absolutePath());
+    const int wd = inotify_add_watch(inotifyFd, parentPath.constData(), rootParentMask);
+    if (wd != -1) {
+        watches.insert(wd, { rootIndex, QString(), true });
+    }
+#else
+    Q_UNUSED(rootIndex)
+    Q_UNUSED(files)
+#endif
+}
+
+// Watch the directory and all its subdirectories, and collect the desktop files in them into \a files.
+void QXdgDesktopEntryWatcherPrivate::watchDirectory(int rootIndex, const QString &relativeDir, QVector<RelativePath> *files)
+{
+#ifdef Q_OS_LINUX
+    const QString &root = collection->roots[rootIndex];
+    const QDir dir(relativeDir.isEmpty() ? root : root + QLatin1Char('/') + relativeDir);
+    const int wd = inotify_add_watch(inotifyFd, QFile::encodeName(dir.path()).constData(), directoryMask);
+    if (wd == -1) return;
+
+    bool watched = false;
+    for (QMultiHash<int, WatchedDir>::iterator it = watches.find(wd); it != watches.end() && it.key() == wd; ++it) {
+        if (it->rootIndex != rootIndex || it->isRootParent) continue;
+        // Walked again, after events got lost, its content may have changed.
+        if (it->relativeDir == relativeDir) {
+            watched = true;
+            break;
+        }
+        // The same directory reached again through a symlink.
+        if (QFileInfo(root + QLatin1Char('/') + it->relativeDir).isDir()) return;
+        // Or a directory which got moved, the watch follows it.
+        watches.erase(it);
+        break;
+    }
+    if (!watched) {
+        watches.insert(wd, { rootIndex, relativeDir, false });
+    }
+
+    const QString prefix = relativeDir.isEmpty() ? QString() : relativeDir + QLatin1Char('/');
+    for (const QFileInfo &fileInfo : dir.entryInfoList(QDir::Dirs | QDir::Files | QDir::NoDotAndDotDot)) {
+        if (fileInfo.isDir()) {
+            watchDirectory(rootIndex, prefix + fileInfo.fileName(), files);
+        } else if (files && isDesktopFile(fileInfo.fileName())) {
+            files->append({ rootIndex, prefix + fileInfo.fileName() });
+        }
+    }
+#else
+    Q_UNUSED(rootIndex)
+    Q_UNUSED(relativeDir)
+    Q_UNUSED(files)
+#endif
+}
+
+// Events are turned into the list of touched files first, so a file which got several events in a row is
+// only loaded once.
+void QXdgDesktopEntryWatcherPrivate::_q_readEvents()
+{
+#ifdef Q_OS_LINUX
+    QVector<RelativePath> changedFiles;
+    QVector<RelativePath> removedDirs;
+    QVector<RelativePath> createdDirs;
+    QVector<int> missingRoots;
+    QSet<int> staleWatches;
+    bool overflow = false;
+
+    alignas(struct inotify_event) char buffer[4096];
+    for (;;) {
+        const ssize_t length = ::read(inotifyFd, buffer, sizeof(buffer));
+        if (length <= 0) break;
+
+        for (ssize_t offset = 0; offset < length; ) {
+            const struct inotify_event *event = reinterpret_cast<const struct inotify_event *>(buffer + offset);
+            offset += ssize_t(sizeof(struct inotify_event) + event->len);
+
+            if (event->mask & IN_Q_OVERFLOW) {
+                overflow = true;
+                continue;
+            }
+
+            const QString name = event->len ? QFile::decodeName(event->name) : QString();
+            for (const WatchedDir &watched : watches.values(event->wd)) {
+                if (watched.isRootParent) {
+                    if ((event->mask & IN_ISDIR)
+                            && name == QFileInfo(collection->roots[watched.rootIndex]).fileName()) {
+                        createdDirs.append({ watched.rootIndex, QString() });
+                    }
+                    continue;
+                }
+
+                // The content of other directories is handled by the events of their parent.
+                if (event->mask & (IN_DELETE_SELF | IN_MOVE_SELF)) {
+                    if (watched.relativeDir.isEmpty()) {
+                        removedDirs.append({ watched.rootIndex, QString() });
+                        missingRoots.append(watched.rootIndex);
+                        staleWatches.insert(event->wd);
+                    } else if (!QFileInfo(collection->roots[watched.rootIndex] + QLatin1Char('/')
+                                          + watched.relativeDir).isDir()) {
+                        staleWatches.insert(event->wd);
+                    }
+                    continue;
+                }
+
+                if (name.isEmpty()) continue;
+                const QString relativePath = watched.relativeDir.isEmpty() ? name
+                                                                           : watched.relativeDir + QLatin1Char('/') + name;
+                if (event->mask & IN_ISDIR) {
+                    if (event->mask & (IN_CREATE | IN_MOVED_TO)) {
+                        createdDirs.append({ watched.rootIndex, relativePath });
+                    } else if (event->mask & (IN_DELETE | IN_MOVED_FROM)) {
+                        removedDirs.append({ watched.rootIndex, relativePath });
+                    }
+                } else if (isDesktopFile(name)) {
+                    changedFiles.append({ watched.rootIndex, relativePath });
+                }
+            }
+
+            if (event->mask & IN_IGNORED) {
+                watches.remove(event->wd);
+            }
+        }
+    }
+
+    if (overflow) {
+        // Events got lost, go through every known and existing file instead.
+        for (const QXdgDesktopEntryCollectionItem &item : collection->items) {
+            changedFiles.append({ item.rootIndex, item.relativePath });
+        }
+        for (int i = 0; i < collection->roots.count(); i++) {
+            createdDirs.append({ i, QString() });
+        }
+    }
+
+    // A directory moved somewhere else gets watched again under its new path.
+    for (int wd : staleWatches) {
+        inotify_rm_watch(inotifyFd, wd);
+        watches.remove(wd);
+    }
+
+    // Everything that was inside a removed directory is gone too.
+    for (const RelativePath &dir : removedDirs) {
+        const QString prefix = dir.second.isEmpty() ? QString() : dir.second + QLatin1Char('/');
+        for (const QXdgDesktopEntryCollectionItem &item : collection->items) {
+            if (item.rootIndex == dir.first && item.relativePath.startsWith(prefix)) {
+                changedFiles.append({ item.rootIndex, item.relativePath });
+            }
+        }
+    }
+
+    for (int rootIndex : missingRoots) {
+        watchRoot(rootIndex, &changedFiles);
+    }
+
+    for (const RelativePath &dir : createdDirs) {
+        if (dir.second.isEmpty()) {
+            watchRoot(dir.first, &changedFiles);
+        } else {
+            watchDirectory(dir.first, dir.second, &changedFiles);
+        }
+    }
+
+    applyChanges(changedFiles);
+#endif
+}
+
+void QXdgDesktopEntryWatcherPrivate::applyChanges(QVector<RelativePath> files)
+{
+    Q_Q(QXdgDesktopEntryWatcher);
+
+    std::sort(files.begin(), files.end());
+    files.erase(std::unique(files.begin(), files.end()), files.end());
+
+    for (const RelativePath &file : files) {
+        QString desktopFileId;
+        switch (collection->reloadFile(file.first, file.second, &desktopFileId)) {
+        case QXdgDesktopEntryCollectionPrivate::Added:
+            Q_EMIT q->entryAdded(desktopFileId);
+            break;
+        case QXdgDesktopEntryCollectionPrivate::Changed:
+            Q_EMIT q->entryChanged(desktopFileId);
+            break;
+        case QXdgDesktopEntryCollectionPrivate::Removed:
+            Q_EMIT q->entryRemoved(desktopFileId);
+            break;
+        case QXdgDesktopEntryCollectionPrivate::NoChange:
+            break;
+        }
+    }
+}
+
+/*!
+ * \class QXdgDesktopEntryWatcher
+ * \brief Keeps a QXdgDesktopEntryCollection up to date with the changes made on disk.
+ *
+ * The watcher uses inotify to watch the directories the collection was loaded from, and only loads again the
+ * files which got created, modified, moved or deleted. Entries of other files are left untouched. Each change
+ * of the visible entry of a desktop file ID is reported by one of the signals, after the collection has been
+ * updated.
+ *
+ * The collection must be loaded before the watcher is created, and must not be loaded again while the watcher
+ * exists. Both must live in the same thread, which needs to run an event loop. Watching is only supported on
+ * Linux, see isActive().
+ */
+
+/*!
+ * \brief Start watching the directories of \a collection.
+ */
+QXdgDesktopEntryWatcher::QXdgDesktopEntryWatcher(QXdgDesktopEntryCollection *collection, QObject *parent)
+    : QObject(parent)
+    , d_ptr(new QXdgDesktopEntryWatcherPrivate(this, collection))
+{
+
+}
+
+QXdgDesktopEntryWatcher::~QXdgDesktopEntryWatcher()
+{
+
+}
+
+/*!
+ * \brief Returns whether the watcher is able to watch the directories.
+ */
+bool QXdgDesktopEntryWatcher::isActive() const
+{
+    Q_D(const QXdgDesktopEntryWatcher);
+    return d->notifier != nullptr;
+}
+
+/*!
+ * \fn void QXdgDesktopEntryWatcher::entryAdded(const QString &desktopFileId)
+ * \brief Emitted when an entry with a desktop file ID unknown before has been added to the collection.
+ */
+
+/*!
+ * \fn void QXdgDesktopEntryWatcher::entryChanged(const QString &desktopFileId)
+ * \brief Emitted when the entry with \a desktopFileId has been loaded again, possibly from another file.
+ */
+
+/*!
+ * \fn void QXdgDesktopEntryWatcher::entryRemoved(const QString &desktopFileId)
+ * \brief Emitted when the entry with \a desktopFileId has been removed from the collection.
+ */
+
+#include "moc_qxdgdesktopentrywatcher.cpp"
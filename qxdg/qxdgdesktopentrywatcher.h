@@ -0,0 +1,55 @@
+/*
+ * Copyright (C) 2019 Deepin Technology Co., Ltd.
+ *               2019 Gary Wang
+ *
+ * Author:     Gary Wang <wzc782970009@gmail.com>
+ *
+ * Maintainer: Gary Wang <wzc782970009@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QXDGDESKTOPENTRYWATCHER_H
+#define QXDGDESKTOPENTRYWATCHER_H
+
+#include "qxdg_global.h"
+
+#include <QObject>
+#include <QScopedPointer>
+
+class QXdgDesktopEntryCollection;
+class QXdgDesktopEntryWatcherPrivate;
+class QXDGSHARED_EXPORT QXdgDesktopEntryWatcher : public QObject
+{
+    Q_OBJECT
+public:
+    explicit QXdgDesktopEntryWatcher(QXdgDesktopEntryCollection *collection, QObject *parent = nullptr);
+    ~QXdgDesktopEntryWatcher() override;
+
+    bool isActive() const;
+
+Q_SIGNALS:
+    void entryAdded(const QString &desktopFileId);
+    void entryChanged(const QString &desktopFileId);
+    void entryRemoved(const QString &desktopFileId);
+
+private:
+    QScopedPointer<QXdgDesktopEntryWatcherPrivate> d_ptr;
+
+    Q_DECLARE_PRIVATE(QXdgDesktopEntryWatcher)
+    Q_DISABLE_COPY(QXdgDesktopEntryWatcher)
+    Q_PRIVATE_SLOT(d_func(), void _q_readEvents())
+};
+
+#endif // QXDGDESKTOPENTRYWATCHER_H
@@ -0,0 +1,523 @@
+/*
+ * Copyright (C) 2019 Deepin Technology Co., Ltd.
+ *               2019 Gary Wang
+ *
+ * Author:     Gary Wang <wzc782970009@gmail.com>
+ *
+ * Maintainer: Gary Wang <wzc782970009@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "qxdgicontheme.h"
+#include "qxdgicontheme_p.h"
+#include "qxdgdesktopentry.h"
+#include "qxdgdesktopentrycache_p.h"
+#include "qxdgstandardpath.h"
+
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <QSet>
+
+#include <limits.h>
+
+// How long after its modification time a directory listing can still miss a change made within the same time
+// stamp, it's listed again by the next lookup batch until then.
+static const qint64 racyWindow = 2000;
+
+static const char themeGroup[] = "Icon Theme";
+
+static QStringList splitThemeList(const QString &value)
+{
+    QStringList result;
+    for (const QString &item : value.split(QLatin1Char(','), QString::SkipEmptyParts)) {
+        const QString trimmed = item.trimmed();
+        if (!trimmed.isEmpty()) {
+            result << trimmed;
+        }
+    }
+    return result;
+}
+
+static QXdgIconThemeDirectory parseDirectory(const QXdgDesktopEntry &index, const QString &path)
+{
+    QXdgIconThemeDirectory directory;
+    directory.path = path;
+    directory.size = int(index.numericValue(QStringLiteral("Size"), path));
+    directory.scale = qMax(1, int(index.numericValue(QStringLiteral("Scale"), path, 1)));
+    directory.minSize = int(index.numericValue(QStringLiteral("MinSize"), path, directory.size));
+    directory.maxSize = int(index.numericValue(QStringLiteral("MaxSize"), path, directory.size));
+    directory.threshold = int(index.numericValue(QStringLiteral("Threshold"), path, 2));
+
+    const QString type = index.rawValue(QStringLiteral("Type"), path);
+    if (type == QLatin1String("Fixed")) {
+        directory.type = QXdgIconThemeDirectory::Fixed;
+    } else if (type == QLatin1String("Scalable")) {
+        directory.type = QXdgIconThemeDirectory::Scalable;
+    } else {
+        directory.type = QXdgIconThemeDirectory::Threshold;
+    }
+    return directory;
+}
+
+/*!
+ * \internal
+ * \brief Returns true if icons of the directory can be used for \a iconSize at \a iconScale without scaling.
+ */
+bool QXdgIconThemeDirectory::matchesSize(int iconSize, int iconScale) const
+{
+    if (scale != iconScale) return false;
+
+    switch (type) {
+    case Fixed:
+        return size == iconSize;
+    case Scalable:
+        return minSize <= iconSize && iconSize <= maxSize;
+    case Threshold:
+        return size - threshold <= iconSize && iconSize <= size + threshold;
+    }
+    return false;
+}
+
+/*!
+ * \internal
+ * \brief Returns how far the icons of the directory are from \a iconSize at \a iconScale, in device pixels.
+ *
+ * The spec uses MinSize and MaxSize for the bounds of Threshold directories here, which are only meant for
+ * Scalable ones, so Size and Threshold are used instead, the same as matchesSize().
+ */
+int QXdgIconThemeDirectory::sizeDistance(int iconSize, int iconScale) const
+{
+    const int wanted = iconSize * iconScale;
+    int lower = size * scale;
+    int upper = lower;
+    if (type == Scalable) {
+        lower = minSize * scale;
+        upper = maxSize * scale;
+    } else if (type == Threshold) {
+        lower = (size - threshold) * scale;
+        upper = (size + threshold) * scale;
+    }
+
+    if (wanted < lower) return lower - wanted;
+    if (wanted > upper) return wanted - upper;
+    return 0;
+}
+
+/*! \internal */
+void QXdgIconThemePrivate::clear()
+{
+    themesLoaded = false;
+    chain.clear();
+    fallbackListings.clear();
+    listings.clear();
+    listingIndex.clear();
+}
+
+/*!
+ * \internal
+ * \brief Read the index.theme of the theme and of everything it inherits, if not done yet.
+ */
+void QXdgIconThemePrivate::ensureThemesLoaded() const
+{
+    if (themesLoaded) return;
+    themesLoaded = true;
+
+    appendTheme(themeName);
+    // every theme implicitly inherits hicolor, it's searched last.
+    appendTheme(QStringLiteral("hicolor"));
+
+    for (const QString &searchPath : searchPaths) {
+        fallbackListings << listingFor(searchPath);
+    }
+}
+
+/*!
+ * \internal
+ * \brief Append the theme \a name and, depth first, the themes it inherits to the chain.
+ *
+ * Themes already in the chain are skipped, so inheritance loops end.
+ */
+void QXdgIconThemePrivate::appendTheme(const QString &name) const
+{
+    if (name.isEmpty()) return;
+    for (const QXdgIconThemeData &theme : chain) {
+        if (theme.name == name) return;
+    }
+
+    QXdgIconThemeData theme;
+    theme.name = name;
+    // a theme can be spread over several search paths, the first index.theme found describes all of them.
+    QStringList themeDirs;
+    for (const QString &searchPath : searchPaths) {
+        const QString themeDir = searchPath + QLatin1Char('/') + name;
+        if (!QFileInfo(themeDir).isDir()) continue;
+        themeDirs << themeDir;
+
+        const QString indexPath = themeDir + QLatin1String("/index.theme");
+        if (theme.valid || !QFileInfo::exists(indexPath)) continue;
+
+        const QXdgDesktopEntry index(indexPath);
+        if (!index.allGroups().contains(QLatin1String(themeGroup))) continue;
+
+        theme.valid = true;
+        theme.displayName = index.localizedValue(QStringLiteral("Name"), QStringLiteral("default"), QLatin1String(themeGroup));
+        theme.inherits = splitThemeList(index.rawValue(QStringLiteral("Inherits"), QLatin1String(themeGroup)));
+        QStringList directories = splitThemeList(index.rawValue(QStringLiteral("Directories"), QLatin1String(themeGroup)));
+        directories << splitThemeList(index.rawValue(QStringLiteral("ScaledDirectories"), QLatin1String(themeGroup)));
+        for (const QString &directory : directories) {
+            // a directory without a Size can't be matched against anything.
+            if (index.contains(QStringLiteral("Size"), directory)) {
+                theme.directories << parseDirectory(index, directory);
+            }
+        }
+    }
+
+    for (int i = 0; i < theme.directories.count(); i++) {
+        for (const QString &themeDir : themeDirs) {
+            theme.locations.append({ i, listingFor(themeDir + QLatin1Char('/') + theme.directories[i].path) });
+        }
+    }
+
+    const QStringList inherits = theme.inherits;
+    chain.append(theme);
+    for (const QString &parent : inherits) {
+        appendTheme(parent);
+    }
+}
+
+/*!
+ * \internal
+ * \brief Returns the index of the listing of the directory at \a path, the directory isn't listed yet.
+ */
+int QXdgIconThemePrivate::listingFor(const QString &path) const
+{
+    QHash<QString, int>::const_iterator it = listingIndex.constFind(path);
+    if (it != listingIndex.constEnd()) {
+        return it.value();
+    }
+
+    QXdgIconDirectoryListing listing;
+    listing.path = path;
+    listings.append(listing);
+    listingIndex.insert(path, listings.count() - 1);
+    return listings.count() - 1;
+}
+
+/*!
+ * \internal
+ * \brief Returns the listing at \a index, listed again if the directory changed since.
+ *
+ * The modification time is only checked once per lookup batch, all the lookups of a batch share the same view
+ * of the directories.
+ */
+const QXdgIconDirectoryListing &QXdgIconThemePrivate::validListing(int index) const
+{
+    QXdgIconDirectoryListing &listing = listings[index];
+    if (listing.generation == generation) {
+        return listing;
+    }
+    listing.generation = generation;
+
+    // Taken before listing, so changes made while we list show up as a newer modification time.
+    const qint64 modificationTime = QXdgDesktopEntryCache::modificationTime(listing.path);
+    if (modificationTime == listing.modificationTime && !listing.racy) {
+        return listing;
+    }
+
+    listing.modificationTime = modificationTime;
+    listing.racy = modificationTime != -1 && modificationTime + racyWindow >= QDateTime::currentMSecsSinceEpoch();
+    listing.icons.clear();
+    if (modificationTime == -1) {
+        return listing;
+    }
+
+    for (const QString &fileName : QDir(listing.path).entryList(QDir::Files, QDir::NoSort)) {
+        uchar extension;
+        if (fileName.endsWith(QLatin1String(".png"))) {
+            extension = QXdgIconDirectoryListing::Png;
+        } else if (fileName.endsWith(QLatin1String(".svg"))) {
+            extension = QXdgIconDirectoryListing::Svg;
+        } else if (fileName.endsWith(QLatin1String(".xpm"))) {
+            extension = QXdgIconDirectoryListing::Xpm;
+        } else {
+            continue;
+        }
+        listing.icons[fileName.left(fileName.size() - 4)] |= extension;
+    }
+    return listing;
+}
+
+// Returns the path of the icon in the listing with the preferred of its extensions: png, svg and then xpm.
+static QString iconFilePath(const QXdgIconDirectoryListing &listing, const QString &iconName, uchar extensions)
+{
+    const char *extension = (extensions & QXdgIconDirectoryListing::Png) ? ".png"
+                          : (extensions & QXdgIconDirectoryListing::Svg) ? ".svg" : ".xpm";
+    return listing.path + QLatin1Char('/') + iconName + QLatin1String(extension);
+}
+
+/*!
+ * \internal
+ * \brief Returns the icon \a iconName of \a theme, without looking at what the theme inherits.
+ *
+ * The first icon whose directory matches the size is taken, otherwise the one of the closest size.
+ */
+QString QXdgIconThemePrivate::lookupIcon(const QXdgIconThemeData &theme, const QString &iconName, int size, int scale) const
+{
+    QString closestFilePath;
+    int minimalDistance = INT_MAX;
+    for (const QXdgIconThemeData::Location &location : theme.locations) {
+        const QXdgIconDirectoryListing &listing = validListing(location.listing);
+        const uchar extensions = listing.icons.value(iconName);
+        if (extensions == 0) continue;
+
+        const QXdgIconThemeDirectory &directory = theme.directories[location.directory];
+        if (directory.matchesSize(size, scale)) {
+            return iconFilePath(listing, iconName, extensions);
+        }
+        const int distance = directory.sizeDistance(size, scale);
+        if (distance < minimalDistance) {
+            minimalDistance = distance;
+            closestFilePath = iconFilePath(listing, iconName, extensions);
+        }
+    }
+    return closestFilePath;
+}
+
+/*!
+ * \internal
+ * \brief Returns the icon \a iconName placed directly in one of the search paths, like /usr/share/pixmaps.
+ */
+QString QXdgIconThemePrivate::lookupFallbackIcon(const QString &iconName) const
+{
+    for (int index : fallbackListings) {
+        const QXdgIconDirectoryListing &listing = validListing(index);
+        const uchar extensions = listing.icons.value(iconName);
+        if (extensions != 0) {
+            return iconFilePath(listing, iconName, extensions);
+        }
+    }
+    return QString();
+}
+
+/*! \internal */
+QString QXdgIconThemePrivate::findIcon(const QString &iconName, int size, int scale) const
+{
+    if (iconName.isEmpty()) return QString();
+
+    // Icon= can also be an absolute path to the file.
+    if (QDir::isAbsolutePath(iconName)) {
+        return QFileInfo::exists(iconName) ? iconName : QString();
+    }
+
+    for (const QXdgIconThemeData &theme : chain) {
+        const QString filePath = lookupIcon(theme, iconName, size, scale);
+        if (!filePath.isEmpty()) {
+            return filePath;
+        }
+    }
+    return lookupFallbackIcon(iconName);
+}
+
+/*!
+ * \class QXdgIconTheme
+ * \brief Resolves icon names, like the Icon key of desktop entries, to files of an icon theme.
+ *
+ * Icons are looked up as described by the icon theme spec: in the theme first, then in the themes it inherits
+ * depth first, then in hicolor, and last directly in the search paths. In each theme, an icon of a directory
+ * matching the wanted size and scale is preferred, otherwise the one of the closest size is taken.
+ *
+ * The index.theme files are read by the first lookup, and the directories of the themes are listed once and
+ * kept. A directory is only listed again when its modification time changed, and it's checked at most once per
+ * call of findIcons(), so resolving many icons at once costs about one stat per directory of the themes. Call
+ * clearCache() after themes were installed or their index.theme changed.
+ *
+ * All methods are thread-safe, lookups of several threads are serialized.
+ *
+ * For more details about the lookup, please refer to:
+ * https://specifications.freedesktop.org/icon-theme-spec/latest/ar01s05.html
+ */
+
+/*!
+ * \brief Creates the icon theme \a themeName, searched in defaultSearchPaths().
+ */
+QXdgIconTheme::QXdgIconTheme(const QString &themeName)
+    : d_ptr(new QXdgIconThemePrivate)
+{
+    Q_D(QXdgIconTheme);
+    d->themeName = themeName;
+    d->searchPaths = defaultSearchPaths();
+}
+
+QXdgIconTheme::~QXdgIconTheme()
+{
+
+}
+
+/*!
+ * \brief Returns the directories icon themes are searched in, in precedence order.
+ *
+ * They are $HOME/.icons, the "icons" directories under XDG_DATA_HOME and XDG_DATA_DIRS, and /usr/share/pixmaps.
+ */
+QStringList QXdgIconTheme::defaultSearchPaths()
+{
+    QStringList dataDirs = QXdgStandardPath::standardLocations(QXdgStandardPath::XdgDataHomeLocation);
+    dataDirs << QXdgStandardPath::standardLocations(QXdgStandardPath::XdgDataDirsLocation);
+
+    QStringList result { QDir::cleanPath(QDir::homePath() + QLatin1String("/.icons")) };
+    for (const QString &dataDir : dataDirs) {
+        result << QDir::cleanPath(dataDir + QLatin1String("/icons"));
+    }
+    result << QStringLiteral("/usr/share/pixmaps");
+    result.removeDuplicates();
+    return result;
+}
+
+/*!
+ * \brief Returns the directories the theme is searched in.
+ *
+ * \sa setSearchPaths()
+ */
+QStringList QXdgIconTheme::searchPaths() const
+{
+    Q_D(const QXdgIconTheme);
+    return d->searchPaths;
+}
+
+/*!
+ * \brief Search the theme in \a searchPaths, in precedence order, instead of defaultSearchPaths().
+ *
+ * This drops the cache.
+ */
+void QXdgIconTheme::setSearchPaths(const QStringList &searchPaths)
+{
+    Q_D(QXdgIconTheme);
+    QMutexLocker locker(&d->mutex);
+    d->searchPaths.clear();
+    for (const QString &searchPath : searchPaths) {
+        d->searchPaths << QDir::cleanPath(searchPath);
+    }
+    d->clear();
+}
+
+/*!
+ * \brief Returns the name of the theme directory, like "hicolor".
+ */
+QString QXdgIconTheme::themeName() const
+{
+    Q_D(const QXdgIconTheme);
+    return d->themeName;
+}
+
+/*!
+ * \brief Returns true if the index.theme of the theme was found in the search paths.
+ *
+ * Lookups still work for an invalid theme, they fall back to hicolor.
+ */
+bool QXdgIconTheme::isValid() const
+{
+    Q_D(const QXdgIconTheme);
+    QMutexLocker locker(&d->mutex);
+    d->ensureThemesLoaded();
+    return d->chain.first().valid;
+}
+
+/*!
+ * \brief Returns the localized Name of the theme from its index.theme.
+ */
+QString QXdgIconTheme::displayName() const
+{
+    Q_D(const QXdgIconTheme);
+    QMutexLocker locker(&d->mutex);
+    d->ensureThemesLoaded();
+    return d->chain.first().displayName;
+}
+
+/*!
+ * \brief Returns the names of the themes icons are looked up in, in order.
+ *
+ * That's the theme itself, what it inherits depth first, and hicolor. A theme is only listed once, even if
+ * several themes inherit it.
+ */
+QStringList QXdgIconTheme::inheritanceChain() const
+{
+    Q_D(const QXdgIconTheme);
+    QMutexLocker locker(&d->mutex);
+    d->ensureThemesLoaded();
+
+    QStringList result;
+    for (const QXdgIconThemeData &theme : d->chain) {
+        result << theme.name;
+    }
+    return result;
+}
+
+/*!
+ * \brief Returns the file of the icon \a iconName for \a size pixels at \a scale, or an empty string if there is none.
+ *
+ * An absolute \a iconName is returned as is if the file exists. To resolve many icons, use findIcons(), which
+ * checks every directory once for all of them.
+ */
+QString QXdgIconTheme::findIcon(const QString &iconName, int size, int scale) const
+{
+    return findIcons({ { iconName, size, scale } }).first();
+}
+
+/*!
+ * \brief Returns the files of the icons \a iconNames, all for \a size pixels at \a scale.
+ *
+ * The result has one item per name, empty for the icons which weren't found.
+ */
+QStringList QXdgIconTheme::findIcons(const QStringList &iconNames, int size, int scale) const
+{
+    QVector<QXdgIconRequest> requests;
+    requests.reserve(iconNames.count());
+    for (const QString &iconName : iconNames) {
+        requests.append({ iconName, size, scale });
+    }
+    return findIcons(requests);
+}
+
+/*!
+ * \brief Returns the files of the icons of \a requests, which may have different sizes.
+ *
+ * The result has one item per request, empty for the icons which weren't found. The whole batch uses the same
+ * view of the directories: each of them is checked for changes once, however many icons are looked up in it.
+ */
+QStringList QXdgIconTheme::findIcons(const QVector<QXdgIconRequest> &requests) const
+{
+    Q_D(const QXdgIconTheme);
+    QMutexLocker locker(&d->mutex);
+    d->ensureThemesLoaded();
+    d->generation++;
+
+    QStringList result;
+    result.reserve(requests.count());
+    for (const QXdgIconRequest &request : requests) {
+        result << d->findIcon(request.iconName, request.size, request.scale);
+    }
+    return result;
+}
+
+/*!
+ * \brief Drop the parsed index.theme files and the directory listings, they are read again by the next lookup.
+ */
+void QXdgIconTheme::clearCache()
+{
+    Q_D(QXdgIconTheme);
+    QMutexLocker locker(&d->mutex);
+    d->clear();
+}
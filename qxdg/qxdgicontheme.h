@@ -0,0 +1,75 @@
+/*
+ * Copyright (C) 2019 Deepin Technology Co., Ltd.
+ *               2019 Gary Wang
+ *
+ * Author:     Gary Wang <wzc782970009@gmail.com>
+ *
+ * Maintainer: Gary Wang <wzc782970009@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QXDGICONTHEME_H
+#define QXDGICONTHEME_H
+
+#include "qxdg_global.h"
+
+#include <QScopedPointer>
+#include <QStringList>
+#include <QVector>
+
+/*!
+ * \brief An icon to look up with QXdgIconTheme::findIcons().
+ *
+ * It's an aggregate, so requests can be written as { iconName, size, scale }.
+ */
+struct QXDGSHARED_EXPORT QXdgIconRequest
+{
+    QString iconName;
+    int size;  //!< In logical pixels.
+    int scale; //!< 1, or 2 and more for icons of HiDPI screens.
+};
+
+Q_DECLARE_TYPEINFO(QXdgIconRequest, Q_MOVABLE_TYPE);
+
+class QXdgIconThemePrivate;
+class QXDGSHARED_EXPORT QXdgIconTheme
+{
+public:
+    explicit QXdgIconTheme(const QString &themeName = QStringLiteral("hicolor"));
+    ~QXdgIconTheme();
+
+    static QStringList defaultSearchPaths();
+    QStringList searchPaths() const;
+    void setSearchPaths(const QStringList &searchPaths);
+
+    QString themeName() const;
+    bool isValid() const;
+    QString displayName() const;
+    QStringList inheritanceChain() const;
+
+    QString findIcon(const QString &iconName, int size, int scale = 1) const;
+    QStringList findIcons(const QStringList &iconNames, int size, int scale = 1) const;
+    QStringList findIcons(const QVector<QXdgIconRequest> &requests) const;
+
+    void clearCache();
+
+private:
+    QScopedPointer<QXdgIconThemePrivate> d_ptr;
+
+    Q_DECLARE_PRIVATE(QXdgIconTheme)
+    Q_DISABLE_COPY(QXdgIconTheme)
+};
+
+#endif // QXDGICONTHEME_H
@@ -0,0 +1,139 @@
+/*
+ * Copyright (C) 2019 Deepin Technology Co., Ltd.
+ *               2019 Gary Wang
+ *
+ * Author:     Gary Wang <wzc782970009@gmail.com>
+ *
+ * Maintainer: Gary Wang <wzc782970009@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QXDGICONTHEME_P_H
+#define QXDGICONTHEME_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the QXdg API. It exists purely as an
+// implementation detail. This header file may change from version to
+// version without notice, or even be removed.
+//
+
+#include "qxdgicontheme.h"
+
+#include <QHash>
+#include <QMutex>
+#include <QVector>
+
+/*!
+ * \internal
+ * \brief A subdirectory of an icon theme, as described by its group in index.theme.
+ */
+class QXdgIconThemeDirectory
+{
+public:
+    enum Type {
+        Fixed,
+        Scalable,
+        Threshold
+    };
+
+    QString path;
+    Type type = Threshold;
+    int size = 0;
+    int scale = 1;
+    int minSize = 0;
+    int maxSize = 0;
+    int threshold = 2;
+
+    bool matchesSize(int iconSize, int iconScale) const;
+    int sizeDistance(int iconSize, int iconScale) const;
+};
+
+/*!
+ * \internal
+ * \brief The icon files of a directory, by icon name.
+ */
+class QXdgIconDirectoryListing
+{
+public:
+    enum Extension {
+        Png = 0x1,
+        Svg = 0x2,
+        Xpm = 0x4
+    };
+
+    QString path;
+    // -1 when the directory doesn't exist.
+    qint64 modificationTime = -1;
+    // Listed so soon after its last change that another change could share the same modification time.
+    bool racy = false;
+    // The lookup batch which last checked the modification time.
+    uint generation = 0;
+    // Extensions found for each icon name.
+    QHash<QString, uchar> icons;
+};
+
+/*!
+ * \internal
+ * \brief A theme of the inheritance chain.
+ */
+class QXdgIconThemeData
+{
+public:
+    // A subdirectory of the theme inside one of the search paths.
+    struct Location {
+        int directory;
+        int listing;
+    };
+
+    QString name;
+    QString displayName;
+    bool valid = false;
+    QStringList inherits;
+    QVector<QXdgIconThemeDirectory> directories;
+    // Subdirectory by subdirectory in the order of index.theme, and search path by search path for each of them.
+    QVector<Location> locations;
+};
+
+class QXdgIconThemePrivate
+{
+public:
+    QString themeName;
+    QStringList searchPaths;
+
+    // Lookups are const, the cache below is filled by them.
+    mutable QMutex mutex;
+    mutable bool themesLoaded = false;
+    // The theme, what it inherits depth first, and hicolor.
+    mutable QVector<QXdgIconThemeData> chain;
+    // Listings of the search paths themselves, for icons which are not part of any theme.
+    mutable QVector<int> fallbackListings;
+    mutable QVector<QXdgIconDirectoryListing> listings;
+    mutable QHash<QString, int> listingIndex;
+    mutable uint generation = 0;
+
+    void clear();
+    void ensureThemesLoaded() const;
+    void appendTheme(const QString &name) const;
+    int listingFor(const QString &path) const;
+    const QXdgIconDirectoryListing &validListing(int index) const;
+    QString lookupIcon(const QXdgIconThemeData &theme, const QString &iconName, int size, int scale) const;
+    QString lookupFallbackIcon(const QString &iconName) const;
+    QString findIcon(const QString &iconName, int size, int scale) const;
+};
+
+#endif // QXDGICONTHEME_P_H
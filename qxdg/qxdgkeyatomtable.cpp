@@ -0,0 +1,288 @@
+/*
+ * Copyright (C) 2019 Deepin Technology Co., Ltd.
+ *               2019 Gary Wang
+ *
+ * Author:     Gary Wang <wzc782970009@gmail.com>
+ *
+ * Maintainer: Gary Wang <wzc782970009@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "qxdgkeyatomtable_p.h"
+
+#include <QAtomicInt>
+#include <QAtomicPointer>
+#include <QByteArray>
+#include <QHash>
+#include <QReadWriteLock>
+#include <QVarLengthArray>
+#include <QtAlgorithms>
+
+#include <algorithm>
+#include <string.h>
+
+static const char * const wellKnownKeyNames[QXdgKeyAtomTable::WellKnownKeyCount] = {
+    "",
+    "Type",
+    "Version",
+    "Name",
+    "GenericName",
+    "NoDisplay",
+    "Comment",
+    "Icon",
+    "Hidden",
+    "OnlyShowIn",
+    "NotShowIn",
+    "DBusActivatable",
+    "TryExec",
+    "Exec",
+    "Path",
+    "Terminal",
+    "Actions",
+    "MimeType",
+    "Categories",
+    "Implements",
+    "Keywords",
+    "StartupNotify",
+    "StartupWMClass",
+    "URL",
+    "PrefersNonDefaultGPU",
+    "SingleMainWindow"
+};
+
+// FNV-1a
+static inline uint hashKey(uint seed, const char *utf8, int length)
+{
+    uint h = 2166136261u ^ seed;
+    for (int i = 0; i < length; i++) {
+        h ^= uchar(utf8[i]);
+        h *= 16777619u;
+    }
+    return h;
+}
+
+namespace {
+
+class WellKnownKeyHash
+{
+public:
+    enum { TableSize = 128 };
+
+    WellKnownKeyHash() {
+        for (QXdgKeyAtom atom = 1; atom < QXdgKeyAtomTable::WellKnownKeyCount; atom++) {
+            lengths[atom] = int(strlen(wellKnownKeyNames[atom]));
+        }
+
+        // Search for a seed which maps every spec key to its own slot. There are only a few keys, so
+        // this takes a handful of attempts, and makes every later lookup a single probe.
+        for (seed = 0; ; seed++) {
+            std::fill(table, table + TableSize, QXdgKeyAtom(QXdgKeyAtomTable::InvalidAtom));
+            bool collided = false;
+            for (QXdgKeyAtom atom = 1; atom < QXdgKeyAtomTable::WellKnownKeyCount && !collided; atom++) {
+                QXdgKeyAtom &slot = table[hashKey(seed, wellKnownKeyNames[atom], lengths[atom]) % TableSize];
+                collided = slot != QXdgKeyAtomTable::InvalidAtom;
+                slot = atom;
+            }
+            if (!collided) break;
+        }
+    }
+
+    QXdgKeyAtom find(const char *utf8, int length) const {
+        const QXdgKeyAtom atom = table[hashKey(seed, utf8, length) % TableSize];
+        if (atom != QXdgKeyAtomTable::InvalidAtom && lengths[atom] == length
+                && memcmp(wellKnownKeyNames[atom], utf8, size_t(length)) == 0) {
+            return atom;
+        }
+        return QXdgKeyAtomTable::InvalidAtom;
+    }
+
+private:
+    uint seed;
+    int lengths[QXdgKeyAtomTable::WellKnownKeyCount];
+    QXdgKeyAtom table[TableSize];
+};
+
+class AtomPool
+{
+public:
+    // Chunk k holds the names of FirstChunkSize << k interned keys. Chunks are never reallocated, so a name
+    // stays where it is once its atom got returned.
+    enum { FirstChunkSize = 64, ChunkCount = 24 };
+
+    AtomPool() {
+        for (QXdgKeyAtom atom = 0; atom < QXdgKeyAtomTable::WellKnownKeyCount; atom++) {
+            wellKnownNames[atom] = QString::fromLatin1(wellKnownKeyNames[atom]);
+        }
+    }
+
+    ~AtomPool() {
+        for (int chunk = 0; chunk < ChunkCount; chunk++) {
+            delete[] chunks[chunk].load();
+        }
+    }
+
+    static int chunkOf(int index, int *offset) {
+        const int chunk = 31 - qCountLeadingZeroBits(quint32(index / FirstChunkSize + 1));
+        *offset = index - FirstChunkSize * ((1 << chunk) - 1);
+        return chunk;
+    }
+
+    // Only called with the lock held for writing.
+    QString &append(const QString &name) {
+        int offset;
+        const int chunk = chunkOf(count.load(), &offset);
+        if (!chunks[chunk].load()) {
+            chunks[chunk].store(new QString[FirstChunkSize << chunk]);
+        }
+        QString &slot = chunks[chunk].load()[offset];
+        slot = name;
+        // readers check the count without the lock, publish the name first.
+        count.storeRelease(count.load() + 1);
+        return slot;
+    }
+
+    QString wellKnownNames[QXdgKeyAtomTable::WellKnownKeyCount];
+
+    QReadWriteLock lock;
+    QHash<QByteArray, QXdgKeyAtom> atoms;
+    // Names of the interned keys, the atom of the name at index i is WellKnownKeyCount + i.
+    QAtomicPointer<QString> chunks[ChunkCount];
+    QAtomicInt count;
+};
+
+} // namespace
+
+Q_GLOBAL_STATIC(WellKnownKeyHash, wellKnownKeyHash)
+Q_GLOBAL_STATIC(AtomPool, atomPool)
+
+// Keys are ASCII nearly all the time, so convert them on the stack to avoid an allocation per lookup.
+template <typename Function>
+static QXdgKeyAtom withUtf8Key(const QString &key, Function function)
+{
+    QVarLengthArray<char, 128> buffer(key.size());
+    const QChar *chars = key.constData();
+    for (int i = 0; i < key.size(); i++) {
+        const ushort ch = chars[i].unicode();
+        if (ch >= 0x80) {
+            const QByteArray utf8 = key.toUtf8();
+            return function(utf8.constData(), utf8.size());
+        }
+        buffer[i] = char(ch);
+    }
+    return function(buffer.constData(), buffer.size());
+}
+
+/*!
+ * \internal
+ * \brief Returns the atom of the UTF-8 encoded key, interning it if it's not known yet.
+ */
+QXdgKeyAtom QXdgKeyAtomTable::intern(const char *utf8, int length)
+{
+    QXdgKeyAtom atom = wellKnownKeyHash()->find(utf8, length);
+    if (atom != InvalidAtom) {
+        return atom;
+    }
+
+    AtomPool *pool = atomPool();
+    const QByteArray key = QByteArray::fromRawData(utf8, length);
+    {
+        QReadLocker locker(&pool->lock);
+        atom = pool->atoms.value(key, InvalidAtom);
+    }
+    if (atom != InvalidAtom) {
+        return atom;
+    }
+
+    QWriteLocker locker(&pool->lock);
+    // it might got interned while we were waiting for the lock.
+    QHash<QByteArray, QXdgKeyAtom>::const_iterator it = pool->atoms.constFind(key);
+    if (it != pool->atoms.constEnd()) {
+        return it.value();
+    }
+
+    if (pool->count.load() >= AtomPool::FirstChunkSize * ((1 << AtomPool::ChunkCount) - 1)) {
+        qWarning("QXdgKeyAtomTable: Too many keys");
+        return InvalidAtom;
+    }
+
+    atom = QXdgKeyAtom(WellKnownKeyCount + pool->count.load());
+    pool->atoms.insert(QByteArray(utf8, length), atom);
+    pool->append(QString::fromUtf8(utf8, length));
+    return atom;
+}
+
+/*! \internal */
+QXdgKeyAtom QXdgKeyAtomTable::intern(const QString &key)
+{
+    return withUtf8Key(key, [](const char *utf8, int length) {
+        return intern(utf8, length);
+    });
+}
+
+/*!
+ * \internal
+ * \brief Returns the atom of the UTF-8 encoded key, or InvalidAtom if it was never interned.
+ *
+ * A key which was never interned can't be in any section, so lookups use this to avoid growing the table.
+ */
+QXdgKeyAtom QXdgKeyAtomTable::find(const char *utf8, int length)
+{
+    QXdgKeyAtom atom = wellKnownKeyHash()->find(utf8, length);
+    if (atom != InvalidAtom) {
+        return atom;
+    }
+
+    AtomPool *pool = atomPool();
+    QReadLocker locker(&pool->lock);
+    return pool->atoms.value(QByteArray::fromRawData(utf8, length), InvalidAtom);
+}
+
+/*! \internal */
+QXdgKeyAtom QXdgKeyAtomTable::find(const QString &key)
+{
+    return withUtf8Key(key, [](const char *utf8, int length) {
+        return find(utf8, length);
+    });
+}
+
+/*! \internal */
+QString QXdgKeyAtomTable::name(QXdgKeyAtom atom)
+{
+    return nameRef(atom);
+}
+
+/*!
+ * \internal
+ * \brief Returns the name of the atom as stored in the table, without copying it and without locking.
+ *
+ * The reference stays valid for the lifetime of the process. Returns an empty string for an unknown atom.
+ */
+const QString &QXdgKeyAtomTable::nameRef(QXdgKeyAtom atom)
+{
+    AtomPool *pool = atomPool();
+    if (atom < WellKnownKeyCount) {
+        return pool->wellKnownNames[atom];
+    }
+
+    static const QString empty;
+    const quint32 index = atom - WellKnownKeyCount;
+    if (index >= quint32(pool->count.loadAcquire())) {
+        return empty;
+    }
+
+    int offset;
+    const int chunk = AtomPool::chunkOf(int(index), &offset);
+    return pool->chunks[chunk].load()[offset];
+}
@@ -0,0 +1,96 @@
+/*
+ * Copyright (C) 2019 Deepin Technology Co., Ltd.
+ *               2019 Gary Wang
+ *
+ * Author:     Gary Wang <wzc782970009@gmail.com>
+ *
+ * Maintainer: Gary Wang <wzc782970009@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QXDGKEYATOMTABLE_P_H
+#define QXDGKEYATOMTABLE_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the QXdg API. It exists purely as an
+// implementation detail. This header file may change from version to
+// version without notice, or even be removed.
+//
+
+#include <QString>
+
+typedef quint32 QXdgKeyAtom;
+
+/*!
+ * \internal
+ * \brief Process-wide table of interned desktop entry keys.
+ *
+ * Every distinct key is stored once for the whole process and referred to by a small integer atom, so sections
+ * don't keep their own copy of every key, and comparing keys is an integer comparison. Keys defined by the spec
+ * have fixed atoms and are looked up via a perfect hash without taking any lock, other keys are interned on
+ * demand into a pool guarded by a read-write lock. Atoms are never released, and their names never move, so
+ * reading the name of an atom doesn't lock either.
+ */
+class QXdgKeyAtomTable
+{
+public:
+    // Recognized keys of the desktop entry spec, in the order of the spec.
+    enum WellKnownKey : QXdgKeyAtom {
+        InvalidAtom = 0,
+        Type,
+        Version,
+        Name,
+        GenericName,
+        NoDisplay,
+        Comment,
+        Icon,
+        Hidden,
+        OnlyShowIn,
+        NotShowIn,
+        DBusActivatable,
+        TryExec,
+        Exec,
+        Path,
+        Terminal,
+        Actions,
+        MimeType,
+        Categories,
+        Implements,
+        Keywords,
+        StartupNotify,
+        StartupWMClass,
+        URL,
+        PrefersNonDefaultGPU,
+        SingleMainWindow,
+        WellKnownKeyCount
+    };
+
+    static QXdgKeyAtom intern(const char *utf8, int length);
+    static QXdgKeyAtom intern(const QString &key);
+    static QXdgKeyAtom find(const char *utf8, int length);
+    static QXdgKeyAtom find(const QString &key);
+    static QString name(QXdgKeyAtom atom);
+    static const QString &nameRef(QXdgKeyAtom atom);
+
+    static inline uint hash(QXdgKeyAtom atom) {
+        // Fibonacci hashing, atoms are sequential so they need some spreading.
+        return atom * 2654435761u;
+    }
+};
+
+#endif // QXDGKEYATOMTABLE_P_H
@@ -0,0 +1,157 @@
+/*
+ * Copyright (C) 2019 Deepin Technology Co., Ltd.
+ *               2019 Gary Wang
+ *
+ * Author:     Gary Wang <wzc782970009@gmail.com>
+ *
+ * Maintainer: Gary Wang <wzc782970009@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "qxdglocalechain_p.h"
+
+#include <QHash>
+#include <QLocale>
+#include <QReadWriteLock>
+#include <QStringList>
+
+namespace {
+
+class LocaleChainCache
+{
+public:
+    ~LocaleChainCache() {
+        qDeleteAll(chains);
+    }
+
+    QReadWriteLock lock;
+    QHash<QString, QXdgLocaleChain *> chains;
+    // Chains of the "default" and "system" locale keys, together with the locale they were built for.
+    QLocale defaultLocale;
+    const QXdgLocaleChain *defaultChain = nullptr;
+    QLocale systemLocale;
+    const QXdgLocaleChain *systemChain = nullptr;
+};
+
+} // namespace
+
+Q_GLOBAL_STATIC(LocaleChainCache, localeChainCache)
+
+// Follows the "Localized values for keys" section of the spec, a lang_COUNTRY.ENCODING@MODIFIER locale
+// falls back to lang_COUNTRY@MODIFIER, lang_COUNTRY, lang@MODIFIER and lang, the encoding part is ignored.
+// We keep trying "C" and then the key without locale after that, which is what we always did.
+static QStringList fallbackLocales(const QString &localeKey)
+{
+    if (localeKey.isEmpty()) {
+        return { QStringLiteral("C"), QString() };
+    }
+
+    if (localeKey == QLatin1String("empty")) {
+        return { QString(), QStringLiteral("C") };
+    }
+
+    QString locale = localeKey;
+    QString modifier;
+    const int modifierPos = locale.indexOf(QLatin1Char('@'));
+    if (modifierPos != -1) {
+        modifier = locale.mid(modifierPos);
+        locale.truncate(modifierPos);
+    }
+    const int encodingPos = locale.indexOf(QLatin1Char('.'));
+    if (encodingPos != -1) {
+        locale.truncate(encodingPos);
+    }
+    const QString lang = locale.left(locale.indexOf(QLatin1Char('_')));
+
+    QStringList result { localeKey };
+    if (!modifier.isEmpty()) {
+        result << locale + modifier;
+    }
+    result << locale;
+    if (!modifier.isEmpty()) {
+        result << lang + modifier;
+    }
+    result << lang << QStringLiteral("C");
+
+    // Malformed keys like "@mod" leave empty parts behind, which would match the key without locale.
+    result.removeAll(QString());
+    result.removeDuplicates();
+    result << QString();
+    return result;
+}
+
+static const QXdgLocaleChain *chainForLocale(LocaleChainCache *cache, const QString &localeKey)
+{
+    {
+        QReadLocker locker(&cache->lock);
+        if (const QXdgLocaleChain *chain = cache->chains.value(localeKey)) {
+            return chain;
+        }
+    }
+
+    QXdgLocaleChain *chain = new QXdgLocaleChain;
+    for (const QString &locale : fallbackLocales(localeKey)) {
+        chain->locales.append(locale.isNull() ? QXdgKeyAtom(QXdgKeyAtomTable::InvalidAtom)
+                                              : QXdgKeyAtomTable::intern(locale));
+    }
+
+    QWriteLocker locker(&cache->lock);
+    if (const QXdgLocaleChain *existing = cache->chains.value(localeKey)) {
+        delete chain;
+        return existing;
+    }
+    chain->serial = cache->chains.count() + 1;
+    cache->chains.insert(localeKey, chain);
+    return chain;
+}
+
+/*!
+ * \internal
+ * \brief Returns the fallback chain for the \a localeKey argument of QXdgDesktopEntry::localizedValue().
+ *
+ * "default" and "system" are resolved to the name of the corresponding QLocale, which is only looked at again when
+ * that locale changes.
+ */
+const QXdgLocaleChain *QXdgLocaleChain::forLocaleKey(const QString &localeKey)
+{
+    LocaleChainCache *cache = localeChainCache();
+
+    const bool isDefault = localeKey == QLatin1String("default");
+    if (!isDefault && localeKey != QLatin1String("system")) {
+        return chainForLocale(cache, localeKey);
+    }
+
+    // Comparing QLocale objects doesn't need to build their names.
+    const QLocale locale = isDefault ? QLocale() : QLocale::system();
+    {
+        QReadLocker locker(&cache->lock);
+        const QXdgLocaleChain *chain = isDefault ? cache->defaultChain : cache->systemChain;
+        if (chain && locale == (isDefault ? cache->defaultLocale : cache->systemLocale)) {
+            return chain;
+        }
+    }
+
+    const QXdgLocaleChain *chain = chainForLocale(cache, locale.name());
+
+    QWriteLocker locker(&cache->lock);
+    if (isDefault) {
+        cache->defaultLocale = locale;
+        cache->defaultChain = chain;
+    } else {
+        cache->systemLocale = locale;
+        cache->systemChain = chain;
+    }
+    return chain;
+}
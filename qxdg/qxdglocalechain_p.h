@@ -0,0 +1,61 @@
+/*
+ * Copyright (C) 2019 Deepin Technology Co., Ltd.
+ *               2019 Gary Wang
+ *
+ * Author:     Gary Wang <wzc782970009@gmail.com>
+ *
+ * Maintainer: Gary Wang <wzc782970009@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QXDGLOCALECHAIN_P_H
+#define QXDGLOCALECHAIN_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the QXdg API. It exists purely as an
+// implementation detail. This header file may change from version to
+// version without notice, or even be removed.
+//
+
+#include "qxdgkeyatomtable_p.h"
+
+#include <QVector>
+
+/*!
+ * \internal
+ * \brief Ordered list of locales to try when looking up a localized key.
+ *
+ * Locales are stored as atoms of the key atom table, the last one is always InvalidAtom which stands for the key
+ * without any locale. Chains are computed once per distinct locale key and shared process-wide, each of them has
+ * a unique serial so sections can cache what they resolved for it.
+ */
+class QXdgLocaleChain
+{
+public:
+    int serial = 0;
+    QVector<QXdgKeyAtom> locales;
+
+    // Lower is better, -1 if \a locale is not part of the chain at all.
+    inline int rank(QXdgKeyAtom locale) const {
+        return locales.indexOf(locale);
+    }
+
+    static const QXdgLocaleChain *forLocaleKey(const QString &localeKey);
+};
+
+#endif // QXDGLOCALECHAIN_P_H
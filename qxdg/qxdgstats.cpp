@@ -0,0 +1,133 @@
+/*
+ * Copyright (C) 2019 Deepin Technology Co., Ltd.
+ *               2019 Gary Wang
+ *
+ * Author:     Gary Wang <wzc782970009@gmail.com>
+ *
+ * Maintainer: Gary Wang <wzc782970009@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "qxdgstats_p.h"
+
+QBasicAtomicInt QXdgStatsPrivate::enabled = Q_BASIC_ATOMIC_INITIALIZER(0);
+QBasicAtomicInteger<quint64> QXdgStatsPrivate::counters[QXdgStatsPrivate::CounterCount];
+QBasicAtomicInteger<quint64> QXdgStatsPrivate::maxSaveNanoseconds;
+
+void QXdgStatsPrivate::recordSave(quint64 nanoseconds)
+{
+    counters[Saves].fetchAndAddRelaxed(1);
+    counters[SaveNanoseconds].fetchAndAddRelaxed(nanoseconds);
+    quint64 max = maxSaveNanoseconds.load();
+    while (nanoseconds > max && !maxSaveNanoseconds.testAndSetRelaxed(max, nanoseconds, max)) {
+    }
+}
+
+/*!
+ * \brief Returns the average time a save took, in nanoseconds.
+ */
+quint64 QXdgStats::averageSaveNanoseconds() const
+{
+    return saves ? totalSaveNanoseconds / saves : 0;
+}
+
+/*!
+ * \brief Returns the approximate memory held by a live entry, in bytes.
+ *
+ * That's the file content, the groups and the parsed values, not the keys which are shared by all entries.
+ */
+quint64 QXdgStats::bytesPerEntry() const
+{
+    return liveEntries ? liveEntryBytes / liveEntries : 0;
+}
+
+/*!
+ * \brief Returns the counters in a human readable form, one per line.
+ */
+QString QXdgStats::toString() const
+{
+    QString result;
+    auto append = [&result](const char *name, quint64 value) {
+        result += QStringLiteral("%1 %2\n").arg(QLatin1String(name), -22).arg(value);
+    };
+    append("files read:", filesRead);
+    append("bytes read:", bytesRead);
+    append("sections discovered:", sectionsDiscovered);
+    append("sections parsed:", sectionsParsed);
+    append("lookups:", lookups);
+    append("cache hits:", cacheHits);
+    append("escape calls:", escapeCalls);
+    append("unescape calls:", unescapeCalls);
+    append("saves:", saves);
+    append("average save ns:", averageSaveNanoseconds());
+    append("max save ns:", maxSaveNanoseconds);
+    append("live entries:", liveEntries);
+    append("live entry bytes:", liveEntryBytes);
+    append("bytes per entry:", bytesPerEntry());
+    return result;
+}
+
+/*!
+ * \brief Turns counting on or off.
+ *
+ * Entries loaded while counting is off don't show up in liveEntries and liveEntryBytes later.
+ */
+void QXdgStats::setEnabled(bool enabled)
+{
+    QXdgStatsPrivate::enabled.store(enabled);
+}
+
+bool QXdgStats::isEnabled()
+{
+    return QXdgStatsPrivate::isEnabled();
+}
+
+/*!
+ * \brief Returns the current value of every counter.
+ *
+ * The counters are read one by one while other threads may change them, so they are not exactly consistent
+ * with each other.
+ */
+QXdgStats QXdgStats::snapshot()
+{
+    typedef QXdgStatsPrivate P;
+    QXdgStats stats;
+    stats.filesRead = P::counters[P::FilesRead].load();
+    stats.bytesRead = P::counters[P::BytesRead].load();
+    stats.sectionsDiscovered = P::counters[P::SectionsDiscovered].load();
+    stats.sectionsParsed = P::counters[P::SectionsParsed].load();
+    stats.lookups = P::counters[P::Lookups].load();
+    stats.cacheHits = P::counters[P::CacheHits].load();
+    stats.escapeCalls = P::counters[P::EscapeCalls].load();
+    stats.unescapeCalls = P::counters[P::UnescapeCalls].load();
+    stats.saves = P::counters[P::Saves].load();
+    stats.totalSaveNanoseconds = P::counters[P::SaveNanoseconds].load();
+    stats.maxSaveNanoseconds = P::maxSaveNanoseconds.load();
+    stats.liveEntries = P::counters[P::LiveEntries].load();
+    stats.liveEntryBytes = P::counters[P::LiveEntryBytes].load();
+    return stats;
+}
+
+/*!
+ * \brief Sets every counter back to zero, except liveEntries and liveEntryBytes which describe the entries
+ * still alive.
+ */
+void QXdgStats::reset()
+{
+    for (int i = 0; i < QXdgStatsPrivate::LiveEntries; i++) {
+        QXdgStatsPrivate::counters[i].store(0);
+    }
+    QXdgStatsPrivate::maxSaveNanoseconds.store(0);
+}
@@ -0,0 +1,71 @@
+/*
+ * Copyright (C) 2019 Deepin Technology Co., Ltd.
+ *               2019 Gary Wang
+ *
+ * Author:     Gary Wang <wzc782970009@gmail.com>
+ *
+ * Maintainer: Gary Wang <wzc782970009@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QXDGSTATS_H
+#define QXDGSTATS_H
+
+#include "qxdg_global.h"
+
+#include <QString>
+
+/*!
+ * \brief A snapshot of the runtime counters of QXdg.
+ *
+ * Counting is off by default, and costs a single relaxed load per counted operation while it's off. Turn it on
+ * with setEnabled(), then take a snapshot() whenever the numbers are needed:
+ *
+ * \code
+ * QXdgStats::setEnabled(true);
+ * QXdgDesktopEntryCollection collection;
+ * collection.loadApplications();
+ * qDebug().noquote() << QXdgStats::snapshot().toString();
+ * \endcode
+ *
+ * Counters are process-wide and shared by all threads.
+ */
+struct QXDGSHARED_EXPORT QXdgStats
+{
+    quint64 filesRead = 0;          //!< Files read or mapped by entries.
+    quint64 bytesRead = 0;          //!< Bytes of those files, and of devices entries were loaded from.
+    quint64 sectionsDiscovered = 0; //!< Groups found while loading entries.
+    quint64 sectionsParsed = 0;     //!< Groups whose keys actually got parsed, they are parsed lazily.
+    quint64 lookups = 0;            //!< Value lookups, including the ones of contains().
+    quint64 cacheHits = 0;          //!< Typed values, Exec commands and collection entries served from a cache.
+    quint64 escapeCalls = 0;        //!< Calls of the QXdgDesktopEntry escape functions.
+    quint64 unescapeCalls = 0;      //!< Calls of the QXdgDesktopEntry unescape functions.
+    quint64 saves = 0;              //!< Successful saves and transaction commits.
+    quint64 totalSaveNanoseconds = 0;
+    quint64 maxSaveNanoseconds = 0;
+    quint64 liveEntries = 0;        //!< Loaded entries which are alive right now.
+    quint64 liveEntryBytes = 0;     //!< Approximate memory held by them.
+
+    quint64 averageSaveNanoseconds() const;
+    quint64 bytesPerEntry() const;
+    QString toString() const;
+
+    static void setEnabled(bool enabled);
+    static bool isEnabled();
+    static QXdgStats snapshot();
+    static void reset();
+};
+
+#endif // QXDGSTATS_H
@@ -0,0 +1,83 @@
+/*
+ * Copyright (C) 2019 Deepin Technology Co., Ltd.
+ *               2019 Gary Wang
+ *
+ * Author:     Gary Wang <wzc782970009@gmail.com>
+ *
+ * Maintainer: Gary Wang <wzc782970009@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QXDGSTATS_P_H
+#define QXDGSTATS_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the QXdg API. It exists purely as an
+// implementation detail. This header file may change from version to
+// version without notice, or even be removed.
+//
+
+#include "qxdgstats.h"
+
+#include <QAtomicInteger>
+
+/*!
+ * \internal
+ * \brief The counters behind QXdgStats.
+ *
+ * Everything is static and zero-initialized, so there is no global constructor. Call sites check isEnabled()
+ * first, when stats are off that's the only cost.
+ */
+class QXdgStatsPrivate
+{
+public:
+    enum Counter {
+        FilesRead,
+        BytesRead,
+        SectionsDiscovered,
+        SectionsParsed,
+        Lookups,
+        CacheHits,
+        EscapeCalls,
+        UnescapeCalls,
+        Saves,
+        SaveNanoseconds,
+        // Gauges, reset() leaves them alone.
+        LiveEntries,
+        LiveEntryBytes,
+        CounterCount
+    };
+
+    static bool isEnabled() {
+        return Q_UNLIKELY(enabled.load());
+    }
+
+    static void add(Counter counter, quint64 value = 1) {
+        if (isEnabled()) {
+            counters[counter].fetchAndAddRelaxed(value);
+        }
+    }
+
+    static void recordSave(quint64 nanoseconds);
+
+    static QBasicAtomicInt enabled;
+    static QBasicAtomicInteger<quint64> counters[CounterCount];
+    static QBasicAtomicInteger<quint64> maxSaveNanoseconds;
+};
+
+#endif // QXDGSTATS_P_H
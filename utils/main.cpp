@@ -3,7 +3,10 @@
 #include <QCommandLineParser>
 #include <QMap>
 
+#include <qxdg/qxdgdesktopentryvalidator.h>
+#include <qxdg/qxdgicontheme.h>
 #include <qxdg/qxdgstandardpath.h>
+#include <qxdg/qxdgstats.h>
 #include <stdio.h>
 
 const QMap<QString, QPair<QXdgStandardPath::StandardLocation, QString>> pathTypesMap = {
@@ -31,25 +34,127 @@ const QStringList typesList = {
     "KF5_SERVICES", "KF5_SOUND", "KF5_TEMPLATES"
 };
 
+static const QCommandLineOption option_stats("stats", "Print runtime statistics of QXdg to stderr when done");
+
+static void printStats()
+{
+    fprintf(stderr, "%s", qPrintable(QXdgStats::snapshot().toString()));
+}
+
+// qxdg validate [--jobs N] paths..., prints the problems like a compiler does and fails if there are errors.
+static int validate(const QCoreApplication &app)
+{
+    QCommandLineParser parser;
+    QCommandLineOption option_jobs({"j", "jobs"}, "Amount of files validated in parallel", "count");
+
+    parser.setApplicationDescription("Validate desktop entry files, directories are searched recursively.");
+    parser.addOptions({option_jobs, option_stats});
+    parser.addPositionalArgument("paths", "Desktop entry files or directories to validate.", "paths...");
+    parser.addHelpOption();
+
+    QStringList arguments = app.arguments();
+    arguments.removeAt(1);
+    parser.process(arguments);
+
+    if (parser.positionalArguments().isEmpty()) {
+        parser.showHelp(1);
+    }
+
+    QXdgStats::setEnabled(parser.isSet(option_stats));
+
+    QXdgDesktopEntryValidator validator;
+    if (parser.isSet(option_jobs)) {
+        validator.setMaxThreadCount(parser.value(option_jobs).toInt());
+    }
+
+    const QStringList filePaths = QXdgDesktopEntryValidator::findDesktopFiles(parser.positionalArguments());
+    int errorCount = 0;
+    int warningCount = 0;
+    for (const QXdgDesktopEntryDiagnostic &diagnostic : validator.validateFiles(filePaths)) {
+        printf("%s\n", qPrintable(diagnostic.toString()));
+        if (diagnostic.severity == QXdgDesktopEntryDiagnostic::Error) {
+            errorCount++;
+        } else {
+            warningCount++;
+        }
+    }
+    fprintf(stderr, "%d files, %d errors, %d warnings\n", filePaths.count(), errorCount, warningCount);
+    if (parser.isSet(option_stats)) {
+        printStats();
+    }
+
+    return errorCount == 0 ? 0 : 1;
+}
+
+// qxdg icon [--theme NAME] [--size N] [--scale N] names..., prints the file of each icon and fails if some are missing.
+static int findIcons(const QCoreApplication &app)
+{
+    QCommandLineParser parser;
+    QCommandLineOption option_theme("theme", "Icon theme to search, hicolor by default", "name", "hicolor");
+    QCommandLineOption option_size("size", "Wanted icon size in pixels, 48 by default", "pixels", "48");
+    QCommandLineOption option_scale("scale", "Wanted icon scale, 1 by default", "scale", "1");
+
+    parser.setApplicationDescription("Resolve icon names to files of an icon theme.");
+    parser.addOptions({option_theme, option_size, option_scale, option_stats});
+    parser.addPositionalArgument("names", "Icon names, like the Icon key of desktop entries.", "names...");
+    parser.addHelpOption();
+
+    QStringList arguments = app.arguments();
+    arguments.removeAt(1);
+    parser.process(arguments);
+
+    if (parser.positionalArguments().isEmpty()) {
+        parser.showHelp(1);
+    }
+
+    QXdgStats::setEnabled(parser.isSet(option_stats));
+
+    const QXdgIconTheme theme(parser.value(option_theme));
+    const QStringList iconNames = parser.positionalArguments();
+    const QStringList filePaths = theme.findIcons(iconNames, parser.value(option_size).toInt(),
+                                                  qMax(1, parser.value(option_scale).toInt()));
+    int missingCount = 0;
+    for (int i = 0; i < iconNames.count(); i++) {
+        if (filePaths[i].isEmpty()) {
+            fprintf(stderr, "%s: not found\n", qPrintable(iconNames[i]));
+            missingCount++;
+        } else {
+            printf("%s\n", qPrintable(filePaths[i]));
+        }
+    }
+    if (parser.isSet(option_stats)) {
+        printStats();
+    }
+
+    return missingCount == 0 ? 0 : 1;
+}
+
 int main(int argc, char *argv[])
 {
     QCoreApplication app(argc, argv);
     Q_UNUSED(app)
 
+    if (argc > 1 && qstrcmp(argv[1], "validate") == 0) {
+        return validate(app);
+    }
+    if (argc > 1 && qstrcmp(argv[1], "icon") == 0) {
+        return findIcons(app);
+    }
+
     QCommandLineParser parser;
     QCommandLineOption option_types("types", "Available path types");
     QCommandLineOption option_path("path", "Search path for resource type", "type");
 
-    parser.addOptions({option_types, option_path});
+    parser.addOptions({option_types, option_path, option_stats});
     parser.addHelpOption();
     parser.addVersionOption();
     parser.process(app);
+    QXdgStats::setEnabled(parser.isSet(option_stats));
 
     if (parser.isSet(option_types)) {
         for (const auto & oneType : typesList) {
             printf("%s\t- %s\n", qPrintable(oneType), qPrintable(pathTypesMap[oneType].second));
         }
-        return 0;
     } else if (parser.isSet(option_path)) {
         QString typeName = parser.value(option_path).toUpper();
         if (!typeName.isEmpty() && typesList.contains(typeName)) {
@@ -72,5 +177,9 @@ int main(int argc, char *argv[])
         }
     }
 
+    if (parser.isSet(option_stats)) {
+        printStats();
+    }
+
     return 0;
 }